@@ -1152,6 +1152,7 @@ void AbstractClient::leaveMoveResize()
 {
     workspace()->setClientIsMoving(nullptr);
     setMoveResize(false);
+    m_moveResize.hasDeferredMotion = false;
     if (ScreenEdges::self()->isDesktopSwitchingMovingClients())
         ScreenEdges::self()->reserveDesktopSwitching(false, Qt::Vertical|Qt::Horizontal);
     if (isElectricBorderMaximizing()) {
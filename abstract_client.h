@@ -873,6 +873,12 @@ protected:
 
 private:
     void handlePaletteChange();
+    /**
+     * Applies the last pointer motion which got dropped while waiting for the client
+     * to finish a resize step with the next frame.
+     **/
+    void scheduleDeferredMoveResize();
+    void applyDeferredMoveResize();
     QSharedPointer<TabBox::TabBoxClientImpl> m_tabBoxClient;
     bool m_firstInTabBox = false;
     bool m_skipTaskbar = false;
@@ -930,6 +936,12 @@ private:
         Qt::CursorShape cursor = Qt::ArrowCursor;
         int startScreen = 0;
         QTimer *delayedTimer = nullptr;
+        // last motion while waiting for the client to sync the previous resize step
+        bool hasDeferredMotion = false;
+        bool deferredMotionScheduled = false;
+        QPoint deferredLocal;
+        QPoint deferredGlobal;
+        QMetaObject::Connection deferredConnection;
     } m_moveResize;
 
     struct {
@@ -356,7 +356,7 @@ void AbstractEglTexture::updateTexture(WindowPixmap *pixmap)
     }
     Q_ASSERT(image.size() == m_size);
     q->bind();
-    const QRegion &damage = pixmap->toplevel()->damage();
+    const QRegion damage = pixmap->damage();
 
     // TODO: this should be shared with GLTexture::update
     if (GLPlatform::instance()->isGLES()) {
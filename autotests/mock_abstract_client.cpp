@@ -22,6 +22,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 namespace KWin
 {
 
+static int s_currentDesktop = 1;
+
 AbstractClient::AbstractClient(QObject *parent)
     : QObject(parent)
     , m_active(false)
@@ -29,6 +31,11 @@ AbstractClient::AbstractClient(QObject *parent)
     , m_fullscreen(false)
     , m_hiddenInternal(false)
     , m_keepBelow(false)
+    , m_wantsTabFocus(true)
+    , m_shown(true)
+    , m_minimized(false)
+    , m_desktop(1)
+    , m_application(0)
     , m_geometry()
 {
 }
@@ -103,4 +110,76 @@ void AbstractClient::setKeepBelow(bool keepBelow)
     emit keepBelowChanged();
 }
 
+bool AbstractClient::wantsTabFocus() const
+{
+    return m_wantsTabFocus;
+}
+
+void AbstractClient::setWantsTabFocus(bool set)
+{
+    m_wantsTabFocus = set;
+}
+
+bool AbstractClient::isShown(bool shaded_is_shown) const
+{
+    Q_UNUSED(shaded_is_shown)
+    return m_shown;
+}
+
+void AbstractClient::setShown(bool set)
+{
+    m_shown = set;
+}
+
+bool AbstractClient::isMinimized() const
+{
+    return m_minimized;
+}
+
+void AbstractClient::setMinimized(bool set)
+{
+    m_minimized = set;
+}
+
+bool AbstractClient::isOnDesktop(int desktop) const
+{
+    return m_desktop == -1 || m_desktop == desktop;
+}
+
+bool AbstractClient::isOnAllDesktops() const
+{
+    return m_desktop == -1;
+}
+
+bool AbstractClient::isOnCurrentDesktop() const
+{
+    return isOnDesktop(s_currentDesktop);
+}
+
+bool AbstractClient::isOnCurrentActivity() const
+{
+    return true;
+}
+
+void AbstractClient::setDesktop(int desktop)
+{
+    m_desktop = desktop;
+}
+
+void AbstractClient::setCurrentDesktop(int desktop)
+{
+    s_currentDesktop = desktop;
+}
+
+void AbstractClient::setApplication(int application)
+{
+    m_application = application;
+}
+
+bool AbstractClient::belongToSameApplication(const AbstractClient *c1, const AbstractClient *c2, bool active_hack)
+{
+    Q_UNUSED(active_hack)
+    return c1->m_application == c2->m_application;
+}
+
 }
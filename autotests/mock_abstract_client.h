@@ -40,6 +40,14 @@ public:
     bool isHiddenInternal() const;
     QRect geometry() const;
     bool keepBelow() const;
+    bool wantsTabFocus() const;
+    bool isShown(bool shaded_is_shown) const;
+    bool isMinimized() const;
+    bool isOnDesktop(int desktop) const;
+    bool isOnAllDesktops() const;
+    bool isOnCurrentDesktop() const;
+    bool isOnCurrentActivity() const;
+    static bool belongToSameApplication(const AbstractClient *c1, const AbstractClient *c2, bool active_hack = false);
 
     void setActive(bool active);
     void setScreen(int screen);
@@ -47,6 +55,18 @@ public:
     void setHiddenInternal(bool set);
     void setGeometry(const QRect &rect);
     void setKeepBelow(bool);
+    void setWantsTabFocus(bool set);
+    void setShown(bool set);
+    void setMinimized(bool set);
+    /**
+     * @p desktop being @c -1 puts the client on all desktops
+     **/
+    void setDesktop(int desktop);
+    void setApplication(int application);
+    /**
+     * The desktop isOnCurrentDesktop() compares with
+     **/
+    static void setCurrentDesktop(int desktop);
 
 Q_SIGNALS:
     void geometryChanged();
@@ -58,6 +78,11 @@ private:
     bool m_fullscreen;
     bool m_hiddenInternal;
     bool m_keepBelow;
+    bool m_wantsTabFocus;
+    bool m_shown;
+    bool m_minimized;
+    int m_desktop;
+    int m_application;
     QRect m_geometry;
 };
 
@@ -0,0 +1,308 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../damageregion.h"
+// Qt
+#include <QtTest/QtTest>
+
+using KWin::DamageHistory;
+using KWin::DamageRegion;
+
+Q_DECLARE_METATYPE(QVector<QRect>)
+
+namespace
+{
+
+// The damage traces mimic the repaints the compositor sees during typical sessions.
+
+// typing in an editor: one glyph and the cursor per key press, line by line
+QVector<QRect> typingTrace()
+{
+    QVector<QRect> trace;
+    for (int line = 0; line < 10; ++line) {
+        for (int column = 0; column < 60; ++column) {
+            trace << QRect(100 + column * 8, 200 + line * 16, 8, 16);
+            trace << QRect(108 + column * 8, 200 + line * 16, 1, 16);
+        }
+    }
+    return trace;
+}
+
+// scrolling a browser window: content area, scrollbar and a few animated elements
+QVector<QRect> scrollingTrace()
+{
+    QVector<QRect> trace;
+    for (int frame = 0; frame < 60; ++frame) {
+        trace << QRect(200, 150, 1000, 700);
+        trace << QRect(1200, 150 + frame * 10, 12, 80);
+        trace << QRect(220 + (frame % 5) * 100, 160, 32, 32);
+    }
+    return trace;
+}
+
+// video playback: the video surface, the progress bar and the clock in the panel
+QVector<QRect> videoTrace()
+{
+    QVector<QRect> trace;
+    for (int frame = 0; frame < 60; ++frame) {
+        trace << QRect(320, 180, 1280, 720);
+        trace << QRect(320, 880, 1280, 6);
+        if (frame % 30 == 0) {
+            trace << QRect(1800, 1050, 80, 30);
+        }
+    }
+    return trace;
+}
+
+// many small independent updates: spinners, tooltips, tray icons
+QVector<QRect> scatteredTrace()
+{
+    QVector<QRect> trace;
+    qsrand(42);
+    for (int i = 0; i < 500; ++i) {
+        trace << QRect(qrand() % 1900, qrand() % 1060, 4 + qrand() % 28, 4 + qrand() % 28);
+    }
+    return trace;
+}
+
+}
+
+class TestDamageRegion : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void testEmpty();
+    void testAddCovered();
+    void testMergeAdjacent();
+    void testKeepDistant();
+    void testCollapseToBoundingRect();
+    void testCoversDamage_data();
+    void testCoversDamage();
+    void testAccumulate_data();
+    void testAccumulate();
+    void testHistory_data();
+    void testHistory();
+    void testHistoryWrapsAround();
+    void testHistoryClear();
+};
+
+void TestDamageRegion::init()
+{
+    DamageRegion::setMaximumRects(16);
+}
+
+void TestDamageRegion::testEmpty()
+{
+    DamageRegion damage;
+    QVERIFY(damage.isEmpty());
+    QVERIFY(damage.toRegion().isEmpty());
+    damage += QRect();
+    QVERIFY(damage.isEmpty());
+    damage += QRegion();
+    QVERIFY(damage.isEmpty());
+    damage += QRect(0, 0, 10, 10);
+    QVERIFY(!damage.isEmpty());
+    damage.clear();
+    QVERIFY(damage.isEmpty());
+    QCOMPARE(damage.boundingRect(), QRect());
+}
+
+void TestDamageRegion::testAddCovered()
+{
+    DamageRegion damage(QRect(0, 0, 100, 100));
+    damage += QRect(10, 10, 10, 10);
+    QCOMPARE(damage.rects().count(), 1);
+    QCOMPARE(damage.rects().first(), QRect(0, 0, 100, 100));
+
+    // adding a bigger rect absorbs the smaller one
+    damage += QRect(0, 0, 200, 200);
+    QCOMPARE(damage.rects().count(), 1);
+    QCOMPARE(damage.boundingRect(), QRect(0, 0, 200, 200));
+}
+
+void TestDamageRegion::testMergeAdjacent()
+{
+    DamageRegion damage;
+    for (int i = 0; i < 10; ++i) {
+        damage += QRect(i * 8, 0, 8, 16);
+    }
+    QCOMPARE(damage.rects().count(), 1);
+    QCOMPARE(damage.rects().first(), QRect(0, 0, 80, 16));
+}
+
+void TestDamageRegion::testKeepDistant()
+{
+    DamageRegion damage;
+    damage += QRect(0, 0, 100, 100);
+    damage += QRect(1000, 1000, 100, 100);
+    QCOMPARE(damage.rects().count(), 2);
+    QCOMPARE(damage.boundingRect(), QRect(0, 0, 1100, 1100));
+    QVERIFY(damage.intersects(QRect(50, 50, 10, 10)));
+    QVERIFY(!damage.intersects(QRect(500, 500, 10, 10)));
+    QCOMPARE(damage.toRegion(), QRegion(0, 0, 100, 100) + QRegion(1000, 1000, 100, 100));
+}
+
+void TestDamageRegion::testCollapseToBoundingRect()
+{
+    DamageRegion::setMaximumRects(4);
+    DamageRegion damage;
+    for (int i = 0; i < 4; ++i) {
+        damage += QRect(i * 500, i * 500, 10, 10);
+    }
+    QCOMPARE(damage.rects().count(), 4);
+    damage += QRect(2500, 2500, 10, 10);
+    QCOMPARE(damage.rects().count(), 1);
+    QCOMPARE(damage.rects().first(), QRect(0, 0, 2510, 2510));
+}
+
+void TestDamageRegion::testCoversDamage_data()
+{
+    QTest::addColumn<QVector<QRect>>("trace");
+
+    QTest::newRow("typing") << typingTrace();
+    QTest::newRow("scrolling") << scrollingTrace();
+    QTest::newRow("video") << videoTrace();
+    QTest::newRow("scattered") << scatteredTrace();
+}
+
+void TestDamageRegion::testCoversDamage()
+{
+    QFETCH(QVector<QRect>, trace);
+    DamageRegion damage;
+    QRegion exact;
+    for (const QRect &r : trace) {
+        damage += r;
+        exact += r;
+    }
+    QVERIFY(damage.rects().count() <= DamageRegion::maximumRects());
+    QCOMPARE(damage.boundingRect(), exact.boundingRect());
+    QCOMPARE(damage.toRegion().intersected(exact), exact);
+}
+
+void TestDamageRegion::testAccumulate_data()
+{
+    QTest::addColumn<QVector<QRect>>("trace");
+    QTest::addColumn<bool>("damageRegion");
+
+    QTest::newRow("typing/QRegion") << typingTrace() << false;
+    QTest::newRow("typing/DamageRegion") << typingTrace() << true;
+    QTest::newRow("scrolling/QRegion") << scrollingTrace() << false;
+    QTest::newRow("scrolling/DamageRegion") << scrollingTrace() << true;
+    QTest::newRow("video/QRegion") << videoTrace() << false;
+    QTest::newRow("video/DamageRegion") << videoTrace() << true;
+    QTest::newRow("scattered/QRegion") << scatteredTrace() << false;
+    QTest::newRow("scattered/DamageRegion") << scatteredTrace() << true;
+}
+
+void TestDamageRegion::testAccumulate()
+{
+    // accumulates the damage of one trace and converts it to the QRegion passed to the scene
+    QFETCH(QVector<QRect>, trace);
+    QFETCH(bool, damageRegion);
+
+    if (damageRegion) {
+        QBENCHMARK {
+            DamageRegion damage;
+            for (const QRect &r : trace) {
+                damage += r;
+            }
+            damage.toRegion();
+        }
+    } else {
+        QBENCHMARK {
+            QRegion damage;
+            for (const QRect &r : trace) {
+                damage += r;
+            }
+        }
+    }
+}
+
+// the damage of frame @p frame, distant from all other frames so that nothing gets merged
+static QRect frameDamage(int frame)
+{
+    return QRect(frame * 100, 0, 10, 10);
+}
+
+static const QRect s_fullRepaint(0, 0, 4096, 4096);
+
+void TestDamageRegion::testHistory_data()
+{
+    QTest::addColumn<int>("bufferAge");
+    QTest::addColumn<QRegion>("expected");
+
+    // three frames got presented, 0 being the oldest one
+    QTest::newRow("undefined") << 0 << QRegion(s_fullRepaint);
+    QTest::newRow("current") << 1 << QRegion();
+    QTest::newRow("previous") << 2 << QRegion(frameDamage(2));
+    QTest::newRow("two frames") << 3 << (QRegion(frameDamage(1)) + frameDamage(2));
+    QTest::newRow("older than history") << 4 << QRegion(s_fullRepaint);
+    QTest::newRow("negative") << -1 << QRegion(s_fullRepaint);
+}
+
+void TestDamageRegion::testHistory()
+{
+    // a buffer of age n has to be repaired with the damage of the last n - 1 frames
+    QFETCH(int, bufferAge);
+    QFETCH(QRegion, expected);
+    DamageHistory history;
+    QCOMPARE(history.count(), 0);
+    for (int i = 0; i < 3; ++i) {
+        history.add(frameDamage(i));
+    }
+    QCOMPARE(history.count(), 3);
+    QCOMPARE(history.accumulate(bufferAge, s_fullRepaint), expected);
+}
+
+void TestDamageRegion::testHistoryWrapsAround()
+{
+    // the ring keeps the last MaximumBufferAge frames
+    const int maximum = DamageHistory::MaximumBufferAge;
+    DamageHistory history;
+    for (int i = 0; i < maximum + 3; ++i) {
+        history.add(frameDamage(i));
+    }
+    QCOMPARE(history.count(), maximum);
+    QRegion expected;
+    for (int age = 2; age <= maximum; ++age) {
+        expected += frameDamage(maximum + 3 - age + 1);
+        QCOMPARE(history.accumulate(age, s_fullRepaint), expected);
+    }
+    QCOMPARE(history.accumulate(maximum + 1, s_fullRepaint), QRegion(s_fullRepaint));
+}
+
+void TestDamageRegion::testHistoryClear()
+{
+    DamageHistory history;
+    history.add(frameDamage(0));
+    history.add(frameDamage(1));
+    QCOMPARE(history.accumulate(2, s_fullRepaint), QRegion(frameDamage(1)));
+    history.clear();
+    QCOMPARE(history.count(), 0);
+    QCOMPARE(history.accumulate(2, s_fullRepaint), QRegion(s_fullRepaint));
+    // a new frame starts a new history
+    history.add(frameDamage(2));
+    history.add(frameDamage(3));
+    QCOMPARE(history.accumulate(2, s_fullRepaint), QRegion(frameDamage(3)));
+    QCOMPARE(history.accumulate(3, s_fullRepaint), QRegion(s_fullRepaint));
+}
+
+QTEST_GUILESS_MAIN(TestDamageRegion)
+#include "test_damage_region.moc"
@@ -0,0 +1,496 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "mock_abstract_client.h"
+#include "../cursor.h"
+#include "../focuschain.h"
+// Qt
+#include <QtTest/QtTest>
+
+#include <random>
+
+Q_LOGGING_CATEGORY(KWIN_CORE, "kwin_core")
+
+// Mock
+namespace KWin
+{
+
+QPoint Cursor::pos()
+{
+    return QPoint();
+}
+
+}
+
+using namespace KWin;
+
+/**
+ * The list based implementation the FocusChain used to have, all chains are compared against it.
+ **/
+class ReferenceFocusChain
+{
+public:
+    void resize(uint previousSize, uint newSize) {
+        for (uint i = previousSize + 1; i <= newSize; ++i) {
+            m_desktopFocusChains.insert(i, QList<AbstractClient*>());
+        }
+        for (uint i = previousSize; i > newSize; --i) {
+            m_desktopFocusChains.remove(i);
+        }
+    }
+    void setActiveClient(AbstractClient *client) {
+        m_activeClient = client;
+    }
+    void setCurrentDesktop(uint previous, uint newDesktop) {
+        Q_UNUSED(previous)
+        m_currentDesktop = newDesktop;
+    }
+    void remove(AbstractClient *client) {
+        for (auto it = m_desktopFocusChains.begin(); it != m_desktopFocusChains.end(); ++it) {
+            it.value().removeAll(client);
+        }
+        m_mostRecentlyUsed.removeAll(client);
+    }
+    void update(AbstractClient *client, FocusChain::Change change) {
+        if (!client->wantsTabFocus()) {
+            remove(client);
+            return;
+        }
+        if (client->isOnAllDesktops()) {
+            for (auto it = m_desktopFocusChains.begin(); it != m_desktopFocusChains.end(); ++it) {
+                auto &chain = it.value();
+                if (it.key() == m_currentDesktop && (change == FocusChain::MakeFirst || change == FocusChain::MakeLast)) {
+                    if (change == FocusChain::MakeFirst) {
+                        makeFirstInChain(client, chain);
+                    } else {
+                        makeLastInChain(client, chain);
+                    }
+                } else {
+                    insertClientIntoChain(client, chain);
+                }
+            }
+        } else {
+            for (auto it = m_desktopFocusChains.begin(); it != m_desktopFocusChains.end(); ++it) {
+                auto &chain = it.value();
+                if (client->isOnDesktop(it.key())) {
+                    updateClientInChain(client, change, chain);
+                } else {
+                    chain.removeAll(client);
+                }
+            }
+        }
+        updateClientInChain(client, change, m_mostRecentlyUsed);
+    }
+    void moveAfterClient(AbstractClient *client, AbstractClient *reference) {
+        if (!client->wantsTabFocus()) {
+            return;
+        }
+        for (auto it = m_desktopFocusChains.begin(); it != m_desktopFocusChains.end(); ++it) {
+            if (!client->isOnDesktop(it.key())) {
+                continue;
+            }
+            moveAfterClientInChain(client, reference, it.value());
+        }
+        moveAfterClientInChain(client, reference, m_mostRecentlyUsed);
+    }
+    AbstractClient *getForActivation(uint desktop, int screen) const {
+        // separate screen focus is not enabled
+        Q_UNUSED(screen)
+        auto it = m_desktopFocusChains.find(desktop);
+        if (it == m_desktopFocusChains.constEnd()) {
+            return nullptr;
+        }
+        const auto &chain = it.value();
+        for (int i = chain.size() - 1; i >= 0; --i) {
+            auto tmp = chain.at(i);
+            if (tmp->isShown(false) && tmp->isOnCurrentActivity()) {
+                return tmp;
+            }
+        }
+        return nullptr;
+    }
+    bool contains(AbstractClient *client) const {
+        return m_mostRecentlyUsed.contains(client);
+    }
+    bool contains(AbstractClient *client, uint desktop) const {
+        auto it = m_desktopFocusChains.find(desktop);
+        if (it == m_desktopFocusChains.end()) {
+            return false;
+        }
+        return it.value().contains(client);
+    }
+    AbstractClient *firstMostRecentlyUsed() const {
+        return m_mostRecentlyUsed.isEmpty() ? nullptr : m_mostRecentlyUsed.first();
+    }
+    AbstractClient *nextMostRecentlyUsed(AbstractClient *reference) const {
+        if (m_mostRecentlyUsed.isEmpty()) {
+            return nullptr;
+        }
+        const int index = m_mostRecentlyUsed.indexOf(reference);
+        if (index == -1) {
+            return m_mostRecentlyUsed.first();
+        }
+        if (index == 0) {
+            return m_mostRecentlyUsed.last();
+        }
+        return m_mostRecentlyUsed.at(index - 1);
+    }
+    AbstractClient *nextForDesktop(AbstractClient *reference, uint desktop) const {
+        auto it = m_desktopFocusChains.find(desktop);
+        if (it == m_desktopFocusChains.end()) {
+            return nullptr;
+        }
+        const auto &chain = it.value();
+        for (int i = chain.size() - 1; i >= 0; --i) {
+            auto client = chain.at(i);
+            if (client != reference && client->isShown(false) && client->isOnCurrentDesktop() && client->isOnCurrentActivity()) {
+                return client;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    void makeFirstInChain(AbstractClient *client, QList<AbstractClient*> &chain) {
+        chain.removeAll(client);
+        if (client->isMinimized()) {
+            for (int i = chain.count() - 1; i >= 0; --i) {
+                if (chain.at(i)->isMinimized()) {
+                    chain.insert(i + 1, client);
+                    return;
+                }
+            }
+            chain.prepend(client);
+        } else {
+            chain.append(client);
+        }
+    }
+    void makeLastInChain(AbstractClient *client, QList<AbstractClient*> &chain) {
+        chain.removeAll(client);
+        chain.prepend(client);
+    }
+    void moveAfterClientInChain(AbstractClient *client, AbstractClient *reference, QList<AbstractClient*> &chain) {
+        if (client == reference || !chain.contains(reference)) {
+            return;
+        }
+        if (AbstractClient::belongToSameApplication(reference, client)) {
+            chain.removeAll(client);
+            chain.insert(chain.indexOf(reference), client);
+        } else {
+            chain.removeAll(client);
+            for (int i = chain.size() - 1; i >= 0; --i) {
+                if (AbstractClient::belongToSameApplication(reference, chain.at(i))) {
+                    chain.insert(i, client);
+                    break;
+                }
+            }
+        }
+    }
+    void updateClientInChain(AbstractClient *client, FocusChain::Change change, QList<AbstractClient*> &chain) {
+        if (change == FocusChain::MakeFirst) {
+            makeFirstInChain(client, chain);
+        } else if (change == FocusChain::MakeLast) {
+            makeLastInChain(client, chain);
+        } else {
+            insertClientIntoChain(client, chain);
+        }
+    }
+    void insertClientIntoChain(AbstractClient *client, QList<AbstractClient*> &chain) {
+        if (chain.contains(client)) {
+            return;
+        }
+        if (m_activeClient && m_activeClient != client && !chain.empty() && chain.last() == m_activeClient) {
+            chain.insert(chain.size() - 1, client);
+        } else {
+            chain.append(client);
+        }
+    }
+    QList<AbstractClient*> m_mostRecentlyUsed;
+    QHash<uint, QList<AbstractClient*>> m_desktopFocusChains;
+    AbstractClient *m_activeClient = nullptr;
+    uint m_currentDesktop = 0;
+};
+
+/**
+ * The order of the chain for @p desktop, most recently used Client first. Queried through
+ * getForActivation by hiding the found Clients one after the other.
+ **/
+template <typename T>
+static QList<AbstractClient*> desktopChain(const T &chain, uint desktop)
+{
+    QList<AbstractClient*> order;
+    while (AbstractClient *c = chain.getForActivation(desktop, 0)) {
+        order << c;
+        c->setShown(false);
+    }
+    for (AbstractClient *c : order) {
+        c->setShown(true);
+    }
+    return order;
+}
+
+/**
+ * The most recently used chain in the order nextMostRecentlyUsed walks it.
+ **/
+template <typename T>
+static QList<AbstractClient*> mostRecentlyUsedChain(const T &chain)
+{
+    QList<AbstractClient*> order;
+    AbstractClient *first = chain.firstMostRecentlyUsed();
+    if (!first) {
+        return order;
+    }
+    order << first;
+    for (AbstractClient *c = chain.nextMostRecentlyUsed(first); c != first; c = chain.nextMostRecentlyUsed(c)) {
+        order << c;
+        if (order.count() > 10000) {
+            // broken links
+            break;
+        }
+    }
+    return order;
+}
+
+class TestFocusChain : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void testMakeFirst();
+    void testMinimized();
+    void testRandomizedEquivalence_data();
+    void testRandomizedEquivalence();
+    void benchmarkActivation_data();
+    void benchmarkActivation();
+
+private:
+    FocusChain *m_chain = nullptr;
+    QList<AbstractClient*> m_clients;
+};
+
+void TestFocusChain::init()
+{
+    m_chain = FocusChain::create(this);
+    AbstractClient::setCurrentDesktop(1);
+}
+
+void TestFocusChain::cleanup()
+{
+    delete m_chain;
+    m_chain = nullptr;
+    qDeleteAll(m_clients);
+    m_clients.clear();
+}
+
+void TestFocusChain::testMakeFirst()
+{
+    m_chain->resize(0, 2);
+    m_chain->setCurrentDesktop(0, 1);
+    for (int i = 0; i < 3; ++i) {
+        AbstractClient *c = new AbstractClient(nullptr);
+        m_clients << c;
+        m_chain->update(c, FocusChain::MakeFirst);
+    }
+    QCOMPARE(mostRecentlyUsedChain(*m_chain), QList<AbstractClient*>({m_clients[0], m_clients[2], m_clients[1]}));
+    QCOMPARE(desktopChain(*m_chain, 1), QList<AbstractClient*>({m_clients[2], m_clients[1], m_clients[0]}));
+    QVERIFY(desktopChain(*m_chain, 2).isEmpty());
+    QVERIFY(m_chain->contains(m_clients[1], 1));
+    QVERIFY(!m_chain->contains(m_clients[1], 2));
+
+    // moving to all desktops adds it to the other chain
+    m_clients[0]->setDesktop(-1);
+    m_chain->update(m_clients[0], FocusChain::MakeFirst);
+    QCOMPARE(m_chain->getForActivation(1, 0), m_clients[0]);
+    QCOMPARE(m_chain->getForActivation(2, 0), m_clients[0]);
+
+    // a client which does not want focus gets removed
+    m_clients[1]->setWantsTabFocus(false);
+    m_chain->update(m_clients[1], FocusChain::Update);
+    QVERIFY(!m_chain->contains(m_clients[1]));
+    QVERIFY(!m_chain->contains(m_clients[1], 1));
+    QCOMPARE(mostRecentlyUsedChain(*m_chain).count(), 2);
+
+    m_chain->remove(m_clients[0]);
+    QVERIFY(!m_chain->contains(m_clients[0], 2));
+    QCOMPARE(mostRecentlyUsedChain(*m_chain), QList<AbstractClient*>({m_clients[2]}));
+}
+
+void TestFocusChain::testMinimized()
+{
+    // a minimized client becomes first before the other minimized clients
+    m_chain->resize(0, 1);
+    m_chain->setCurrentDesktop(0, 1);
+    for (int i = 0; i < 4; ++i) {
+        AbstractClient *c = new AbstractClient(nullptr);
+        m_clients << c;
+        m_chain->update(c, FocusChain::MakeFirst);
+    }
+    m_clients[0]->setMinimized(true);
+    m_chain->update(m_clients[0], FocusChain::MakeLast);
+    m_clients[3]->setMinimized(true);
+    m_chain->update(m_clients[3], FocusChain::MakeFirstMinimized);
+    QCOMPARE(desktopChain(*m_chain, 1), QList<AbstractClient*>({m_clients[2], m_clients[1], m_clients[3], m_clients[0]}));
+}
+
+void TestFocusChain::testRandomizedEquivalence_data()
+{
+    QTest::addColumn<uint>("seed");
+
+    for (uint seed : {1u, 7u, 42u, 1234u, 99991u}) {
+        QTest::newRow(qPrintable(QString::number(seed))) << seed;
+    }
+}
+
+void TestFocusChain::testRandomizedEquivalence()
+{
+    QFETCH(uint, seed);
+    std::mt19937 random(seed);
+    auto pick = [&random] (int count) {
+        return std::uniform_int_distribution<int>(0, count - 1)(random);
+    };
+    const int clientCount = 30;
+    uint desktops = 4;
+    ReferenceFocusChain reference;
+    m_chain->resize(0, desktops);
+    reference.resize(0, desktops);
+    m_chain->setCurrentDesktop(0, 1);
+    reference.setCurrentDesktop(0, 1);
+    for (int i = 0; i < clientCount; ++i) {
+        AbstractClient *c = new AbstractClient(nullptr);
+        c->setApplication(pick(5));
+        c->setDesktop(pick(5) == 0 ? -1 : pick(desktops) + 1);
+        m_clients << c;
+    }
+
+    const FocusChain::Change changes[] = {FocusChain::MakeFirst, FocusChain::MakeLast, FocusChain::Update};
+    for (int step = 0; step < 2000; ++step) {
+        AbstractClient *c = m_clients.at(pick(clientCount));
+        switch (pick(10)) {
+        case 0:
+            m_chain->remove(c);
+            reference.remove(c);
+            break;
+        case 1: {
+            AbstractClient *other = m_clients.at(pick(clientCount));
+            m_chain->moveAfterClient(c, other);
+            reference.moveAfterClient(c, other);
+            break;
+        }
+        case 2:
+            m_chain->setActiveClient(c);
+            reference.setActiveClient(c);
+            break;
+        case 3:
+            c->setDesktop(pick(5) == 0 ? -1 : pick(desktops) + 1);
+            break;
+        case 4:
+            c->setMinimized(!c->isMinimized());
+            break;
+        case 5:
+            c->setWantsTabFocus(pick(8) != 0);
+            break;
+        case 6: {
+            const uint desktop = pick(desktops) + 1;
+            m_chain->setCurrentDesktop(0, desktop);
+            reference.setCurrentDesktop(0, desktop);
+            AbstractClient::setCurrentDesktop(desktop);
+            break;
+        }
+        case 7:
+            if (pick(20) == 0) {
+                const uint newDesktops = pick(6) + 1;
+                m_chain->resize(desktops, newDesktops);
+                reference.resize(desktops, newDesktops);
+                desktops = newDesktops;
+            }
+            break;
+        default: {
+            const FocusChain::Change change = changes[pick(3)];
+            m_chain->update(c, change);
+            reference.update(c, change);
+            break;
+        }
+        }
+
+        QCOMPARE(mostRecentlyUsedChain(*m_chain), mostRecentlyUsedChain(reference));
+        QCOMPARE(m_chain->nextMostRecentlyUsed(c), reference.nextMostRecentlyUsed(c));
+        for (uint desktop = 1; desktop <= desktops; ++desktop) {
+            QCOMPARE(desktopChain(*m_chain, desktop), desktopChain(reference, desktop));
+            QCOMPARE(m_chain->nextForDesktop(c, desktop), reference.nextForDesktop(c, desktop));
+            QCOMPARE(m_chain->contains(c, desktop), reference.contains(c, desktop));
+        }
+        QCOMPARE(m_chain->contains(c), reference.contains(c));
+    }
+}
+
+void TestFocusChain::benchmarkActivation_data()
+{
+    QTest::addColumn<bool>("list");
+
+    QTest::newRow("focus chain") << false;
+    QTest::newRow("list reference") << true;
+}
+
+template <typename T>
+static void activateAll(T &chain, const QList<AbstractClient*> &clients)
+{
+    for (AbstractClient *c : clients) {
+        chain.setActiveClient(c);
+        chain.update(c, FocusChain::MakeFirst);
+        chain.nextMostRecentlyUsed(c);
+    }
+    // closing and reopening some windows
+    for (int i = 0; i < clients.count(); i += 10) {
+        chain.remove(clients.at(i));
+        chain.update(clients.at(i), FocusChain::Update);
+    }
+}
+
+void TestFocusChain::benchmarkActivation()
+{
+    // 20 virtual desktops, 300 windows and every third window on all desktops
+    QFETCH(bool, list);
+    const uint desktops = 20;
+    for (int i = 0; i < 300; ++i) {
+        AbstractClient *c = new AbstractClient(nullptr);
+        c->setDesktop(i % 3 == 0 ? -1 : int(i % desktops) + 1);
+        m_clients << c;
+    }
+    ReferenceFocusChain reference;
+    m_chain->resize(0, desktops);
+    reference.resize(0, desktops);
+    m_chain->setCurrentDesktop(0, 1);
+    reference.setCurrentDesktop(0, 1);
+    activateAll(*m_chain, m_clients);
+    activateAll(reference, m_clients);
+
+    if (list) {
+        QBENCHMARK {
+            activateAll(reference, m_clients);
+        }
+    } else {
+        QBENCHMARK {
+            activateAll(*m_chain, m_clients);
+        }
+    }
+}
+
+QTEST_MAIN(TestFocusChain)
+#include "test_focus_chain.moc"
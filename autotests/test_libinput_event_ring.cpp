@@ -0,0 +1,130 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../libinput/eventring.h"
+// Qt
+#include <QtTest/QtTest>
+#include <QThread>
+
+using KWin::LibInput::Event;
+using KWin::LibInput::EventRing;
+
+// the ring never dereferences the Events, so plain numbers are good enough
+static Event *fakeEvent(quintptr value)
+{
+    return reinterpret_cast<Event*>(value);
+}
+
+class Producer : public QThread
+{
+public:
+    Producer(EventRing *ring, int count)
+        : m_ring(ring)
+        , m_count(count) {
+    }
+
+protected:
+    void run() override {
+        for (int i = 1; i <= m_count; ++i) {
+            while (m_ring->isFull()) {
+                yieldCurrentThread();
+            }
+            m_ring->push(fakeEvent(i));
+        }
+    }
+
+private:
+    EventRing *m_ring;
+    int m_count;
+};
+
+class TestLibinputEventRing : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testEmpty();
+    void testPushTake();
+    void testFull();
+    void testThreaded();
+};
+
+void TestLibinputEventRing::testEmpty()
+{
+    EventRing ring;
+    QVERIFY(ring.isEmpty());
+    QVERIFY(!ring.isFull());
+    QVERIFY(!ring.peek());
+    QVERIFY(!ring.take());
+}
+
+void TestLibinputEventRing::testPushTake()
+{
+    EventRing ring;
+    ring.push(fakeEvent(1));
+    ring.push(fakeEvent(2));
+    QVERIFY(!ring.isEmpty());
+    QCOMPARE(ring.peek(), fakeEvent(1));
+    // peek does not remove
+    QCOMPARE(ring.peek(), fakeEvent(1));
+    QCOMPARE(ring.take(), fakeEvent(1));
+    QCOMPARE(ring.take(), fakeEvent(2));
+    QVERIFY(ring.isEmpty());
+    QVERIFY(!ring.take());
+}
+
+void TestLibinputEventRing::testFull()
+{
+    EventRing ring;
+    // wrap around a few times
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 1; i < EventRing::Capacity; ++i) {
+            QVERIFY(!ring.isFull());
+            ring.push(fakeEvent(i));
+        }
+        QVERIFY(ring.isFull());
+        for (int i = 1; i < EventRing::Capacity; ++i) {
+            QCOMPARE(ring.take(), fakeEvent(i));
+        }
+        QVERIFY(ring.isEmpty());
+    }
+}
+
+void TestLibinputEventRing::testThreaded()
+{
+    // the consumer has to see all events in order
+    const int count = EventRing::Capacity * 100;
+    EventRing ring;
+    Producer producer(&ring, count);
+    producer.start();
+    int expected = 1;
+    while (expected <= count) {
+        Event *event = ring.take();
+        if (!event) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        QCOMPARE(event, fakeEvent(expected));
+        expected++;
+    }
+    QVERIFY(producer.wait());
+    QVERIFY(ring.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestLibinputEventRing)
+#include "test_libinput_event_ring.moc"
@@ -0,0 +1,246 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../tracing.h"
+// Qt
+#include <QtTest/QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+using KWin::Tracing;
+
+class TracingThread : public QThread
+{
+protected:
+    void run() override {
+        KWIN_TRACE("test", "thread");
+    }
+};
+
+class RecordingThread : public QThread
+{
+public:
+    QAtomicInt stop;
+protected:
+    void run() override {
+        qint64 time = 0;
+        while (!stop.load()) {
+            Tracing::record("test", "recording", time, time + 1);
+            ++time;
+        }
+    }
+};
+
+class TestTracing : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void cleanup();
+    void testDisabled();
+    void testScope();
+    void testCondition();
+    void testRingOverflow();
+    void testThreads();
+    void testExitedThread();
+    void testConcurrentExport();
+    void testChromeTrace();
+};
+
+void TestTracing::cleanup()
+{
+    Tracing::setEnabled(false);
+}
+
+void TestTracing::testDisabled()
+{
+    QVERIFY(!Tracing::isEnabled());
+    {
+        KWIN_TRACE("test", "disabled");
+    }
+    QCOMPARE(Tracing::eventCount(), 0);
+}
+
+void TestTracing::testScope()
+{
+    Tracing::setEnabled(true);
+    QVERIFY(Tracing::isEnabled());
+    {
+        KWIN_TRACE("test", "outer");
+        KWIN_TRACE("test", "inner");
+    }
+    QCOMPARE(Tracing::eventCount(), 2);
+
+    // enabling again does not discard, only a new session does
+    Tracing::setEnabled(true);
+    QCOMPARE(Tracing::eventCount(), 2);
+    Tracing::setEnabled(false);
+    QCOMPARE(Tracing::eventCount(), 2);
+    Tracing::setEnabled(true);
+    QCOMPARE(Tracing::eventCount(), 0);
+}
+
+void TestTracing::testCondition()
+{
+    Tracing::setEnabled(true);
+    {
+        KWIN_TRACE_IF(false, "test", "skipped");
+        KWIN_TRACE_IF(true, "test", "recorded");
+    }
+    QCOMPARE(Tracing::eventCount(), 1);
+}
+
+void TestTracing::testRingOverflow()
+{
+    Tracing::setEnabled(true);
+    for (int i = 0; i < Tracing::BufferCapacity + 10; ++i) {
+        Tracing::record("test", "overflow", i, i + 1);
+    }
+    QCOMPARE(Tracing::eventCount(), int(Tracing::BufferCapacity));
+
+    // the oldest events got overwritten
+    const QJsonArray events = QJsonDocument::fromJson(Tracing::toChromeTrace()).object().value(QStringLiteral("traceEvents")).toArray();
+    QJsonObject first;
+    for (const QJsonValue &value : events) {
+        if (value.toObject().value(QStringLiteral("ph")).toString() == QLatin1String("X")) {
+            first = value.toObject();
+            break;
+        }
+    }
+    QCOMPARE(first.value(QStringLiteral("ts")).toDouble(), 10 / 1000.0);
+}
+
+void TestTracing::testThreads()
+{
+    Tracing::setEnabled(true);
+    TracingThread thread;
+    thread.setObjectName(QStringLiteral("worker"));
+    thread.start();
+    QVERIFY(thread.wait());
+    {
+        KWIN_TRACE("test", "main");
+    }
+    QCOMPARE(Tracing::eventCount(), 2);
+
+    const QJsonArray events = QJsonDocument::fromJson(Tracing::toChromeTrace()).object().value(QStringLiteral("traceEvents")).toArray();
+    QMap<QString, int> threads;
+    QMap<QString, int> eventThreads;
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        const int tid = event.value(QStringLiteral("tid")).toInt();
+        if (event.value(QStringLiteral("ph")).toString() == QLatin1String("M")) {
+            threads.insert(event.value(QStringLiteral("args")).toObject().value(QStringLiteral("name")).toString(), tid);
+        } else {
+            eventThreads.insert(event.value(QStringLiteral("name")).toString(), tid);
+        }
+    }
+    QVERIFY(threads.contains(QStringLiteral("worker")));
+    QVERIFY(threads.contains(QStringLiteral("main")));
+    QCOMPARE(eventThreads.value(QStringLiteral("thread")), threads.value(QStringLiteral("worker")));
+    QCOMPARE(eventThreads.value(QStringLiteral("main")), threads.value(QStringLiteral("main")));
+}
+
+void TestTracing::testExitedThread()
+{
+    // the buffer of an exited thread stays till its events got exported
+    Tracing::setEnabled(true);
+    TracingThread thread;
+    thread.start();
+    QVERIFY(thread.wait());
+    QCOMPARE(Tracing::eventCount(), 1);
+
+    const QJsonArray events = QJsonDocument::fromJson(Tracing::toChromeTrace()).object().value(QStringLiteral("traceEvents")).toArray();
+    int exported = 0;
+    for (const QJsonValue &value : events) {
+        if (value.toObject().value(QStringLiteral("name")).toString() == QLatin1String("thread")) {
+            exported++;
+        }
+    }
+    QCOMPARE(exported, 1);
+    // exported, so the buffer got freed together with its events
+    QCOMPARE(Tracing::eventCount(), 0);
+    QCOMPARE(Tracing::toChromeTrace().count("\"thread\""), 0);
+}
+
+void TestTracing::testConcurrentExport()
+{
+    // exporting while another thread records does not block it and only exports complete events
+    Tracing::setEnabled(true);
+    RecordingThread thread;
+    thread.start();
+    for (int i = 0; i < 10; ++i) {
+        const QJsonArray events = QJsonDocument::fromJson(Tracing::toChromeTrace()).object().value(QStringLiteral("traceEvents")).toArray();
+        int recorded = 0;
+        double previous = -1;
+        for (const QJsonValue &value : events) {
+            const QJsonObject event = value.toObject();
+            if (event.value(QStringLiteral("ph")).toString() != QLatin1String("X")) {
+                continue;
+            }
+            recorded++;
+            // the thread records consecutive time stamps, a torn or stale event would break the order
+            QCOMPARE(event.value(QStringLiteral("name")).toString(), QStringLiteral("recording"));
+            QCOMPARE(event.value(QStringLiteral("dur")).toDouble(), 1 / 1000.0);
+            const double ts = event.value(QStringLiteral("ts")).toDouble();
+            if (previous >= 0) {
+                QCOMPARE(ts, previous + 1 / 1000.0);
+            }
+            previous = ts;
+        }
+        QVERIFY(recorded <= Tracing::BufferCapacity);
+    }
+    thread.stop.store(1);
+    QVERIFY(thread.wait());
+}
+
+void TestTracing::testChromeTrace()
+{
+    Tracing::setEnabled(true);
+    Tracing::record("compositor", "performCompositing", 2000, 5500);
+
+    const QJsonDocument document = QJsonDocument::fromJson(Tracing::toChromeTrace());
+    QVERIFY(document.isObject());
+    QCOMPARE(document.object().value(QStringLiteral("displayTimeUnit")).toString(), QStringLiteral("ms"));
+    const QJsonArray events = document.object().value(QStringLiteral("traceEvents")).toArray();
+    bool found = false;
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        if (event.value(QStringLiteral("ph")).toString() != QLatin1String("X")) {
+            continue;
+        }
+        QCOMPARE(event.value(QStringLiteral("name")).toString(), QStringLiteral("performCompositing"));
+        QCOMPARE(event.value(QStringLiteral("cat")).toString(), QStringLiteral("compositor"));
+        QCOMPARE(event.value(QStringLiteral("ts")).toDouble(), 2.0);
+        QCOMPARE(event.value(QStringLiteral("dur")).toDouble(), 3.5);
+        found = true;
+    }
+    QVERIFY(found);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.path() + QStringLiteral("/trace.json");
+    QVERIFY(Tracing::dump(fileName));
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(QJsonDocument::fromJson(file.readAll()).isObject());
+}
+
+QTEST_GUILESS_MAIN(TestTracing)
+#include "test_tracing.moc"
@@ -0,0 +1,216 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../windowclipping.h"
+#include <kwineffects.h>
+
+#include <QtTest/QtTest>
+
+using namespace KWin;
+
+// window at 100/100 painted at half its size, like e.g. in present windows
+static const QPointF s_windowPos = QPointF(100, 100);
+static const qreal s_scale = 0.5;
+
+static WindowQuad createQuad(WindowQuadType type, const QRectF &rect)
+{
+    WindowQuad quad(type);
+    quad[0] = WindowVertex(rect.left(), rect.top(), 0.0, 0.0);
+    quad[1] = WindowVertex(rect.right(), rect.top(), 1.0, 0.0);
+    quad[2] = WindowVertex(rect.right(), rect.bottom(), 1.0, 1.0);
+    quad[3] = WindowVertex(rect.left(), rect.bottom(), 0.0, 1.0);
+    return quad;
+}
+
+// quads of a decorated 800x600 window with a shadow
+static WindowQuadList createWindowQuads()
+{
+    WindowQuadList quads;
+    quads << createQuad(WindowQuadShadow, QRectF(-20, -20, 840, 20));
+    quads << createQuad(WindowQuadShadow, QRectF(-20, 0, 20, 600));
+    quads << createQuad(WindowQuadShadow, QRectF(800, 0, 20, 600));
+    quads << createQuad(WindowQuadShadow, QRectF(-20, 600, 840, 20));
+    quads << createQuad(WindowQuadDecoration, QRectF(0, 0, 800, 30));
+    quads << createQuad(WindowQuadDecoration, QRectF(0, 30, 4, 566));
+    quads << createQuad(WindowQuadDecoration, QRectF(796, 30, 4, 566));
+    quads << createQuad(WindowQuadDecoration, QRectF(0, 596, 800, 4));
+    quads << createQuad(WindowQuadContents, QRectF(4, 30, 792, 566));
+    return quads;
+}
+
+// damage consisting of @p count separate small rects on top of the scaled window
+static QRegion createDamage(int count)
+{
+    QRegion region;
+    for (int i = 0; i < count; ++i) {
+        region += QRect(100 + i * 6, 100 + i * 4, 5, 3);
+    }
+    return region;
+}
+
+// maps the screen damage into window coordinates, like SceneOpenGL does for scaled windows
+static QVector<QRectF> windowRects(const QRegion &region)
+{
+    QVector<QRectF> rects;
+    foreach (const QRect &r, region.rects()) {
+        rects << QRectF((r.x() - s_windowPos.x()) / s_scale, (r.y() - s_windowPos.y()) / s_scale,
+                        r.width() / s_scale, r.height() / s_scale);
+    }
+    return rects;
+}
+
+static qreal area(const WindowQuadList &quads)
+{
+    qreal area = 0.0;
+    foreach (const WindowQuad &quad, quads) {
+        area += (quad.right() - quad.left()) * (quad.bottom() - quad.top());
+    }
+    return area;
+}
+
+class TestWindowQuadClipping : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testClipped();
+    void testDrawCount_data();
+    void testDrawCount();
+    void testUntransformed();
+    void testClipping_data();
+    void testClipping();
+};
+
+void TestWindowQuadClipping::testClipped()
+{
+    const WindowQuadList quads = createWindowQuads();
+    QVector<QRectF> rects;
+    // fully contains the content
+    rects << QRectF(0, 20, 800, 580);
+    // intersects the top decoration and shadow
+    rects << QRectF(100, -10, 10, 20);
+    const WindowQuadList clipped = quads.clipped(rects);
+
+    QCOMPARE(clipped.select(WindowQuadContents).count(), 1);
+    QCOMPARE(clipped.select(WindowQuadContents).first().left(), 4.0);
+    QCOMPARE(area(clipped.select(WindowQuadShadow)), 10.0 * 10.0);
+    QCOMPARE(area(clipped.select(WindowQuadDecoration)), 800.0 * 10.0 + 10.0 * 10.0 + 4.0 * 566.0 * 2 + 800.0 * 4.0);
+
+    // the texture coordinates follow the split
+    const WindowQuad shadow = clipped.select(WindowQuadShadow).first();
+    QCOMPARE(shadow[0].textureX(), 120.0 / 840.0);
+    QCOMPARE(shadow[0].textureY(), 0.5);
+
+    QVERIFY(quads.clipped(QVector<QRectF>() << QRectF(2000, 2000, 10, 10)).isEmpty());
+}
+
+void TestWindowQuadClipping::testDrawCount_data()
+{
+    QTest::addColumn<int>("rects");
+    QTest::addColumn<bool>("axisAligned");
+    QTest::addColumn<bool>("scissor");
+    QTest::addColumn<int>("expectedDraws");
+
+    // the damage is in the top left of the window: up to 4 rects it only hits the top
+    // decoration, from then on also the content, but never the shadow.
+    // Scissoring draws all three leafs once per rect, so does a single rect.
+    QTest::newRow("1 rects/scaled") << 1 << true << true << 3;
+    QTest::newRow("1 rects/rotated") << 1 << false << true << 3;
+    QTest::newRow("4 rects/scaled") << 4 << true << false << 1;
+    QTest::newRow("4 rects/rotated") << 4 << false << true << 12;
+    QTest::newRow("16 rects/scaled") << 16 << true << false << 2;
+    QTest::newRow("16 rects/rotated") << 16 << false << true << 48;
+    QTest::newRow("64 rects/scaled") << 64 << true << false << 2;
+    QTest::newRow("64 rects/rotated") << 64 << false << true << 192;
+}
+
+void TestWindowQuadClipping::testDrawCount()
+{
+    // number of draw calls SceneOpenGL issues for one transformed window
+    QFETCH(int, rects);
+    QFETCH(bool, axisAligned);
+    QFETCH(bool, scissor);
+    QFETCH(int, expectedDraws);
+
+    const QRegion damage = createDamage(rects);
+    QCOMPARE(damage.rectCount(), rects);
+
+    WindowClipping clipping;
+    clipping.transformed = true;
+    clipping.axisAligned = axisAligned;
+    clipping.position = s_windowPos;
+    clipping.xScale = s_scale;
+    clipping.yScale = s_scale;
+    WindowQuadList quads = createWindowQuads();
+    QCOMPARE(clipping.clip(quads, damage), scissor);
+
+    // SceneOpenGL issues one draw per non empty leaf, with scissoring once per damaged rect
+    int draws = 0;
+    for (WindowQuadType type : {WindowQuadShadow, WindowQuadDecoration, WindowQuadContents}) {
+        if (!quads.select(type).isEmpty()) {
+            draws += scissor ? damage.rectCount() : 1;
+        }
+    }
+    QCOMPARE(draws, expectedDraws);
+    QTest::setBenchmarkResult(draws, QTest::Events);
+}
+
+void TestWindowQuadClipping::testUntransformed()
+{
+    // a window painted without transformation always gets its quads clipped
+    WindowClipping clipping;
+    clipping.position = QPointF(100, 100);
+    WindowQuadList quads = createWindowQuads();
+    QVERIFY(!clipping.clip(quads, QRegion(100, 100, 800, 30)));
+    QCOMPARE(quads.count(), 1);
+    QCOMPARE(quads.first().type(), WindowQuadDecoration);
+
+    // an infinite region paints everything
+    quads = createWindowQuads();
+    QVERIFY(!clipping.clip(quads, infiniteRegion()));
+    QCOMPARE(quads.count(), createWindowQuads().count());
+
+    // nor is a transformed window scissored
+    clipping.transformed = true;
+    QVERIFY(!clipping.clip(quads, infiniteRegion()));
+}
+
+void TestWindowQuadClipping::testClipping_data()
+{
+    QTest::addColumn<int>("rects");
+
+    QTest::newRow("1") << 1;
+    QTest::newRow("4") << 4;
+    QTest::newRow("16") << 16;
+    QTest::newRow("64") << 64;
+}
+
+void TestWindowQuadClipping::testClipping()
+{
+    // cpu side cost of clipping the geometry instead of scissoring
+    QFETCH(int, rects);
+    const WindowQuadList quads = createWindowQuads();
+    const QVector<QRectF> clip = windowRects(createDamage(rects));
+
+    QBENCHMARK {
+        quads.clipped(clip);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestWindowQuadClipping)
+#include "test_window_quad_clipping.moc"
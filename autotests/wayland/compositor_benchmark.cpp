@@ -0,0 +1,426 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "abstract_backend.h"
+#include "composite.h"
+#include "effects.h"
+#include "scene.h"
+#include "shell_client.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <kwinglutils.h>
+
+#include <KWayland/Client/registry.h>
+#include <KWayland/Client/connection_thread.h>
+#include <KWayland/Client/compositor.h>
+#include <KWayland/Client/shm_pool.h>
+#include <KWayland/Client/shell.h>
+#include <KWayland/Client/surface.h>
+#include <KWayland/Client/event_queue.h>
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QtMath>
+
+#include <time.h>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_compositor_benchmark-0");
+// size of the square which moves over the windows with partial damage
+static const int s_partialDamageSize = 32;
+
+/**
+ * Description of a synthetic scene, parsed from a comma separated list of key=value pairs, e.g.
+ * "windows=20,size=400x300,damage=partial,opacity=0.8,change=move,frames=100".
+ *
+ * damage is one of none, partial or full. change is one of none, move or opacity, it changes
+ * the geometry or the opacity of all windows every frame from within KWin, no effect is involved.
+ **/
+struct BenchmarkScene {
+    int windows = 20;
+    QSize size = QSize(400, 300);
+    QString damage = QStringLiteral("full");
+    qreal opacity = 1.0;
+    QString change = QStringLiteral("none");
+    int frames = 100;
+
+    static BenchmarkScene parse(const QString &description) {
+        BenchmarkScene scene;
+        const auto options = description.split(QLatin1Char(','), QString::SkipEmptyParts);
+        for (const QString &option : options) {
+            const QString key = option.section(QLatin1Char('='), 0, 0).trimmed();
+            const QString value = option.section(QLatin1Char('='), 1).trimmed();
+            if (key == QLatin1String("windows")) {
+                scene.windows = qMax(1, value.toInt());
+            } else if (key == QLatin1String("size")) {
+                const int width = value.section(QLatin1Char('x'), 0, 0).toInt();
+                const int height = value.section(QLatin1Char('x'), 1, 1).toInt();
+                if (width > 0 && height > 0) {
+                    scene.size = QSize(width, height);
+                }
+            } else if (key == QLatin1String("damage")) {
+                scene.damage = value;
+            } else if (key == QLatin1String("opacity")) {
+                scene.opacity = qBound(0.0, value.toDouble(), 1.0);
+            } else if (key == QLatin1String("change")) {
+                scene.change = value;
+            } else if (key == QLatin1String("frames")) {
+                scene.frames = qMax(1, value.toInt());
+            } else {
+                qWarning() << "Unknown benchmark scene option" << key;
+            }
+        }
+        return scene;
+    }
+    QJsonObject toJson() const {
+        return QJsonObject{
+            {QStringLiteral("windows"), windows},
+            {QStringLiteral("size"), QStringLiteral("%1x%2").arg(size.width()).arg(size.height())},
+            {QStringLiteral("damage"), damage},
+            {QStringLiteral("opacity"), opacity},
+            {QStringLiteral("change"), change},
+            {QStringLiteral("frames"), frames}
+        };
+    }
+};
+
+static qint64 threadCpuTime()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Drives synthetic clients for a fixed number of frames and records per frame the CPU time
+ * of the compositor thread, the wall time from starting the frame till it got presented, the
+ * draw calls and the window pixmap texture allocations and uploads.
+ *
+ * The built-in scenes run by default. A custom scene can be passed in the environment
+ * variable KWIN_BENCHMARK_SCENE (see BenchmarkScene), KWIN_COMPOSE selects the scene
+ * as usual. If KWIN_BENCHMARK_OUTPUT names a file all frames are written to it as JSON.
+ **/
+class CompositorBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkScene_data();
+    void benchmarkScene();
+
+private:
+    struct Frame {
+        qint64 cpuTime = 0;
+        qint64 paintTime = 0;
+        quint64 drawCalls = 0;
+        quint64 textureAllocations = 0;
+        quint64 uploadedBytes = 0;
+    };
+    void render(KWayland::Client::Surface *surface, QImage &image, int frame, const QString &damage);
+    void startFrame();
+    void endFrame();
+
+    KWayland::Client::ConnectionThread *m_connection = nullptr;
+    KWayland::Client::Compositor *m_compositor = nullptr;
+    KWayland::Client::ShmPool *m_shm = nullptr;
+    KWayland::Client::Shell *m_shell = nullptr;
+    KWayland::Client::EventQueue *m_queue = nullptr;
+    QThread *m_thread = nullptr;
+
+    bool m_recording = false;
+    bool m_frameStarted = false;
+    Frame m_start;
+    QElapsedTimer m_frameTimer;
+    QVector<Frame> m_frames;
+    QJsonArray m_results;
+};
+
+void CompositorBenchmark::initTestCase()
+{
+    qRegisterMetaType<KWin::ShellClient*>();
+    qRegisterMetaType<KWin::AbstractClient*>();
+    waylandServer()->backend()->setInitialWindowSize(QSize(1280, 1024));
+    waylandServer()->init(s_socketName.toLocal8Bit());
+
+    kwinApp()->start();
+    QVERIFY(Compositor::self());
+    QSignalSpy compositorToggledSpy(Compositor::self(), &Compositor::compositingToggled);
+    QVERIFY(compositorToggledSpy.isValid());
+    QVERIFY(compositorToggledSpy.wait());
+    QVERIFY(effects);
+    connect(Compositor::self(), &Compositor::aboutToPaintFrame, this, &CompositorBenchmark::startFrame);
+    connect(Compositor::self(), &Compositor::framePresented, this, &CompositorBenchmark::endFrame);
+
+    using namespace KWayland::Client;
+    // setup connection
+    m_connection = new ConnectionThread;
+    QSignalSpy connectedSpy(m_connection, &ConnectionThread::connected);
+    QVERIFY(connectedSpy.isValid());
+    m_connection->setSocketName(s_socketName);
+
+    m_thread = new QThread(this);
+    m_connection->moveToThread(m_thread);
+    m_thread->start();
+
+    m_connection->initConnection();
+    QVERIFY(connectedSpy.wait());
+
+    m_queue = new EventQueue(this);
+    m_queue->setup(m_connection);
+    QVERIFY(m_queue->isValid());
+
+    Registry registry;
+    registry.setEventQueue(m_queue);
+    QSignalSpy allAnnounced(&registry, &Registry::interfacesAnnounced);
+    QVERIFY(allAnnounced.isValid());
+    registry.create(m_connection->display());
+    QVERIFY(registry.isValid());
+    registry.setup();
+    QVERIFY(allAnnounced.wait());
+
+    const auto compositor = registry.interface(Registry::Interface::Compositor);
+    m_compositor = registry.createCompositor(compositor.name, compositor.version, this);
+    QVERIFY(m_compositor->isValid());
+    const auto shm = registry.interface(Registry::Interface::Shm);
+    m_shm = registry.createShmPool(shm.name, shm.version, this);
+    QVERIFY(m_shm->isValid());
+    const auto shell = registry.interface(Registry::Interface::Shell);
+    m_shell = registry.createShell(shell.name, shell.version, this);
+    QVERIFY(m_shell->isValid());
+}
+
+void CompositorBenchmark::cleanupTestCase()
+{
+    const QString fileName = QString::fromLocal8Bit(qgetenv("KWIN_BENCHMARK_OUTPUT"));
+    if (!fileName.isEmpty()) {
+        QFile file(fileName);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            file.write(QJsonDocument(m_results).toJson());
+        } else {
+            qWarning() << "Cannot write benchmark results to" << fileName;
+        }
+    }
+
+    delete m_compositor;
+    m_compositor = nullptr;
+    delete m_shm;
+    m_shm = nullptr;
+    delete m_shell;
+    m_shell = nullptr;
+    delete m_queue;
+    m_queue = nullptr;
+    if (m_thread) {
+        m_connection->deleteLater();
+        m_thread->quit();
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+        m_connection = nullptr;
+    }
+}
+
+void CompositorBenchmark::startFrame()
+{
+    if (!m_recording) {
+        return;
+    }
+    // a pass which does not paint anything starts again with the next pass
+    const Scene::WindowPixmapStatistics &pixmaps = Compositor::self()->scene()->windowPixmapStatistics();
+    m_start.cpuTime = threadCpuTime();
+    m_start.drawCalls = GLVertexBuffer::drawCallCount();
+    m_start.textureAllocations = pixmaps.textureAllocations;
+    m_start.uploadedBytes = pixmaps.uploadedBytes;
+    m_frameTimer.start();
+    m_frameStarted = true;
+}
+
+void CompositorBenchmark::endFrame()
+{
+    if (!m_recording || !m_frameStarted) {
+        return;
+    }
+    m_frameStarted = false;
+    const Scene::WindowPixmapStatistics &pixmaps = Compositor::self()->scene()->windowPixmapStatistics();
+    Frame frame;
+    frame.paintTime = m_frameTimer.nsecsElapsed();
+    frame.cpuTime = threadCpuTime() - m_start.cpuTime;
+    frame.drawCalls = GLVertexBuffer::drawCallCount() - m_start.drawCalls;
+    frame.textureAllocations = pixmaps.textureAllocations - m_start.textureAllocations;
+    frame.uploadedBytes = pixmaps.uploadedBytes - m_start.uploadedBytes;
+    m_frames << frame;
+}
+
+void CompositorBenchmark::render(KWayland::Client::Surface *surface, QImage &image, int frame, const QString &damage)
+{
+    QRect rect;
+    if (damage == QLatin1String("partial")) {
+        // a small square wandering over the window, like a blinking cursor or a spinner
+        const int columns = qMax(1, image.width() / s_partialDamageSize);
+        const int rows = qMax(1, image.height() / s_partialDamageSize);
+        rect = QRect((frame % columns) * s_partialDamageSize, ((frame / columns) % rows) * s_partialDamageSize,
+                     s_partialDamageSize, s_partialDamageSize) & image.rect();
+    } else {
+        rect = image.rect();
+    }
+    QPainter p(&image);
+    p.fillRect(rect, QColor::fromHsv((frame * 37) % 360, 255, 255));
+    p.end();
+    surface->attachBuffer(m_shm->createBuffer(image));
+    surface->damage(rect);
+    surface->commit(KWayland::Client::Surface::CommitFlag::None);
+}
+
+void CompositorBenchmark::benchmarkScene_data()
+{
+    QTest::addColumn<QString>("description");
+
+    const QString custom = QString::fromLocal8Bit(qgetenv("KWIN_BENCHMARK_SCENE"));
+    if (!custom.isEmpty()) {
+        QTest::newRow("custom") << custom;
+        return;
+    }
+    QTest::newRow("static") << QStringLiteral("windows=20,damage=none");
+    QTest::newRow("full damage") << QStringLiteral("windows=20,damage=full");
+    QTest::newRow("partial damage") << QStringLiteral("windows=20,damage=partial");
+    QTest::newRow("translucent") << QStringLiteral("windows=20,damage=partial,opacity=0.8");
+    QTest::newRow("moving") << QStringLiteral("windows=20,damage=none,change=move");
+    QTest::newRow("changing opacity") << QStringLiteral("windows=20,damage=none,change=opacity");
+    QTest::newRow("large windows") << QStringLiteral("windows=5,size=1200x900,damage=full");
+}
+
+void CompositorBenchmark::benchmarkScene()
+{
+    QFETCH(QString, description);
+    const BenchmarkScene scene = BenchmarkScene::parse(description);
+
+    using namespace KWayland::Client;
+    QSignalSpy clientAddedSpy(waylandServer(), &WaylandServer::shellClientAdded);
+    QVERIFY(clientAddedSpy.isValid());
+    QList<Surface*> surfaces;
+    QList<ShellClient*> clients;
+    QVector<QImage> images;
+    for (int i = 0; i < scene.windows; ++i) {
+        Surface *surface = m_compositor->createSurface(m_compositor);
+        QVERIFY(surface);
+        ShellSurface *shellSurface = m_shell->createSurface(surface, surface);
+        QVERIFY(shellSurface);
+        // opaque content, translucency comes from the window opacity
+        QImage image(scene.size, QImage::Format_RGB32);
+        image.fill(Qt::blue);
+        surfaces << surface;
+        images << image;
+        render(surface, images.last(), 0, QStringLiteral("full"));
+        m_connection->flush();
+        QVERIFY(clientAddedSpy.wait());
+        ShellClient *c = clientAddedSpy.last().first().value<ShellClient*>();
+        QVERIFY(c);
+        c->setOpacity(scene.opacity);
+        clients << c;
+    }
+    QVector<QPoint> positions;
+    for (ShellClient *c : clients) {
+        positions << c->pos();
+    }
+
+    QSignalSpy framePresentedSpy(Compositor::self(), &Compositor::framePresented);
+    QVERIFY(framePresentedSpy.isValid());
+    // let the initial uploads settle
+    Compositor::self()->addRepaintFull();
+    QVERIFY(framePresentedSpy.wait());
+
+    m_frames.clear();
+    m_frameStarted = false;
+    m_recording = true;
+    const bool damage = scene.damage != QLatin1String("none");
+    for (int frame = 1; frame <= scene.frames; ++frame) {
+        QSignalSpy damagedSpy(clients.last(), &Toplevel::damaged);
+        QVERIFY(damagedSpy.isValid());
+        if (damage) {
+            for (int i = 0; i < surfaces.count(); ++i) {
+                render(surfaces.at(i), images[i], frame, scene.damage);
+            }
+            m_connection->flush();
+        }
+        if (scene.change == QLatin1String("move")) {
+            for (int i = 0; i < clients.count(); ++i) {
+                clients.at(i)->move(positions.at(i) + QPoint(frame % 50, frame % 30));
+            }
+        } else if (scene.change == QLatin1String("opacity")) {
+            for (ShellClient *c : clients) {
+                c->setOpacity(scene.opacity * (0.5 + 0.5 * qAbs(qSin(frame / 10.0))));
+            }
+        } else if (!damage) {
+            Compositor::self()->addRepaintFull();
+        }
+        if (damage) {
+            // requests are processed in order, once the last window got damaged all did
+            QVERIFY(damagedSpy.wait());
+        }
+        framePresentedSpy.clear();
+        QVERIFY(framePresentedSpy.wait());
+    }
+    m_recording = false;
+    QVERIFY(!m_frames.isEmpty());
+
+    QJsonArray frames;
+    qint64 paintTime = 0;
+    for (const Frame &frame : m_frames) {
+        paintTime += frame.paintTime;
+        frames.append(QJsonObject{
+            {QStringLiteral("cpuTime"), frame.cpuTime / 1000.0},
+            {QStringLiteral("paintTime"), frame.paintTime / 1000.0},
+            {QStringLiteral("drawCalls"), qint64(frame.drawCalls)},
+            {QStringLiteral("textureAllocations"), qint64(frame.textureAllocations)},
+            {QStringLiteral("uploadedBytes"), qint64(frame.uploadedBytes)}
+        });
+    }
+    QJsonObject result{
+        {QStringLiteral("name"), QString::fromLatin1(QTest::currentDataTag())},
+        {QStringLiteral("scene"), scene.toJson()},
+        {QStringLiteral("compositingType"), effects->compositingType() == OpenGL2Compositing ? QStringLiteral("OpenGL2") : QStringLiteral("QPainter")},
+        // times are in microseconds
+        {QStringLiteral("frames"), frames}
+    };
+    m_results.append(result);
+
+    // destroy the windows again
+    QSignalSpy clientRemovedSpy(waylandServer(), &WaylandServer::shellClientRemoved);
+    QVERIFY(clientRemovedSpy.isValid());
+    qDeleteAll(surfaces);
+    m_connection->flush();
+    while (clientRemovedSpy.count() < clients.count()) {
+        QVERIFY(clientRemovedSpy.wait());
+    }
+
+    // QTest has no metric for thread CPU time, that one is only part of the JSON output
+    QTest::setBenchmarkResult(qreal(paintTime) / m_frames.count() / 1000000.0, QTest::WalltimeMilliseconds);
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::CompositorBenchmark)
+#include "compositor_benchmark.moc"
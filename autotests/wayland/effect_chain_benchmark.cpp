@@ -0,0 +1,249 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "abstract_backend.h"
+#include "abstract_client.h"
+#include "composite.h"
+#include "effects.h"
+#include "effectloader.h"
+#include "shell_client.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <KWayland/Client/registry.h>
+#include <KWayland/Client/connection_thread.h>
+#include <KWayland/Client/compositor.h>
+#include <KWayland/Client/shm_pool.h>
+#include <KWayland/Client/shell.h>
+#include <KWayland/Client/surface.h>
+#include <KWayland/Client/event_queue.h>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_effect_chain_benchmark-0");
+static const int s_screenEffectCount = 6;
+static const int s_windowEffectCount = 4;
+static const int s_windowCount = 200;
+// whether the fake effects announce their paint hooks or claim to hook into everything
+static bool s_announceHooks = true;
+// the windows the fake window effects are interested in
+static QSet<EffectWindow*> s_windowsOfInterest;
+
+/**
+ * Effect which only forwards in the chained paint methods, either only on screen level
+ * or for every third window.
+ **/
+class ChainBenchmarkEffect : public Effect
+{
+    Q_OBJECT
+public:
+    explicit ChainBenchmarkEffect(bool screenOnly)
+        : Effect()
+        , m_screenOnly(screenOnly) {
+    }
+    PaintHooks paintHooks() const override {
+        if (!s_announceHooks) {
+            return AllPaintHooks;
+        }
+        return m_screenOnly ? ScreenPaintHooks : ScreenPaintHooks | PrePaintWindowHook | PaintWindowHook | PostPaintWindowHook;
+    }
+    bool isActiveForWindow(EffectWindow *w) const override {
+        if (!s_announceHooks) {
+            return true;
+        }
+        return !m_screenOnly && s_windowsOfInterest.contains(w);
+    }
+
+private:
+    bool m_screenOnly;
+};
+
+class EffectChainBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void testWindowChain_data();
+    void testWindowChain();
+
+private:
+    KWayland::Client::ConnectionThread *m_connection = nullptr;
+    KWayland::Client::Compositor *m_compositor = nullptr;
+    KWayland::Client::ShmPool *m_shm = nullptr;
+    KWayland::Client::Shell *m_shell = nullptr;
+    KWayland::Client::EventQueue *m_queue = nullptr;
+    QThread *m_thread = nullptr;
+    EffectWindowList m_windows;
+};
+
+void EffectChainBenchmark::initTestCase()
+{
+    qRegisterMetaType<KWin::ShellClient*>();
+    qRegisterMetaType<KWin::AbstractClient*>();
+    waylandServer()->backend()->setInitialWindowSize(QSize(1280, 1024));
+    waylandServer()->init(s_socketName.toLocal8Bit());
+    kwinApp()->start();
+    QVERIFY(Compositor::self());
+    QSignalSpy compositorToggledSpy(Compositor::self(), &Compositor::compositingToggled);
+    QVERIFY(compositorToggledSpy.isValid());
+    QVERIFY(compositorToggledSpy.wait());
+    QVERIFY(effects);
+
+    // load the fake effects
+    QObject *loader = nullptr;
+    const auto children = effects->children();
+    for (auto it = children.begin(); it != children.end(); ++it) {
+        if (qstrcmp((*it)->metaObject()->className(), "KWin::EffectLoader") == 0) {
+            loader = *it;
+            break;
+        }
+    }
+    QVERIFY(loader);
+    for (int i = 0; i < s_screenEffectCount + s_windowEffectCount; ++i) {
+        const QString name = QStringLiteral("chainbenchmark%1").arg(i);
+        Effect *effect = new ChainBenchmarkEffect(i < s_screenEffectCount);
+        QVERIFY(QMetaObject::invokeMethod(loader, "effectLoaded", Q_ARG(KWin::Effect*, effect), Q_ARG(QString, name)));
+        QVERIFY(static_cast<EffectsHandlerImpl*>(effects)->isEffectLoaded(name));
+    }
+
+    using namespace KWayland::Client;
+    // setup connection
+    m_connection = new ConnectionThread;
+    QSignalSpy connectedSpy(m_connection, &ConnectionThread::connected);
+    QVERIFY(connectedSpy.isValid());
+    m_connection->setSocketName(s_socketName);
+
+    m_thread = new QThread(this);
+    m_connection->moveToThread(m_thread);
+    m_thread->start();
+
+    m_connection->initConnection();
+    QVERIFY(connectedSpy.wait());
+
+    m_queue = new EventQueue(this);
+    m_queue->setup(m_connection);
+    QVERIFY(m_queue->isValid());
+
+    Registry registry;
+    registry.setEventQueue(m_queue);
+    QSignalSpy allAnnounced(&registry, &Registry::interfacesAnnounced);
+    QVERIFY(allAnnounced.isValid());
+    registry.create(m_connection->display());
+    QVERIFY(registry.isValid());
+    registry.setup();
+    QVERIFY(allAnnounced.wait());
+
+    const auto compositor = registry.interface(Registry::Interface::Compositor);
+    m_compositor = registry.createCompositor(compositor.name, compositor.version, this);
+    QVERIFY(m_compositor->isValid());
+    const auto shm = registry.interface(Registry::Interface::Shm);
+    m_shm = registry.createShmPool(shm.name, shm.version, this);
+    QVERIFY(m_shm->isValid());
+    const auto shell = registry.interface(Registry::Interface::Shell);
+    m_shell = registry.createShell(shell.name, shell.version, this);
+    QVERIFY(m_shell->isValid());
+
+    // create the windows
+    QSignalSpy clientAddedSpy(waylandServer(), &WaylandServer::shellClientAdded);
+    QVERIFY(clientAddedSpy.isValid());
+    QImage img(QSize(100, 50), QImage::Format_ARGB32);
+    img.fill(Qt::blue);
+    for (int i = 0; i < s_windowCount; ++i) {
+        Surface *surface = m_compositor->createSurface(m_compositor);
+        QVERIFY(surface);
+        ShellSurface *shellSurface = m_shell->createSurface(surface, surface);
+        QVERIFY(shellSurface);
+        surface->attachBuffer(m_shm->createBuffer(img));
+        surface->damage(QRect(0, 0, 100, 50));
+        surface->commit(Surface::CommitFlag::None);
+        m_connection->flush();
+        QVERIFY(clientAddedSpy.wait());
+        ShellClient *c = clientAddedSpy.last().first().value<ShellClient*>();
+        QVERIFY(c);
+        QVERIFY(c->effectWindow());
+        m_windows << c->effectWindow();
+        if (i % 3 == 0) {
+            s_windowsOfInterest << c->effectWindow();
+        }
+    }
+}
+
+void EffectChainBenchmark::cleanupTestCase()
+{
+    m_windows.clear();
+    s_windowsOfInterest.clear();
+    delete m_compositor;
+    m_compositor = nullptr;
+    delete m_shm;
+    m_shm = nullptr;
+    delete m_shell;
+    m_shell = nullptr;
+    delete m_queue;
+    m_queue = nullptr;
+    if (m_thread) {
+        m_connection->deleteLater();
+        m_thread->quit();
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+        m_connection = nullptr;
+    }
+}
+
+void EffectChainBenchmark::testWindowChain_data()
+{
+    QTest::addColumn<bool>("announceHooks");
+
+    QTest::newRow("all hooks") << false;
+    QTest::newRow("announced hooks") << true;
+}
+
+void EffectChainBenchmark::testWindowChain()
+{
+    // simulates the window related parts of one frame, the final painting is not included
+    // as that is independent of the effect chain
+    QFETCH(bool, announceHooks);
+    s_announceHooks = announceHooks;
+    EffectsHandlerImpl *e = static_cast<EffectsHandlerImpl*>(effects);
+
+    QBENCHMARK {
+        e->startPaint();
+        ScreenPrePaintData screenData;
+        screenData.mask = 0;
+        e->prePaintScreen(screenData, 0);
+        for (EffectWindow *w : m_windows) {
+            WindowPrePaintData data;
+            data.mask = 0;
+            e->prePaintWindow(w, data, 0);
+        }
+        for (EffectWindow *w : m_windows) {
+            e->postPaintWindow(w);
+        }
+        e->postPaintScreen();
+    }
+    s_announceHooks = true;
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::EffectChainBenchmark)
+#include "effect_chain_benchmark.moc"
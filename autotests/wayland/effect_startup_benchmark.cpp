@@ -0,0 +1,142 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "abstract_backend.h"
+#include "composite.h"
+#include "effects.h"
+#include "wayland_server.h"
+
+#include <KConfigGroup>
+
+#include <QElapsedTimer>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_effect_startup_benchmark-0");
+
+/**
+ * Measures how long it takes from starting the compositor till the first frame is presented
+ * and till the default effects are loaded. By default the effects are loaded as part of the
+ * compositor setup, run with KWIN_BENCHMARK_LOAD_EFFECTS_AFTER_FIRST_FRAME=1 to compare with
+ * LoadEffectsAfterFirstFrame, which loads them once the first frame got presented.
+ **/
+class EffectStartupBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void benchmarkStartup_data();
+    void benchmarkStartup();
+
+public Q_SLOTS:
+    // not a private slot, so that it does not get run as a test function
+    void effectLoaded();
+
+private:
+    QElapsedTimer m_timer;
+    QScopedPointer<QSignalSpy> m_effectLoadedSpy;
+    qint64 m_firstFrame = 0;
+    qint64 m_effectsLoaded = 0;
+};
+
+void EffectStartupBenchmark::initTestCase()
+{
+    waylandServer()->backend()->setInitialWindowSize(QSize(1280, 1024));
+    waylandServer()->init(s_socketName.toLocal8Bit());
+
+    // the shaders of the effects are what makes loading expensive
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+
+    KSharedConfig::Ptr config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    config->group("Compositing").writeEntry("LoadEffectsAfterFirstFrame",
+                                            qEnvironmentVariableIsSet("KWIN_BENCHMARK_LOAD_EFFECTS_AFTER_FIRST_FRAME"));
+    config->sync();
+    kwinApp()->setConfig(config);
+
+    // by default the effects get loaded while setting up the compositor,
+    // so the spy has to be on the effect loader before the first one can be loaded
+    connect(kwinApp(), &Application::workspaceCreated, this,
+        [this] {
+            connect(Compositor::self(), &Compositor::compositingToggled, this,
+                [this] (bool active) {
+                    if (!active || m_effectLoadedSpy) {
+                        return;
+                    }
+                    const auto children = effects->children();
+                    for (auto it = children.begin(); it != children.end(); ++it) {
+                        if (qstrcmp((*it)->metaObject()->className(), "KWin::EffectLoader") == 0) {
+                            m_effectLoadedSpy.reset(new QSignalSpy(*it, SIGNAL(effectLoaded(KWin::Effect*,QString))));
+                            connect(*it, SIGNAL(effectLoaded(KWin::Effect*,QString)), this, SLOT(effectLoaded()));
+                            break;
+                        }
+                    }
+                }
+            );
+        }
+    );
+    m_timer.start();
+    kwinApp()->start();
+    QVERIFY(Compositor::self());
+    QSignalSpy framePresentedSpy(Compositor::self(), &Compositor::framePresented);
+    QVERIFY(framePresentedSpy.isValid());
+    if (!effects) {
+        QSignalSpy compositorToggledSpy(Compositor::self(), &Compositor::compositingToggled);
+        QVERIFY(compositorToggledSpy.isValid());
+        QVERIFY(compositorToggledSpy.wait());
+    }
+    QVERIFY(effects);
+    QCOMPARE(effects->compositingType(), OpenGL2Compositing);
+    QVERIFY(m_effectLoadedSpy);
+    QVERIFY(m_effectLoadedSpy->isValid());
+
+    if (framePresentedSpy.isEmpty()) {
+        QVERIFY(framePresentedSpy.wait());
+    }
+    m_firstFrame = m_timer.elapsed();
+    // the effects are loaded one per event loop pass, wait till no further one shows up
+    while (m_effectLoadedSpy->wait(1000)) {
+    }
+    QVERIFY(!m_effectLoadedSpy->isEmpty());
+}
+
+void EffectStartupBenchmark::effectLoaded()
+{
+    m_effectsLoaded = m_timer.elapsed();
+}
+
+void EffectStartupBenchmark::benchmarkStartup_data()
+{
+    QTest::addColumn<bool>("firstFrame");
+
+    QTest::newRow("first frame") << true;
+    QTest::newRow("effects loaded") << false;
+}
+
+void EffectStartupBenchmark::benchmarkStartup()
+{
+    QFETCH(bool, firstFrame);
+    QTest::setBenchmarkResult(firstFrame ? m_firstFrame : m_effectsLoaded, QTest::WalltimeMilliseconds);
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::EffectStartupBenchmark)
+#include "effect_startup_benchmark.moc"
@@ -0,0 +1,329 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "abstract_backend.h"
+#include "composite.h"
+#include "shell_client.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <KWayland/Client/connection_thread.h>
+#include <KWayland/Client/compositor.h>
+#include <KWayland/Client/event_queue.h>
+#include <KWayland/Client/registry.h>
+#include <KWayland/Client/shell.h>
+#include <KWayland/Client/shm_pool.h>
+#include <KWayland/Client/surface.h>
+
+#include <wayland-client-protocol.h>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_frame_callback-0");
+static const int s_frameCount = 30;
+
+// KWayland's Surface::frameRendered does not carry the timestamp, so the tests
+// request the frame callbacks directly to be able to compare it
+struct FrameCallback
+{
+    bool done = false;
+    quint32 timestamp = 0;
+};
+
+static void frameCallbackDone(void *data, wl_callback *callback, uint32_t timestamp)
+{
+    FrameCallback *frameCallback = reinterpret_cast<FrameCallback*>(data);
+    frameCallback->done = true;
+    frameCallback->timestamp = timestamp;
+    wl_callback_destroy(callback);
+}
+
+static const struct wl_callback_listener s_frameCallbackListener = {
+    frameCallbackDone
+};
+
+class FrameCallbackTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void testCallbackAfterPresentation();
+    void testCallbackTiming();
+    void testNoCallbackForMinimized();
+    void testNoCallbackWithoutWindow();
+
+private:
+    ShellClient *showWindow(KWayland::Client::Surface *surface);
+    void render(KWayland::Client::Surface *surface, const QColor &color);
+    void render(KWayland::Client::Surface *surface, const QColor &color, FrameCallback *frameCallback);
+    void attachBuffer(KWayland::Client::Surface *surface, const QColor &color);
+    KWayland::Client::ConnectionThread *m_connection = nullptr;
+    KWayland::Client::Compositor *m_compositor = nullptr;
+    KWayland::Client::ShmPool *m_shm = nullptr;
+    KWayland::Client::Shell *m_shell = nullptr;
+    KWayland::Client::EventQueue *m_queue = nullptr;
+    QThread *m_thread = nullptr;
+};
+
+void FrameCallbackTest::initTestCase()
+{
+    qRegisterMetaType<KWin::ShellClient*>();
+    qRegisterMetaType<KWin::AbstractClient*>();
+    QSignalSpy workspaceCreatedSpy(kwinApp(), &Application::workspaceCreated);
+    QVERIFY(workspaceCreatedSpy.isValid());
+    waylandServer()->backend()->setInitialWindowSize(QSize(1280, 1024));
+    waylandServer()->init(s_socketName.toLocal8Bit());
+    kwinApp()->start();
+    QVERIFY(workspaceCreatedSpy.wait());
+    waylandServer()->initWorkspace();
+}
+
+void FrameCallbackTest::init()
+{
+    using namespace KWayland::Client;
+    // setup connection
+    m_connection = new ConnectionThread;
+    QSignalSpy connectedSpy(m_connection, &ConnectionThread::connected);
+    QVERIFY(connectedSpy.isValid());
+    m_connection->setSocketName(s_socketName);
+
+    m_thread = new QThread(this);
+    m_connection->moveToThread(m_thread);
+    m_thread->start();
+
+    m_connection->initConnection();
+    QVERIFY(connectedSpy.wait());
+
+    m_queue = new EventQueue(this);
+    m_queue->setup(m_connection);
+    QVERIFY(m_queue->isValid());
+
+    Registry registry;
+    registry.setEventQueue(m_queue);
+    QSignalSpy allAnnounced(&registry, &Registry::interfacesAnnounced);
+    QVERIFY(allAnnounced.isValid());
+    registry.create(m_connection->display());
+    QVERIFY(registry.isValid());
+    registry.setup();
+    QVERIFY(allAnnounced.wait());
+
+    const auto compositor = registry.interface(Registry::Interface::Compositor);
+    m_compositor = registry.createCompositor(compositor.name, compositor.version, this);
+    QVERIFY(m_compositor->isValid());
+    const auto shm = registry.interface(Registry::Interface::Shm);
+    m_shm = registry.createShmPool(shm.name, shm.version, this);
+    QVERIFY(m_shm->isValid());
+    const auto shell = registry.interface(Registry::Interface::Shell);
+    m_shell = registry.createShell(shell.name, shell.version, this);
+    QVERIFY(m_shell->isValid());
+}
+
+void FrameCallbackTest::cleanup()
+{
+    delete m_compositor;
+    m_compositor = nullptr;
+    delete m_shm;
+    m_shm = nullptr;
+    delete m_shell;
+    m_shell = nullptr;
+    delete m_queue;
+    m_queue = nullptr;
+    if (m_thread) {
+        m_connection->deleteLater();
+        m_thread->quit();
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+        m_connection = nullptr;
+    }
+}
+
+void FrameCallbackTest::attachBuffer(KWayland::Client::Surface *surface, const QColor &color)
+{
+    QImage img(QSize(100, 50), QImage::Format_ARGB32);
+    img.fill(color);
+    surface->attachBuffer(m_shm->createBuffer(img));
+    surface->damage(QRect(0, 0, 100, 50));
+}
+
+void FrameCallbackTest::render(KWayland::Client::Surface *surface, const QColor &color)
+{
+    attachBuffer(surface, color);
+    surface->commit(KWayland::Client::Surface::CommitFlag::FrameCallback);
+    m_connection->flush();
+}
+
+void FrameCallbackTest::render(KWayland::Client::Surface *surface, const QColor &color, FrameCallback *frameCallback)
+{
+    attachBuffer(surface, color);
+    wl_callback_add_listener(wl_surface_frame(*surface), &s_frameCallbackListener, frameCallback);
+    surface->commit(KWayland::Client::Surface::CommitFlag::None);
+    m_connection->flush();
+}
+
+ShellClient *FrameCallbackTest::showWindow(KWayland::Client::Surface *surface)
+{
+    QSignalSpy clientAddedSpy(waylandServer(), &WaylandServer::shellClientAdded);
+    if (!clientAddedSpy.isValid()) {
+        return nullptr;
+    }
+    render(surface, Qt::blue);
+    if (!clientAddedSpy.wait()) {
+        return nullptr;
+    }
+    return clientAddedSpy.first().first().value<ShellClient*>();
+}
+
+void FrameCallbackTest::testCallbackAfterPresentation()
+{
+    // the frame callback is only sent once the frame showing the surface got presented
+    using namespace KWayland::Client;
+    QScopedPointer<Surface> surface(m_compositor->createSurface());
+    QScopedPointer<ShellSurface> shellSurface(m_shell->createSurface(surface.data()));
+    QSignalSpy frameRenderedSpy(surface.data(), &Surface::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+    QSignalSpy framePresentedSpy(Compositor::self(), &Compositor::framePresented);
+    QVERIFY(framePresentedSpy.isValid());
+
+    ShellClient *c = showWindow(surface.data());
+    QVERIFY(c);
+    QVERIFY(frameRenderedSpy.wait());
+    QVERIFY(!framePresentedSpy.isEmpty());
+
+    // the callbacks carry the timestamp of the presentation and the timestamps are monotonic
+    quint32 previousTimestamp = 0;
+    for (const QColor &color : {Qt::red, Qt::green}) {
+        framePresentedSpy.clear();
+        FrameCallback frameCallback;
+        render(surface.data(), color, &frameCallback);
+        QTRY_VERIFY(frameCallback.done);
+        QVERIFY(!framePresentedSpy.isEmpty());
+        QCOMPARE(frameCallback.timestamp, quint32(framePresentedSpy.last().first().value<qint64>()));
+        QVERIFY(frameCallback.timestamp >= previousTimestamp);
+        previousTimestamp = frameCallback.timestamp;
+    }
+}
+
+void FrameCallbackTest::testCallbackTiming()
+{
+    // a client rendering as soon as it gets the frame callback is paced by the compositor
+    using namespace KWayland::Client;
+    QScopedPointer<Surface> surface(m_compositor->createSurface());
+    QScopedPointer<ShellSurface> shellSurface(m_shell->createSurface(surface.data()));
+    QSignalSpy frameRenderedSpy(surface.data(), &Surface::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+    QVERIFY(showWindow(surface.data()));
+    QVERIFY(frameRenderedSpy.wait());
+
+    QSignalSpy framePresentedSpy(Compositor::self(), &Compositor::framePresented);
+    QVERIFY(framePresentedSpy.isValid());
+    quint32 previousTimestamp = 0;
+    for (int i = 0; i < s_frameCount; ++i) {
+        const int presentedBeforeCommit = framePresentedSpy.count();
+        FrameCallback frameCallback;
+        render(surface.data(), i % 2 ? Qt::red : Qt::green, &frameCallback);
+        QTRY_VERIFY(frameCallback.done);
+        QVector<quint32> presented;
+        for (int j = presentedBeforeCommit; j < framePresentedSpy.count(); ++j) {
+            presented << quint32(framePresentedSpy.at(j).first().value<qint64>());
+        }
+        // the callback belongs to the first frame painted after the commit, at most the
+        // frame which was already being painted when the commit arrived is presented before
+        const int frame = presented.indexOf(frameCallback.timestamp);
+        QVERIFY2(frame >= 0, qPrintable(QStringLiteral("frame %1 not presented").arg(i)));
+        QVERIFY2(frame <= 1, qPrintable(QStringLiteral("frame %1 held back for %2 frames").arg(i).arg(frame)));
+        // every callback got its own frame
+        QVERIFY(frameCallback.timestamp > previousTimestamp);
+        previousTimestamp = frameCallback.timestamp;
+    }
+    QVERIFY(framePresentedSpy.count() >= s_frameCount);
+}
+
+void FrameCallbackTest::testNoCallbackForMinimized()
+{
+    // a surface which is not presented does not get frame callbacks
+    using namespace KWayland::Client;
+    QScopedPointer<Surface> surface(m_compositor->createSurface());
+    QScopedPointer<ShellSurface> shellSurface(m_shell->createSurface(surface.data()));
+    QSignalSpy frameRenderedSpy(surface.data(), &Surface::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+    ShellClient *c = showWindow(surface.data());
+    QVERIFY(c);
+    QVERIFY(frameRenderedSpy.wait());
+
+    // a second window keeps the compositor presenting frames
+    QScopedPointer<Surface> otherSurface(m_compositor->createSurface());
+    QScopedPointer<ShellSurface> otherShellSurface(m_shell->createSurface(otherSurface.data()));
+    QSignalSpy otherFrameRenderedSpy(otherSurface.data(), &Surface::frameRendered);
+    QVERIFY(otherFrameRenderedSpy.isValid());
+    QVERIFY(showWindow(otherSurface.data()));
+    QVERIFY(otherFrameRenderedSpy.wait());
+
+    c->minimize(true);
+    QVERIFY(c->isMinimized());
+    frameRenderedSpy.clear();
+    render(surface.data(), Qt::red);
+    QSignalSpy framePresentedSpy(Compositor::self(), &Compositor::framePresented);
+    QVERIFY(framePresentedSpy.isValid());
+    for (int i = 0; i < 3; ++i) {
+        render(otherSurface.data(), i % 2 ? Qt::red : Qt::green);
+        QVERIFY(otherFrameRenderedSpy.wait());
+    }
+    QVERIFY(framePresentedSpy.count() >= 3);
+    QVERIFY(frameRenderedSpy.isEmpty());
+
+    // once it is shown again the pending callback is sent
+    c->unminimize(true);
+    QVERIFY(frameRenderedSpy.wait());
+    QCOMPARE(frameRenderedSpy.count(), 1);
+}
+
+void FrameCallbackTest::testNoCallbackWithoutWindow()
+{
+    // a surface without a window is never presented, so it does not get frame callbacks
+    using namespace KWayland::Client;
+    QScopedPointer<Surface> surface(m_compositor->createSurface());
+    QSignalSpy frameRenderedSpy(surface.data(), &Surface::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+    render(surface.data(), Qt::red);
+
+    QScopedPointer<Surface> otherSurface(m_compositor->createSurface());
+    QScopedPointer<ShellSurface> otherShellSurface(m_shell->createSurface(otherSurface.data()));
+    QSignalSpy otherFrameRenderedSpy(otherSurface.data(), &Surface::frameRendered);
+    QVERIFY(otherFrameRenderedSpy.isValid());
+    QVERIFY(showWindow(otherSurface.data()));
+    QVERIFY(otherFrameRenderedSpy.wait());
+    QSignalSpy framePresentedSpy(Compositor::self(), &Compositor::framePresented);
+    QVERIFY(framePresentedSpy.isValid());
+    for (int i = 0; i < 3; ++i) {
+        render(otherSurface.data(), i % 2 ? Qt::red : Qt::green);
+        QVERIFY(otherFrameRenderedSpy.wait());
+    }
+    QVERIFY(framePresentedSpy.count() >= 3);
+    QVERIFY(frameRenderedSpy.isEmpty());
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::FrameCallbackTest)
+#include "frame_callback_test.moc"
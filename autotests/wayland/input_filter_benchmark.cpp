@@ -0,0 +1,226 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "abstract_backend.h"
+#include "input.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <QKeyEvent>
+#include <QMouseEvent>
+
+#include <linux/input.h>
+
+enum class FilterSetup {
+    // the filters KWin installs
+    Default,
+    // ten more filters which are not active
+    InactiveFilters,
+    // ten more filters which are active, the cost each filter had before the chains
+    ActiveFilters,
+    // no filter for the event type is installed, the event does not get created
+    NoActiveFilter
+};
+Q_DECLARE_METATYPE(FilterSetup)
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_input_filter_benchmark-0");
+
+/**
+ * Filter which never filters out an event, used to extend the chains.
+ **/
+class BenchmarkFilter : public InputEventFilter
+{
+public:
+    explicit BenchmarkFilter(bool active)
+        : m_active(active) {
+    }
+    bool isActive() const override {
+        return m_active;
+    }
+    bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
+        Q_UNUSED(event)
+        Q_UNUSED(nativeButton)
+        return false;
+    }
+    bool keyEvent(QKeyEvent *event) override {
+        Q_UNUSED(event)
+        return false;
+    }
+
+private:
+    bool m_active;
+};
+
+
+class InputFilterBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanup();
+    void testFilterChains();
+    void testPointerMotion_data();
+    void testPointerMotion();
+    void testKey_data();
+    void testKey();
+
+private:
+    void addRows();
+    void setupFilters(FilterSetup setup, InputEventFilter::EventType type);
+    QVector<InputEventFilter*> m_installedFilters;
+    QVector<BenchmarkFilter*> m_benchmarkFilters;
+};
+
+void InputFilterBenchmark::initTestCase()
+{
+    waylandServer()->backend()->setInitialWindowSize(QSize(1280, 1024));
+    waylandServer()->init(s_socketName.toLocal8Bit());
+    kwinApp()->start();
+    QVERIFY(workspace());
+    QVERIFY(!input()->filters().isEmpty());
+    m_installedFilters = input()->filters();
+}
+
+void InputFilterBenchmark::cleanup()
+{
+    // restore the filters KWin installed in their order
+    qDeleteAll(m_benchmarkFilters);
+    m_benchmarkFilters.clear();
+    for (InputEventFilter *filter : input()->filters()) {
+        input()->uninstallInputEventFilter(filter);
+    }
+    for (InputEventFilter *filter : m_installedFilters) {
+        input()->installInputEventFilter(filter);
+    }
+    QCOMPARE(input()->filters(), m_installedFilters);
+}
+
+void InputFilterBenchmark::addRows()
+{
+    QTest::addColumn<FilterSetup>("setup");
+
+    QTest::newRow("default filters") << FilterSetup::Default;
+    QTest::newRow("inactive filters") << FilterSetup::InactiveFilters;
+    QTest::newRow("active filters") << FilterSetup::ActiveFilters;
+    QTest::newRow("no active filter") << FilterSetup::NoActiveFilter;
+}
+
+void InputFilterBenchmark::setupFilters(FilterSetup setup, InputEventFilter::EventType type)
+{
+    switch (setup) {
+    case FilterSetup::Default:
+        break;
+    case FilterSetup::InactiveFilters:
+    case FilterSetup::ActiveFilters:
+        // in front of the chain, the forwarding filter at the end filters out all events
+        for (int i = 0; i < 10; ++i) {
+            BenchmarkFilter *filter = new BenchmarkFilter(setup == FilterSetup::ActiveFilters);
+            m_benchmarkFilters << filter;
+            input()->prepandInputEventFilter(filter);
+        }
+        break;
+    case FilterSetup::NoActiveFilter:
+        for (InputEventFilter *filter : input()->filters(type)) {
+            input()->uninstallInputEventFilter(filter);
+        }
+        break;
+    }
+    if (setup == FilterSetup::NoActiveFilter) {
+        QVERIFY(input()->activeFilters(type).isEmpty());
+    } else if (setup == FilterSetup::ActiveFilters) {
+        QVERIFY(input()->activeFilters(type).size() > 10);
+    }
+}
+
+void InputFilterBenchmark::testFilterChains()
+{
+    // every filter ends up in at least one chain and the order is kept
+    const auto filters = input()->filters();
+    QVector<InputEventFilter*> seen;
+    for (auto type : {InputEventFilter::PointerEvents, InputEventFilter::WheelEvents,
+                      InputEventFilter::KeyEvents, InputEventFilter::TouchEvents}) {
+        const auto chain = input()->filters(type);
+        QVERIFY(chain.count() <= filters.count());
+        int lastIndex = -1;
+        for (InputEventFilter *filter : chain) {
+            QVERIFY(filter->eventTypes().testFlag(type));
+            const int index = filters.indexOf(filter);
+            QVERIFY(index > lastIndex);
+            lastIndex = index;
+            if (!seen.contains(filter)) {
+                seen << filter;
+            }
+        }
+        // in the idle state only a part of the chain is active
+        QVERIFY(input()->activeFilters(type).size() <= chain.count());
+    }
+    QCOMPARE(seen.count(), filters.count());
+
+    // inactive filters are not part of the active chain
+    BenchmarkFilter inactive(false);
+    BenchmarkFilter active(true);
+    const int activeCount = input()->activeFilters(InputEventFilter::PointerEvents).size();
+    input()->prepandInputEventFilter(&inactive);
+    input()->prepandInputEventFilter(&active);
+    QCOMPARE(input()->activeFilters(InputEventFilter::PointerEvents).size(), activeCount + 1);
+    QCOMPARE(input()->activeFilters(InputEventFilter::PointerEvents).first(), &active);
+}
+
+void InputFilterBenchmark::testPointerMotion_data()
+{
+    addRows();
+}
+
+void InputFilterBenchmark::testPointerMotion()
+{
+    // dispatch cost of a pointer motion without any window, so the filters are the main cost
+    QFETCH(FilterSetup, setup);
+    setupFilters(setup, InputEventFilter::PointerEvents);
+    quint32 timestamp = 1;
+    int x = 0;
+    QBENCHMARK {
+        waylandServer()->backend()->pointerMotion(QPointF(100 + (x++ % 2), 100), timestamp++);
+    }
+}
+
+void InputFilterBenchmark::testKey_data()
+{
+    addRows();
+}
+
+void InputFilterBenchmark::testKey()
+{
+    // press and release of a key without a focused window
+    QFETCH(FilterSetup, setup);
+    setupFilters(setup, InputEventFilter::KeyEvents);
+    quint32 timestamp = 1;
+    QBENCHMARK {
+        waylandServer()->backend()->keyboardKeyPressed(KEY_Y, timestamp++);
+        waylandServer()->backend()->keyboardKeyReleased(KEY_Y, timestamp++);
+    }
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::InputFilterBenchmark)
+#include "input_filter_benchmark.moc"
@@ -25,6 +25,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "wayland_server.h"
 #include "workspace.h"
 
+#include <KWayland/Server/buffer_interface.h>
+#include <KWayland/Server/surface_interface.h>
+
 #include <QPainter>
 #include <QRasterWindow>
 
@@ -46,6 +49,7 @@ private Q_SLOTS:
     void testPointerAxis();
     void testKeyboard_data();
     void testKeyboard();
+    void testPartialUpdate();
 };
 
 class HelperWindow : public QRasterWindow
@@ -55,6 +59,10 @@ public:
     HelperWindow();
     ~HelperWindow();
 
+    void setColor(const QColor &color) {
+        m_color = color;
+    }
+
 Q_SIGNALS:
     void entered();
     void left();
@@ -74,6 +82,9 @@ protected:
     void wheelEvent(QWheelEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
     void keyReleaseEvent(QKeyEvent *event) override;
+
+private:
+    QColor m_color = Qt::red;
 };
 
 HelperWindow::HelperWindow()
@@ -87,7 +98,7 @@ void HelperWindow::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event)
     QPainter p(this);
-    p.fillRect(0, 0, width(), height(), Qt::red);
+    p.fillRect(0, 0, width(), height(), m_color);
 }
 
 bool HelperWindow::event(QEvent *event)
@@ -272,6 +283,56 @@ void InternalWindowTest::testKeyboard()
     QCOMPARE(pressSpy.count(), 1);
 }
 
+void InternalWindowTest::testPartialUpdate()
+{
+    // an update of a part of the window should only damage and upload that part
+    QSignalSpy clientAddedSpy(waylandServer(), &WaylandServer::shellClientAdded);
+    QVERIFY(clientAddedSpy.isValid());
+    HelperWindow win;
+    win.setGeometry(0, 0, 100, 100);
+    win.show();
+    QVERIFY(clientAddedSpy.wait());
+    ShellClient *c = clientAddedSpy.first().first().value<ShellClient*>();
+    QVERIFY(c);
+    QSignalSpy damagedSpy(c, &Toplevel::damaged);
+    QVERIFY(damagedSpy.isValid());
+
+    // cycle through the colors so that the backing store has to switch buffers
+    const QVector<QColor> colors = {Qt::green, Qt::blue, Qt::yellow, Qt::cyan};
+    const QVector<QRect> updates = {QRect(10, 10, 20, 20), QRect(50, 60, 10, 5), QRect(0, 90, 100, 10), QRect(80, 0, 20, 20)};
+    for (int i = 0; i < updates.count(); ++i) {
+        damagedSpy.clear();
+        win.setColor(colors.at(i));
+        win.update(updates.at(i));
+        QVERIFY(damagedSpy.wait());
+        int bytesUploaded = 0;
+        QRegion damage;
+        for (const auto &args : damagedSpy) {
+            const QRect r = args.last().toRect();
+            bytesUploaded += r.width() * r.height() * 4;
+            damage += r;
+        }
+        QCOMPARE(damage, QRegion(updates.at(i)));
+        QCOMPARE(bytesUploaded, updates.at(i).width() * updates.at(i).height() * 4);
+    }
+
+    // the content of all updates ended up in the latest buffer
+    QVERIFY(c->surface()->buffer());
+    const QImage image = c->surface()->buffer()->data();
+    QCOMPARE(image.size(), QSize(100, 100));
+    for (int i = 0; i < updates.count(); ++i) {
+        const QRect r = updates.at(i);
+        bool overwritten = false;
+        for (int j = i + 1; j < updates.count(); ++j) {
+            overwritten = overwritten || updates.at(j).contains(r.center());
+        }
+        if (!overwritten) {
+            QCOMPARE(QColor(image.pixel(r.center())), colors.at(i));
+        }
+    }
+    QCOMPARE(QColor(image.pixel(5, 5)), QColor(Qt::red));
+}
+
 }
 
 WAYLANDTEST_MAIN(KWin::InternalWindowTest)
@@ -0,0 +1,231 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "abstract_backend.h"
+#include "abstract_client.h"
+#include "globalshortcuts.h"
+#include "input.h"
+#include "shell_client.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <KWayland/Client/connection_thread.h>
+#include <KWayland/Client/compositor.h>
+#include <KWayland/Client/event_queue.h>
+#include <KWayland/Client/keyboard.h>
+#include <KWayland/Client/registry.h>
+#include <KWayland/Client/seat.h>
+#include <KWayland/Client/shell.h>
+#include <KWayland/Client/shm_pool.h>
+#include <KWayland/Client/surface.h>
+
+#include <linux/input.h>
+#include <xkbcommon/xkbcommon-keysyms.h>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_key_shortcut_benchmark-0");
+static const int s_shortcutCount = 1000;
+
+class KeyShortcutBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void testProcessKey_data();
+    void testProcessKey();
+    void testKeyToClient();
+
+private:
+    KWayland::Client::ConnectionThread *m_connection = nullptr;
+    KWayland::Client::Compositor *m_compositor = nullptr;
+    KWayland::Client::Seat *m_seat = nullptr;
+    KWayland::Client::Keyboard *m_keyboard = nullptr;
+    KWayland::Client::ShmPool *m_shm = nullptr;
+    KWayland::Client::Shell *m_shell = nullptr;
+    KWayland::Client::EventQueue *m_queue = nullptr;
+    QThread *m_thread = nullptr;
+    QList<QAction*> m_actions;
+};
+
+void KeyShortcutBenchmark::initTestCase()
+{
+    qRegisterMetaType<KWin::ShellClient*>();
+    qRegisterMetaType<KWin::AbstractClient*>();
+    QSignalSpy workspaceCreatedSpy(kwinApp(), &Application::workspaceCreated);
+    QVERIFY(workspaceCreatedSpy.isValid());
+    waylandServer()->backend()->setInitialWindowSize(QSize(1280, 1024));
+    waylandServer()->init(s_socketName.toLocal8Bit());
+    kwinApp()->start();
+    QVERIFY(workspaceCreatedSpy.wait());
+    waylandServer()->initWorkspace();
+
+    // register a large number of shortcuts, none of them without modifiers
+    const QVector<int> modifiers = {Qt::META, Qt::CTRL, Qt::ALT, Qt::META | Qt::CTRL, Qt::META | Qt::ALT,
+                                    Qt::CTRL | Qt::ALT, Qt::META | Qt::CTRL | Qt::ALT};
+    QVector<int> keys;
+    for (int key = Qt::Key_A; key <= Qt::Key_Z; ++key) {
+        keys << key;
+    }
+    for (int key = Qt::Key_F1; key <= Qt::Key_F35; ++key) {
+        keys << key;
+    }
+    for (int i = 0; m_actions.count() < s_shortcutCount; ++i) {
+        const int modifier = modifiers.at(i % modifiers.count()) | ((i / (modifiers.count() * keys.count())) % 2 ? int(Qt::SHIFT) : 0);
+        const int key = keys.at((i / modifiers.count()) % keys.count());
+        QAction *action = new QAction(this);
+        action->setObjectName(QStringLiteral("Benchmark Shortcut %1").arg(i));
+        input()->registerShortcut(QKeySequence(modifier | key), action);
+        m_actions << action;
+    }
+
+    using namespace KWayland::Client;
+    m_connection = new ConnectionThread;
+    QSignalSpy connectedSpy(m_connection, &ConnectionThread::connected);
+    QVERIFY(connectedSpy.isValid());
+    m_connection->setSocketName(s_socketName);
+
+    m_thread = new QThread(this);
+    m_connection->moveToThread(m_thread);
+    m_thread->start();
+
+    m_connection->initConnection();
+    QVERIFY(connectedSpy.wait());
+
+    m_queue = new EventQueue(this);
+    m_queue->setup(m_connection);
+    QVERIFY(m_queue->isValid());
+
+    Registry registry;
+    registry.setEventQueue(m_queue);
+    QSignalSpy allAnnounced(&registry, &Registry::interfacesAnnounced);
+    QVERIFY(allAnnounced.isValid());
+    registry.create(m_connection->display());
+    QVERIFY(registry.isValid());
+    registry.setup();
+    QVERIFY(allAnnounced.wait());
+
+    const auto compositor = registry.interface(Registry::Interface::Compositor);
+    m_compositor = registry.createCompositor(compositor.name, compositor.version, this);
+    QVERIFY(m_compositor->isValid());
+    const auto shm = registry.interface(Registry::Interface::Shm);
+    m_shm = registry.createShmPool(shm.name, shm.version, this);
+    QVERIFY(m_shm->isValid());
+    const auto shell = registry.interface(Registry::Interface::Shell);
+    m_shell = registry.createShell(shell.name, shell.version, this);
+    QVERIFY(m_shell->isValid());
+    const auto seat = registry.interface(Registry::Interface::Seat);
+    m_seat = registry.createSeat(seat.name, seat.version, this);
+    QVERIFY(m_seat->isValid());
+    QSignalSpy hasKeyboardSpy(m_seat, &Seat::hasKeyboardChanged);
+    QVERIFY(hasKeyboardSpy.isValid());
+    QVERIFY(hasKeyboardSpy.wait());
+    m_keyboard = m_seat->createKeyboard(this);
+    QVERIFY(m_keyboard->isValid());
+    QSignalSpy enteredSpy(m_keyboard, &Keyboard::entered);
+    QVERIFY(enteredSpy.isValid());
+
+    // show a window which gets the keyboard focus
+    QSignalSpy clientAddedSpy(waylandServer(), &WaylandServer::shellClientAdded);
+    QVERIFY(clientAddedSpy.isValid());
+    Surface *surface = m_compositor->createSurface(m_compositor);
+    QVERIFY(surface);
+    ShellSurface *shellSurface = m_shell->createSurface(surface, surface);
+    QVERIFY(shellSurface);
+    QImage img(QSize(100, 50), QImage::Format_ARGB32);
+    img.fill(Qt::blue);
+    surface->attachBuffer(m_shm->createBuffer(img));
+    surface->damage(QRect(0, 0, 100, 50));
+    surface->commit(Surface::CommitFlag::None);
+    m_connection->flush();
+    QVERIFY(clientAddedSpy.wait());
+    QVERIFY(workspace()->activeClient());
+    QVERIFY(enteredSpy.wait());
+}
+
+void KeyShortcutBenchmark::cleanupTestCase()
+{
+    qDeleteAll(m_actions);
+    m_actions.clear();
+    delete m_keyboard;
+    m_keyboard = nullptr;
+    delete m_compositor;
+    m_compositor = nullptr;
+    delete m_seat;
+    m_seat = nullptr;
+    delete m_shm;
+    m_shm = nullptr;
+    delete m_shell;
+    m_shell = nullptr;
+    delete m_queue;
+    m_queue = nullptr;
+    if (m_thread) {
+        m_connection->deleteLater();
+        m_thread->quit();
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+        m_connection = nullptr;
+    }
+}
+
+void KeyShortcutBenchmark::testProcessKey_data()
+{
+    QTest::addColumn<int>("modifiers");
+    QTest::addColumn<quint32>("keysym");
+
+    QTest::newRow("typing") << int(Qt::NoModifier) << quint32(XKB_KEY_y);
+    QTest::newRow("modifier held") << int(Qt::ControlModifier) << quint32(XKB_KEY_odiaeresis);
+}
+
+void KeyShortcutBenchmark::testProcessKey()
+{
+    // the shortcut lookup done for each key press which does not trigger a shortcut
+    QFETCH(int, modifiers);
+    QFETCH(quint32, keysym);
+    GlobalShortcutsManager *shortcuts = input()->shortcuts();
+
+    QBENCHMARK {
+        QVERIFY(!shortcuts->processKey(Qt::KeyboardModifiers(modifiers), keysym));
+    }
+}
+
+void KeyShortcutBenchmark::testKeyToClient()
+{
+    // time from injecting the key till the focused client received it
+    using namespace KWayland::Client;
+    QSignalSpy keyChangedSpy(m_keyboard, &Keyboard::keyChanged);
+    QVERIFY(keyChangedSpy.isValid());
+    quint32 timestamp = 1;
+
+    QBENCHMARK {
+        waylandServer()->backend()->keyboardKeyPressed(KEY_Y, timestamp++);
+        QVERIFY(keyChangedSpy.wait());
+        waylandServer()->backend()->keyboardKeyReleased(KEY_Y, timestamp++);
+        QVERIFY(keyChangedSpy.wait());
+    }
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::KeyShortcutBenchmark)
+#include "key_shortcut_benchmark.moc"
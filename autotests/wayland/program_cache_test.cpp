@@ -0,0 +1,414 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "abstract_backend.h"
+#include "composite.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <kwineffects.h>
+#include <kwinglplatform.h>
+#include <kwinglutils.h>
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <utime.h>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_program_cache-0");
+
+class ProgramCacheTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void testStoreAndLoad();
+    void testCorruptProgram_data();
+    void testCorruptProgram();
+    void testDriverChange_data();
+    void testDriverChange();
+    void testPruneUnused_data();
+    void testPruneUnused();
+    void testLoadMarksUsed();
+
+private:
+    void restartShaderManager();
+    GLShader *createShader(const QColor &color);
+    QString createCachedProgram(const QColor &color);
+    QStringList cachedPrograms() const;
+    QString cacheDir() const;
+    QTemporaryDir m_cacheDir;
+};
+
+// the layout of the cache files written by ShaderManager
+struct CachedProgram
+{
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray driverIdentity;
+    quint32 format = 0;
+    qint64 compileTime = 0;
+    QByteArray binary;
+
+    bool read(const QString &fileName) {
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        QDataStream stream(&file);
+        stream >> magic >> version >> driverIdentity >> format >> compileTime >> binary;
+        return stream.status() == QDataStream::Ok;
+    }
+    bool write(const QString &fileName) const {
+        QFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return false;
+        }
+        QDataStream stream(&file);
+        stream << magic << version << driverIdentity << format << compileTime << binary;
+        return stream.status() == QDataStream::Ok;
+    }
+};
+
+void ProgramCacheTest::initTestCase()
+{
+    QVERIFY(m_cacheDir.isValid());
+    QSignalSpy workspaceCreatedSpy(kwinApp(), &Application::workspaceCreated);
+    QVERIFY(workspaceCreatedSpy.isValid());
+    waylandServer()->backend()->setInitialWindowSize(QSize(1280, 1024));
+    waylandServer()->init(s_socketName.toLocal8Bit());
+
+    // the programs get cached in a fresh directory, for the OpenGL scene
+    qputenv("XDG_CACHE_HOME", QFile::encodeName(m_cacheDir.path()));
+    qunsetenv("KWIN_GL_PROGRAM_CACHE");
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+    kwinApp()->start();
+    QVERIFY(workspaceCreatedSpy.wait());
+    waylandServer()->initWorkspace();
+    if (!effects) {
+        QSignalSpy compositorToggledSpy(Compositor::self(), &Compositor::compositingToggled);
+        QVERIFY(compositorToggledSpy.isValid());
+        QVERIFY(compositorToggledSpy.wait());
+    }
+    QVERIFY(effects);
+    QCOMPARE(effects->compositingType(), OpenGL2Compositing);
+}
+
+void ProgramCacheTest::init()
+{
+    QVERIFY(effects->makeOpenGLContextCurrent());
+    // errors of previous frames are not the concern of this test
+    while (glGetError() != GL_NO_ERROR) {
+    }
+    if (!ShaderManager::instance()->programCacheStatistics().enabled) {
+        effects->doneOpenGLContextCurrent();
+        QSKIP("The driver does not support program binaries");
+    }
+}
+
+void ProgramCacheTest::cleanup()
+{
+    effects->doneOpenGLContextCurrent();
+}
+
+void ProgramCacheTest::restartShaderManager()
+{
+    // like a compositor restart, the new ShaderManager starts without any compiled shader
+    ShaderManager::cleanup();
+    ShaderManager::instance();
+}
+
+GLShader *ProgramCacheTest::createShader(const QColor &color)
+{
+    // every color results in a different source and thus in a different cached program
+    const qint64 coreVersionNumber = GLPlatform::instance()->isGLES() ? kVersionNumber(3, 0) : kVersionNumber(1, 40);
+    const bool core = GLPlatform::instance()->glslVersion() >= coreVersionNumber;
+    QByteArray source;
+    QTextStream stream(&source);
+    if (core) {
+        stream << "#version 140\n\n";
+    }
+    stream << "uniform sampler2D sampler;\n";
+    stream << (core ? "in" : "varying") << " vec2 texcoord0;\n";
+    if (core) {
+        stream << "out vec4 fragColor;\n";
+    }
+    stream << "void main()\n{\n";
+    stream << "    " << (core ? "fragColor = texture" : "gl_FragColor = texture2D") << "(sampler, texcoord0) * vec4("
+           << color.redF() << ", " << color.greenF() << ", " << color.blueF() << ", 1.0);\n";
+    stream << "}\n";
+    stream.flush();
+    return ShaderManager::instance()->generateCustomShader(ShaderTrait::MapTexture, QByteArray(), source);
+}
+
+QString ProgramCacheTest::cacheDir() const
+{
+    return m_cacheDir.path() + QStringLiteral("/kwin/glprograms");
+}
+
+QStringList ProgramCacheTest::cachedPrograms() const
+{
+    // the programs are stored in a directory per driver
+    QStringList programs;
+    QDirIterator it(cacheDir(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        programs << it.next();
+    }
+    return programs;
+}
+
+static bool setLastUsed(const QString &fileName, int daysAgo)
+{
+    const time_t time = QDateTime::currentDateTime().addDays(-daysAgo).toTime_t();
+    struct utimbuf times;
+    times.actime = time;
+    times.modtime = time;
+    return utime(QFile::encodeName(fileName).constData(), &times) == 0;
+}
+
+QString ProgramCacheTest::createCachedProgram(const QColor &color)
+{
+    const QStringList before = cachedPrograms();
+    QScopedPointer<GLShader> shader(createShader(color));
+    if (!shader->isValid()) {
+        return QString();
+    }
+    QStringList added = cachedPrograms();
+    for (const QString &program : before) {
+        added.removeOne(program);
+    }
+    return added.count() == 1 ? added.first() : QString();
+}
+
+void ProgramCacheTest::testStoreAndLoad()
+{
+    // a compiled program gets stored and a restarted ShaderManager loads it instead of compiling
+    restartShaderManager();
+    const QString program = createCachedProgram(Qt::red);
+    QVERIFY(!program.isEmpty());
+    const ShaderManager::ProgramCacheStatistics &compiled = ShaderManager::instance()->programCacheStatistics();
+    QCOMPARE(compiled.hits, 0);
+    QCOMPARE(compiled.misses, 1);
+    QCOMPARE(compiled.discarded, 0);
+    QVERIFY(compiled.compileTime > 0);
+    CachedProgram cached;
+    QVERIFY(cached.read(program));
+    QVERIFY(!cached.binary.isEmpty());
+    QVERIFY(cached.compileTime > 0);
+
+    restartShaderManager();
+    QScopedPointer<GLShader> shader(createShader(Qt::red));
+    QVERIFY(shader->isValid());
+    const ShaderManager::ProgramCacheStatistics &loaded = ShaderManager::instance()->programCacheStatistics();
+    QCOMPARE(loaded.hits, 1);
+    QCOMPARE(loaded.misses, 0);
+    QCOMPARE(loaded.compileTime, qint64(0));
+    QVERIFY(loaded.binaryLoadTime > 0);
+    // the loaded program can be used like a compiled one
+    ShaderManager::instance()->pushShader(shader.data());
+    QVERIFY(shader->setUniform(GLShader::ModelViewProjectionMatrix, QMatrix4x4()));
+    ShaderManager::instance()->popShader();
+    QCOMPARE(glGetError(), GLenum(GL_NO_ERROR));
+    QCOMPARE(cachedPrograms().count(program), 1);
+}
+
+void ProgramCacheTest::testCorruptProgram_data()
+{
+    QTest::addColumn<QColor>("color");
+    QTest::addColumn<QString>("corruption");
+
+    QTest::newRow("empty") << QColor(Qt::green) << QStringLiteral("empty");
+    QTest::newRow("garbage") << QColor(Qt::blue) << QStringLiteral("garbage");
+    QTest::newRow("truncated") << QColor(Qt::cyan) << QStringLiteral("truncated");
+    QTest::newRow("invalid binary") << QColor(Qt::magenta) << QStringLiteral("binary");
+    QTest::newRow("other cache version") << QColor(Qt::yellow) << QStringLiteral("version");
+}
+
+void ProgramCacheTest::testCorruptProgram()
+{
+    // a corrupt cached program is discarded, compiled from source and stored again
+    QFETCH(QColor, color);
+    QFETCH(QString, corruption);
+    const QString program = createCachedProgram(color);
+    QVERIFY(!program.isEmpty());
+
+    QFile file(program);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray content = file.readAll();
+    file.close();
+    CachedProgram cached;
+    QVERIFY(cached.read(program));
+    if (corruption == QLatin1String("empty")) {
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.close();
+    } else if (corruption == QLatin1String("garbage")) {
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QCOMPARE(file.write(QByteArray(content.size(), 'x')), qint64(content.size()));
+        file.close();
+    } else if (corruption == QLatin1String("truncated")) {
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QCOMPARE(file.write(content.left(content.size() / 2)), qint64(content.size() / 2));
+        file.close();
+    } else if (corruption == QLatin1String("binary")) {
+        // a valid file, but the driver cannot load the binary
+        for (int i = 0; i < cached.binary.size(); ++i) {
+            cached.binary[i] = ~cached.binary.at(i);
+        }
+        QVERIFY(cached.write(program));
+    } else {
+        cached.version++;
+        QVERIFY(cached.write(program));
+    }
+
+    restartShaderManager();
+    QScopedPointer<GLShader> shader(createShader(color));
+    QVERIFY(shader->isValid());
+    const ShaderManager::ProgramCacheStatistics &statistics = ShaderManager::instance()->programCacheStatistics();
+    QCOMPARE(statistics.hits, 0);
+    QCOMPARE(statistics.misses, 1);
+    QCOMPARE(statistics.discarded, 1);
+    QCOMPARE(glGetError(), GLenum(GL_NO_ERROR));
+
+    // the compiled program replaced the corrupt one
+    CachedProgram stored;
+    QVERIFY(stored.read(program));
+    QVERIFY(!stored.binary.isEmpty());
+    restartShaderManager();
+    shader.reset(createShader(color));
+    QVERIFY(shader->isValid());
+    QCOMPARE(ShaderManager::instance()->programCacheStatistics().hits, 1);
+}
+
+void ProgramCacheTest::testDriverChange_data()
+{
+    QTest::addColumn<QColor>("color");
+    // line of the driver identity which changes
+    QTest::addColumn<int>("line");
+
+    QTest::newRow("vendor") << QColor(Qt::darkRed) << 0;
+    QTest::newRow("renderer") << QColor(Qt::darkGreen) << 1;
+    QTest::newRow("GL version") << QColor(Qt::darkBlue) << 2;
+    QTest::newRow("GLSL version") << QColor(Qt::darkCyan) << 3;
+}
+
+void ProgramCacheTest::testDriverChange()
+{
+    // a program cached by a different driver or GL version is not loaded but replaced
+    QFETCH(QColor, color);
+    QFETCH(int, line);
+    const QString program = createCachedProgram(color);
+    QVERIFY(!program.isEmpty());
+
+    CachedProgram cached;
+    QVERIFY(cached.read(program));
+    const QByteArray driverIdentity = cached.driverIdentity;
+    QList<QByteArray> lines = driverIdentity.split('\n');
+    QCOMPARE(lines.count(), 4);
+    lines[line].append(QByteArrayLiteral(" (updated)"));
+    cached.driverIdentity = lines.join('\n');
+    QVERIFY(cached.write(program));
+
+    restartShaderManager();
+    QScopedPointer<GLShader> shader(createShader(color));
+    QVERIFY(shader->isValid());
+    const ShaderManager::ProgramCacheStatistics &statistics = ShaderManager::instance()->programCacheStatistics();
+    QCOMPARE(statistics.hits, 0);
+    QCOMPARE(statistics.misses, 1);
+    QCOMPARE(statistics.discarded, 1);
+
+    CachedProgram stored;
+    QVERIFY(stored.read(program));
+    QCOMPARE(stored.driverIdentity, driverIdentity);
+}
+
+void ProgramCacheTest::testPruneUnused_data()
+{
+    QTest::addColumn<QColor>("color");
+    QTest::addColumn<bool>("otherDriver");
+    QTest::addColumn<int>("lastUsed");
+    QTest::addColumn<bool>("pruned");
+
+    QTest::newRow("recently used") << QColor(Qt::darkMagenta) << false << 10 << false;
+    QTest::newRow("unused") << QColor(Qt::darkYellow) << false << 31 << true;
+    QTest::newRow("other driver, recently used") << QColor(Qt::darkGray) << true << 10 << false;
+    QTest::newRow("other driver, unused") << QColor(Qt::lightGray) << true << 31 << true;
+}
+
+void ProgramCacheTest::testPruneUnused()
+{
+    // programs which have not been used for a month get removed when the cache is set up,
+    // including those of drivers no longer in use together with their directory
+    QFETCH(QColor, color);
+    QFETCH(bool, otherDriver);
+    QFETCH(int, lastUsed);
+    QFETCH(bool, pruned);
+    QString program = createCachedProgram(color);
+    QVERIFY(!program.isEmpty());
+    const QString driverDir = QFileInfo(program).absolutePath();
+    QCOMPARE(QFileInfo(driverDir).absolutePath(), QFileInfo(cacheDir()).absoluteFilePath());
+    if (otherDriver) {
+        const QString otherDriverDir = cacheDir() + QStringLiteral("/other-driver");
+        QVERIFY(QDir().mkpath(otherDriverDir));
+        const QString otherProgram = otherDriverDir + QLatin1Char('/') + QFileInfo(program).fileName();
+        QVERIFY(QFile::rename(program, otherProgram));
+        program = otherProgram;
+    }
+    QVERIFY(setLastUsed(program, lastUsed));
+
+    restartShaderManager();
+    QCOMPARE(QFile::exists(program), !pruned);
+    if (otherDriver) {
+        QCOMPARE(QFileInfo::exists(QFileInfo(program).absolutePath()), !pruned);
+        QDir(QFileInfo(program).absolutePath()).removeRecursively();
+    }
+    // the directory of the driver in use is kept
+    QVERIFY(QFileInfo(driverDir).isDir());
+    QScopedPointer<GLShader> shader(createShader(color));
+    QVERIFY(shader->isValid());
+    QCOMPARE(ShaderManager::instance()->programCacheStatistics().hits, (pruned || otherDriver) ? 0 : 1);
+}
+
+void ProgramCacheTest::testLoadMarksUsed()
+{
+    // loading a program renews its modification time, so that programs in use never get pruned
+    const QString program = createCachedProgram(Qt::white);
+    QVERIFY(!program.isEmpty());
+    QVERIFY(setLastUsed(program, 20));
+
+    restartShaderManager();
+    QScopedPointer<GLShader> shader(createShader(Qt::white));
+    QVERIFY(shader->isValid());
+    QCOMPARE(ShaderManager::instance()->programCacheStatistics().hits, 1);
+    QCOMPARE(QFileInfo(program).lastModified().daysTo(QDateTime::currentDateTime()), qint64(0));
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::ProgramCacheTest)
+#include "program_cache_test.moc"
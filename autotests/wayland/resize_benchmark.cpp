@@ -0,0 +1,162 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "abstract_backend.h"
+#include "client.h"
+#include "composite.h"
+#include "cursor.h"
+#include "scene.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <QElapsedTimer>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_resize_benchmark-0");
+// number of keyboard resize steps, half growing and half shrinking the window
+static const int s_steps = 200;
+// interval between two steps, like a pointer reporting at 200 Hz
+static const int s_stepInterval = 5;
+
+class ResizeBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void benchmarkInteractiveResize_data();
+    void benchmarkInteractiveResize();
+};
+
+void ResizeBenchmark::initTestCase()
+{
+    qRegisterMetaType<KWin::AbstractClient*>();
+    QSignalSpy workspaceCreatedSpy(kwinApp(), &Application::workspaceCreated);
+    QVERIFY(workspaceCreatedSpy.isValid());
+    waylandServer()->backend()->setInitialWindowSize(QSize(1280, 1024));
+    waylandServer()->init(s_socketName.toLocal8Bit());
+
+    // texture allocations are only tracked by the OpenGL scene
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+    kwinApp()->start();
+    QVERIFY(workspaceCreatedSpy.wait());
+    waylandServer()->initWorkspace();
+}
+
+void ResizeBenchmark::benchmarkInteractiveResize_data()
+{
+    QTest::addColumn<QString>("metric");
+
+    QTest::newRow("frames per second") << QStringLiteral("fps");
+    QTest::newRow("configures per second") << QStringLiteral("configures");
+    QTest::newRow("texture allocations") << QStringLiteral("textures");
+    QTest::newRow("scaled previous pixmaps") << QStringLiteral("scaled");
+}
+
+void ResizeBenchmark::benchmarkInteractiveResize()
+{
+    // every row resizes a new window, so that the metrics do not depend on the order of the rows
+    QFETCH(QString, metric);
+    QVERIFY(Compositor::self()->scene());
+
+    // create an X11 window in the nested X server, it gets a ConfigureNotify for every configure
+    xcb_connection_t *c = xcb_connect(nullptr, nullptr);
+    QVERIFY(!xcb_connection_has_error(c));
+    const uint32_t values[] = { 0xff0000ffu, XCB_EVENT_MASK_STRUCTURE_NOTIFY };
+    xcb_window_t w = xcb_generate_id(c);
+    xcb_create_window(c, XCB_COPY_FROM_PARENT, w, rootWindow(), 0, 0, 400, 300, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                      XCB_COPY_FROM_PARENT, XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK, values);
+    xcb_map_window(c, w);
+    xcb_flush(c);
+
+    QSignalSpy windowCreatedSpy(workspace(), &Workspace::clientAdded);
+    QVERIFY(windowCreatedSpy.isValid());
+    QVERIFY(windowCreatedSpy.wait());
+    Client *client = windowCreatedSpy.first().first().value<Client*>();
+    QVERIFY(client);
+    if (!client->readyForPainting()) {
+        QSignalSpy windowShownSpy(client, &Toplevel::windowShown);
+        QVERIFY(windowShownSpy.isValid());
+        QVERIFY(windowShownSpy.wait());
+    }
+    workspace()->activateClient(client, true);
+    QCOMPARE(workspace()->activeClient(), client);
+
+    // the configures caused by mapping and activating the window are not part of the resize
+    const auto countConfigures = [c] {
+        // the round trip ensures all events sent so far got received
+        free(xcb_get_input_focus_reply(c, xcb_get_input_focus_unchecked(c), nullptr));
+        int configures = 0;
+        while (xcb_generic_event_t *event = xcb_poll_for_event(c)) {
+            if ((event->response_type & ~0x80) == XCB_CONFIGURE_NOTIFY) {
+                configures++;
+            }
+            free(event);
+        }
+        return configures;
+    };
+    countConfigures();
+    QSignalSpy frameSpy(Compositor::self(), &Compositor::aboutToPaintFrame);
+    QVERIFY(frameSpy.isValid());
+    const Scene::WindowPixmapStatistics before = Compositor::self()->scene()->windowPixmapStatistics();
+
+    workspace()->slotWindowResize();
+    QCOMPARE(workspace()->getMovingClient(), client);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < s_steps; ++i) {
+        client->keyPressEvent(i < s_steps / 2 ? Qt::Key_Right : Qt::Key_Left);
+        client->updateMoveResize(Cursor::pos());
+        QTest::qWait(s_stepInterval);
+    }
+    // let the last resize step finish
+    QTest::qWait(100);
+    const qreal seconds = qreal(timer.elapsed()) / 1000.0;
+    client->keyPressEvent(Qt::Key_Enter);
+    QVERIFY(workspace()->getMovingClient() == nullptr);
+    const int configures = countConfigures();
+    QVERIFY(configures > 0);
+
+    const Scene::WindowPixmapStatistics &after = Compositor::self()->scene()->windowPixmapStatistics();
+    if (metric == QLatin1String("fps")) {
+        QTest::setBenchmarkResult(qreal(frameSpy.count()) / seconds, QTest::FramesPerSecond);
+    } else if (metric == QLatin1String("configures")) {
+        QTest::setBenchmarkResult(qreal(configures) / seconds, QTest::Events);
+    } else if (metric == QLatin1String("textures")) {
+        QTest::setBenchmarkResult(after.textureAllocations - before.textureAllocations, QTest::Events);
+    } else {
+        QTest::setBenchmarkResult(after.scaledPreviousPixmaps - before.scaledPreviousPixmaps, QTest::Events);
+    }
+
+    // and destroy the window again
+    QSignalSpy windowClosedSpy(client, &Client::windowClosed);
+    QVERIFY(windowClosedSpy.isValid());
+    xcb_unmap_window(c, w);
+    xcb_destroy_window(c, w);
+    xcb_flush(c);
+    xcb_disconnect(c);
+    QVERIFY(windowClosedSpy.wait());
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::ResizeBenchmark)
+#include "resize_benchmark.moc"
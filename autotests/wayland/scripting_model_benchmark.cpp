@@ -0,0 +1,262 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "abstract_backend.h"
+#include "screens.h"
+#include "shell_client.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <KWayland/Client/registry.h>
+#include <KWayland/Client/connection_thread.h>
+#include <KWayland/Client/compositor.h>
+#include <KWayland/Client/shm_pool.h>
+#include <KWayland/Client/shell.h>
+#include <KWayland/Client/surface.h>
+#include <KWayland/Client/event_queue.h>
+
+#include <KConfigGroup>
+
+#include <QAbstractItemModel>
+#include <QQmlComponent>
+#include <QQmlEngine>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_scripting_model_benchmark-0");
+static const int s_desktops = 10;
+static const int s_windowCount = 300;
+// ClientModel::OtherDesktopsExclusion
+static const int s_otherDesktopsExclusion = 1 << 7;
+
+class ScriptingModelBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkModel_data();
+    void benchmarkModel();
+
+private:
+    QAbstractItemModel *createModel();
+    KWayland::Client::ConnectionThread *m_connection = nullptr;
+    KWayland::Client::Compositor *m_compositor = nullptr;
+    KWayland::Client::ShmPool *m_shm = nullptr;
+    KWayland::Client::Shell *m_shell = nullptr;
+    KWayland::Client::EventQueue *m_queue = nullptr;
+    QThread *m_thread = nullptr;
+    QList<ShellClient*> m_clients;
+    QQmlEngine *m_engine = nullptr;
+};
+
+void ScriptingModelBenchmark::initTestCase()
+{
+    qRegisterMetaType<KWin::ShellClient*>();
+    qRegisterMetaType<KWin::AbstractClient*>();
+    QSignalSpy workspaceCreatedSpy(kwinApp(), &Application::workspaceCreated);
+    QVERIFY(workspaceCreatedSpy.isValid());
+    waylandServer()->backend()->setInitialWindowSize(QSize(1280, 1024));
+    QMetaObject::invokeMethod(waylandServer()->backend(), "setOutputCount", Qt::DirectConnection, Q_ARG(int, 2));
+    waylandServer()->init(s_socketName.toLocal8Bit());
+
+    KSharedConfig::Ptr config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    config->group("Desktops").writeEntry("Number", s_desktops);
+    config->sync();
+    kwinApp()->setConfig(config);
+
+    kwinApp()->start();
+    QVERIFY(workspaceCreatedSpy.wait());
+    QCOMPARE(screens()->count(), 2);
+
+    using namespace KWayland::Client;
+    // setup connection
+    m_connection = new ConnectionThread;
+    QSignalSpy connectedSpy(m_connection, &ConnectionThread::connected);
+    QVERIFY(connectedSpy.isValid());
+    m_connection->setSocketName(s_socketName);
+
+    m_thread = new QThread(this);
+    m_connection->moveToThread(m_thread);
+    m_thread->start();
+
+    m_connection->initConnection();
+    QVERIFY(connectedSpy.wait());
+
+    m_queue = new EventQueue(this);
+    m_queue->setup(m_connection);
+    QVERIFY(m_queue->isValid());
+
+    Registry registry;
+    registry.setEventQueue(m_queue);
+    QSignalSpy allAnnounced(&registry, &Registry::interfacesAnnounced);
+    QVERIFY(allAnnounced.isValid());
+    registry.create(m_connection->display());
+    QVERIFY(registry.isValid());
+    registry.setup();
+    QVERIFY(allAnnounced.wait());
+
+    const auto compositor = registry.interface(Registry::Interface::Compositor);
+    m_compositor = registry.createCompositor(compositor.name, compositor.version, this);
+    QVERIFY(m_compositor->isValid());
+    const auto shm = registry.interface(Registry::Interface::Shm);
+    m_shm = registry.createShmPool(shm.name, shm.version, this);
+    QVERIFY(m_shm->isValid());
+    const auto shell = registry.interface(Registry::Interface::Shell);
+    m_shell = registry.createShell(shell.name, shell.version, this);
+    QVERIFY(m_shell->isValid());
+
+    // spread the windows over all desktops and both screens
+    QSignalSpy clientAddedSpy(waylandServer(), &WaylandServer::shellClientAdded);
+    QVERIFY(clientAddedSpy.isValid());
+    QImage img(QSize(100, 50), QImage::Format_ARGB32);
+    img.fill(Qt::blue);
+    for (int i = 0; i < s_windowCount; ++i) {
+        Surface *surface = m_compositor->createSurface(m_compositor);
+        QVERIFY(surface);
+        ShellSurface *shellSurface = m_shell->createSurface(surface, surface);
+        QVERIFY(shellSurface);
+        surface->attachBuffer(m_shm->createBuffer(img));
+        surface->damage(QRect(0, 0, 100, 50));
+        surface->commit(Surface::CommitFlag::None);
+        m_connection->flush();
+        QVERIFY(clientAddedSpy.wait());
+        ShellClient *c = clientAddedSpy.last().first().value<ShellClient*>();
+        QVERIFY(c);
+        c->setDesktop(i % s_desktops + 1);
+        c->move(QPoint((i % 2) * 1280 + 100, 100));
+        QCOMPARE(c->screen(), i % 2);
+        m_clients << c;
+    }
+
+    // the model types are registered by the scripting on workspace creation
+    m_engine = new QQmlEngine(this);
+}
+
+void ScriptingModelBenchmark::cleanupTestCase()
+{
+    delete m_engine;
+    m_engine = nullptr;
+    m_clients.clear();
+    delete m_compositor;
+    m_compositor = nullptr;
+    delete m_shm;
+    m_shm = nullptr;
+    delete m_shell;
+    m_shell = nullptr;
+    delete m_queue;
+    m_queue = nullptr;
+    if (m_thread) {
+        m_connection->deleteLater();
+        m_thread->quit();
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+        m_connection = nullptr;
+    }
+}
+
+QAbstractItemModel *ScriptingModelBenchmark::createModel()
+{
+    QQmlComponent component(m_engine);
+    component.setData(QByteArrayLiteral("import org.kde.kwin 2.0\nClientModelByScreenAndDesktop {}"), QUrl());
+    return qobject_cast<QAbstractItemModel*>(component.create());
+}
+
+/**
+ * Walks the whole tree like the delegates of a QML view do.
+ **/
+static int traverse(const QAbstractItemModel *model, const QModelIndex &parent = QModelIndex())
+{
+    int clients = 0;
+    const int rows = model->rowCount(parent);
+    for (int row = 0; row < rows; ++row) {
+        const QModelIndex index = model->index(row, 0, parent);
+        if (model->parent(index) != parent) {
+            return -1;
+        }
+        if (model->hasChildren(index)) {
+            const int children = traverse(model, index);
+            if (children == -1) {
+                return -1;
+            }
+            clients += children;
+        } else if (index.data().value<KWin::AbstractClient*>()) {
+            clients++;
+        }
+    }
+    return clients;
+}
+
+void ScriptingModelBenchmark::benchmarkModel_data()
+{
+    QTest::addColumn<QString>("operation");
+
+    QTest::newRow("create") << QStringLiteral("create");
+    QTest::newRow("traverse") << QStringLiteral("traverse");
+    QTest::newRow("exclusions changed") << QStringLiteral("exclusions");
+    QTest::newRow("clients changed desktop") << QStringLiteral("desktop");
+}
+
+void ScriptingModelBenchmark::benchmarkModel()
+{
+    // screen x desktop tree with the windows as leafs, activities are not available in the test
+    QFETCH(QString, operation);
+
+    if (operation == QLatin1String("create")) {
+        QBENCHMARK {
+            delete createModel();
+        }
+        return;
+    }
+
+    QScopedPointer<QAbstractItemModel> model(createModel());
+    QVERIFY(!model.isNull());
+    QCOMPARE(model->rowCount(), screens()->count());
+    QCOMPARE(model->rowCount(model->index(0, 0)), s_desktops);
+    QCOMPARE(traverse(model.data()), s_windowCount);
+
+    if (operation == QLatin1String("traverse")) {
+        QBENCHMARK {
+            traverse(model.data());
+        }
+    } else if (operation == QLatin1String("exclusions")) {
+        QBENCHMARK {
+            QVERIFY(model->setProperty("exclusions", s_otherDesktopsExclusion));
+            QVERIFY(model->setProperty("exclusions", 0));
+        }
+        QCOMPARE(traverse(model.data()), s_windowCount);
+    } else {
+        int offset = 0;
+        QBENCHMARK {
+            offset++;
+            for (int i = 0; i < m_clients.count(); ++i) {
+                m_clients.at(i)->setDesktop((i + offset) % s_desktops + 1);
+            }
+        }
+        QCOMPARE(traverse(model.data()), s_windowCount);
+    }
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::ScriptingModelBenchmark)
+#include "scripting_model_benchmark.moc"
@@ -0,0 +1,233 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "abstract_backend.h"
+#include "composite.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <kwineffects.h>
+#include <kwinglutils.h>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_shader_state-0");
+
+class ShaderStateTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void testRedundantUniform();
+    void testRedundantBind();
+    void testRelink();
+    void testDestroyBoundProgram();
+    void testShaderManagerCleanup();
+
+private:
+    GLShader *createShader();
+};
+
+static GLint currentProgram()
+{
+    GLint program = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    return program;
+}
+
+void ShaderStateTest::initTestCase()
+{
+    QSignalSpy workspaceCreatedSpy(kwinApp(), &Application::workspaceCreated);
+    QVERIFY(workspaceCreatedSpy.isValid());
+    waylandServer()->backend()->setInitialWindowSize(QSize(1280, 1024));
+    waylandServer()->init(s_socketName.toLocal8Bit());
+
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+    // programs loaded from a binary have no shaders attached and cannot be linked again
+    qputenv("KWIN_GL_PROGRAM_CACHE", QByteArrayLiteral("0"));
+    kwinApp()->start();
+    QVERIFY(workspaceCreatedSpy.wait());
+    waylandServer()->initWorkspace();
+    if (!effects) {
+        QSignalSpy compositorToggledSpy(Compositor::self(), &Compositor::compositingToggled);
+        QVERIFY(compositorToggledSpy.isValid());
+        QVERIFY(compositorToggledSpy.wait());
+    }
+    QVERIFY(effects);
+    QCOMPARE(effects->compositingType(), OpenGL2Compositing);
+}
+
+void ShaderStateTest::init()
+{
+    QVERIFY(effects->makeOpenGLContextCurrent());
+    // between two frames no shader is pushed
+    QVERIFY(!ShaderManager::instance()->isShaderBound());
+}
+
+void ShaderStateTest::cleanup()
+{
+    QVERIFY(!ShaderManager::instance()->isShaderBound());
+    effects->doneOpenGLContextCurrent();
+}
+
+GLShader *ShaderStateTest::createShader()
+{
+    return ShaderManager::instance()->generateCustomShader(ShaderTrait::MapTexture | ShaderTrait::Modulate);
+}
+
+void ShaderStateTest::testRedundantUniform()
+{
+    // setting a uniform to the value it already has is skipped, any other value gets set
+    QScopedPointer<GLShader> shader(createShader());
+    QVERIFY(shader->isValid());
+    ShaderManager::instance()->pushShader(shader.data());
+
+    QMatrix4x4 first;
+    first.translate(10, 20);
+    QMatrix4x4 second;
+    second.translate(30, 40);
+    const ShaderManager::StateStatistics before = ShaderManager::stateStatistics();
+    QVERIFY(shader->setUniform(GLShader::ModelViewProjectionMatrix, first));
+    QVERIFY(shader->setUniform(GLShader::ModelViewProjectionMatrix, first));
+    QCOMPARE(ShaderManager::stateStatistics().uniformUpdates, before.uniformUpdates + 2);
+    QCOMPARE(ShaderManager::stateStatistics().redundantUniformUpdates, before.redundantUniformUpdates + 1);
+    QCOMPARE(shader->getUniformMatrix4x4("modelViewProjectionMatrix"), first);
+
+    QVERIFY(shader->setUniform(GLShader::ModelViewProjectionMatrix, second));
+    QCOMPARE(ShaderManager::stateStatistics().redundantUniformUpdates, before.redundantUniformUpdates + 1);
+    QCOMPARE(shader->getUniformMatrix4x4("modelViewProjectionMatrix"), second);
+
+    // the values are cached per program
+    QScopedPointer<GLShader> other(createShader());
+    QVERIFY(other->isValid());
+    ShaderManager::instance()->pushShader(other.data());
+    QVERIFY(other->setUniform(GLShader::ModelViewProjectionMatrix, second));
+    QCOMPARE(ShaderManager::stateStatistics().redundantUniformUpdates, before.redundantUniformUpdates + 1);
+    QCOMPARE(other->getUniformMatrix4x4("modelViewProjectionMatrix"), second);
+    ShaderManager::instance()->popShader();
+    ShaderManager::instance()->popShader();
+    QCOMPARE(glGetError(), GLenum(GL_NO_ERROR));
+}
+
+void ShaderStateTest::testRedundantBind()
+{
+    // binding the program which is already current is skipped
+    QScopedPointer<GLShader> shader(createShader());
+    QVERIFY(shader->isValid());
+    QScopedPointer<GLShader> other(createShader());
+    QVERIFY(other->isValid());
+
+    ShaderManager::instance()->pushShader(shader.data());
+    const GLint program = currentProgram();
+    QVERIFY(program != 0);
+    const ShaderManager::StateStatistics before = ShaderManager::stateStatistics();
+    // e.g. an effect binding the shader it pushed
+    shader->bind();
+    QCOMPARE(ShaderManager::stateStatistics().programBinds, before.programBinds + 1);
+    QCOMPARE(ShaderManager::stateStatistics().redundantProgramBinds, before.redundantProgramBinds + 1);
+    QCOMPARE(currentProgram(), program);
+
+    // a different program gets bound, and the previous one again when popping
+    ShaderManager::instance()->pushShader(other.data());
+    QCOMPARE(ShaderManager::stateStatistics().programBinds, before.programBinds + 2);
+    QCOMPARE(ShaderManager::stateStatistics().redundantProgramBinds, before.redundantProgramBinds + 1);
+    QVERIFY(currentProgram() != program);
+    ShaderManager::instance()->popShader();
+    QCOMPARE(ShaderManager::stateStatistics().programBinds, before.programBinds + 3);
+    QCOMPARE(ShaderManager::stateStatistics().redundantProgramBinds, before.redundantProgramBinds + 1);
+    QCOMPARE(currentProgram(), program);
+
+    // the last pop unbinds the program, so the next push has to bind it again
+    ShaderManager::instance()->popShader();
+    QCOMPARE(currentProgram(), 0);
+    ShaderManager::instance()->pushShader(shader.data());
+    QCOMPARE(ShaderManager::stateStatistics().programBinds, before.programBinds + 4);
+    QCOMPARE(ShaderManager::stateStatistics().redundantProgramBinds, before.redundantProgramBinds + 1);
+    QCOMPARE(currentProgram(), program);
+    ShaderManager::instance()->popShader();
+}
+
+void ShaderStateTest::testRelink()
+{
+    // linking resets the uniforms of the program, so the cached values are invalid
+    QScopedPointer<GLShader> shader(createShader());
+    QVERIFY(shader->isValid());
+    ShaderManager::instance()->pushShader(shader.data());
+    QMatrix4x4 matrix;
+    matrix.translate(10, 20);
+    QVERIFY(shader->setUniform(GLShader::ModelViewProjectionMatrix, matrix));
+    QCOMPARE(shader->getUniformMatrix4x4("modelViewProjectionMatrix"), matrix);
+
+    QVERIFY(shader->link());
+    QVERIFY(shader->getUniformMatrix4x4("modelViewProjectionMatrix") != matrix);
+    const ShaderManager::StateStatistics before = ShaderManager::stateStatistics();
+    QVERIFY(shader->setUniform(GLShader::ModelViewProjectionMatrix, matrix));
+    QCOMPARE(ShaderManager::stateStatistics().redundantUniformUpdates, before.redundantUniformUpdates);
+    QCOMPARE(shader->getUniformMatrix4x4("modelViewProjectionMatrix"), matrix);
+    ShaderManager::instance()->popShader();
+}
+
+void ShaderStateTest::testDestroyBoundProgram()
+{
+    // destroying the current program unbinds it, a new program might get the same name
+    // and still has to be bound
+    QScopedPointer<GLShader> shader(createShader());
+    QVERIFY(shader->isValid());
+    // bound without the ShaderManager, so that nothing unbinds it before it gets destroyed
+    shader->bind();
+    QVERIFY(currentProgram() != 0);
+    shader.reset();
+    QCOMPARE(currentProgram(), 0);
+
+    shader.reset(createShader());
+    QVERIFY(shader->isValid());
+    const ShaderManager::StateStatistics before = ShaderManager::stateStatistics();
+    ShaderManager::instance()->pushShader(shader.data());
+    QCOMPARE(ShaderManager::stateStatistics().programBinds, before.programBinds + 1);
+    QCOMPARE(ShaderManager::stateStatistics().redundantProgramBinds, before.redundantProgramBinds);
+    QVERIFY(currentProgram() != 0);
+    ShaderManager::instance()->popShader();
+    QCOMPARE(glGetError(), GLenum(GL_NO_ERROR));
+}
+
+void ShaderStateTest::testShaderManagerCleanup()
+{
+    // a new ShaderManager, e.g. for a new context, does not assume any program to be current
+    QScopedPointer<GLShader> shader(createShader());
+    QVERIFY(shader->isValid());
+    ShaderManager::instance()->pushShader(shader.data());
+    ShaderManager::instance()->popShader();
+
+    ShaderManager::cleanup();
+    QCOMPARE(ShaderManager::stateStatistics().programBinds, quint64(0));
+    QCOMPARE(ShaderManager::stateStatistics().uniformUpdates, quint64(0));
+    ShaderManager::instance()->pushShader(shader.data());
+    QCOMPARE(ShaderManager::stateStatistics().programBinds, quint64(1));
+    QCOMPARE(ShaderManager::stateStatistics().redundantProgramBinds, quint64(0));
+    ShaderManager::instance()->popShader();
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::ShaderStateTest)
+#include "shader_state_test.moc"
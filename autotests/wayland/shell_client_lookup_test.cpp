@@ -0,0 +1,203 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "abstract_backend.h"
+#include "abstract_client.h"
+#include "shell_client.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <KWayland/Client/connection_thread.h>
+#include <KWayland/Client/compositor.h>
+#include <KWayland/Client/event_queue.h>
+#include <KWayland/Client/registry.h>
+#include <KWayland/Client/shell.h>
+#include <KWayland/Client/shm_pool.h>
+#include <KWayland/Client/surface.h>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_shell_client_lookup-0");
+
+class ShellClientLookupTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void testLookup();
+
+private:
+    ShellClient *showWindow(KWayland::Client::Surface **surface);
+    KWayland::Client::ConnectionThread *m_connection = nullptr;
+    KWayland::Client::Compositor *m_compositor = nullptr;
+    KWayland::Client::ShmPool *m_shm = nullptr;
+    KWayland::Client::Shell *m_shell = nullptr;
+    KWayland::Client::EventQueue *m_queue = nullptr;
+    QThread *m_thread = nullptr;
+};
+
+void ShellClientLookupTest::initTestCase()
+{
+    qRegisterMetaType<KWin::ShellClient*>();
+    qRegisterMetaType<KWin::AbstractClient*>();
+    QSignalSpy workspaceCreatedSpy(kwinApp(), &Application::workspaceCreated);
+    QVERIFY(workspaceCreatedSpy.isValid());
+    waylandServer()->backend()->setInitialWindowSize(QSize(1280, 1024));
+    waylandServer()->init(s_socketName.toLocal8Bit());
+    kwinApp()->start();
+    QVERIFY(workspaceCreatedSpy.wait());
+    waylandServer()->initWorkspace();
+}
+
+void ShellClientLookupTest::init()
+{
+    using namespace KWayland::Client;
+    m_connection = new ConnectionThread;
+    QSignalSpy connectedSpy(m_connection, &ConnectionThread::connected);
+    QVERIFY(connectedSpy.isValid());
+    m_connection->setSocketName(s_socketName);
+
+    m_thread = new QThread(this);
+    m_connection->moveToThread(m_thread);
+    m_thread->start();
+
+    m_connection->initConnection();
+    QVERIFY(connectedSpy.wait());
+
+    m_queue = new EventQueue(this);
+    m_queue->setup(m_connection);
+    QVERIFY(m_queue->isValid());
+
+    Registry registry;
+    registry.setEventQueue(m_queue);
+    QSignalSpy allAnnounced(&registry, &Registry::interfacesAnnounced);
+    QVERIFY(allAnnounced.isValid());
+    registry.create(m_connection->display());
+    QVERIFY(registry.isValid());
+    registry.setup();
+    QVERIFY(allAnnounced.wait());
+
+    const auto compositor = registry.interface(Registry::Interface::Compositor);
+    m_compositor = registry.createCompositor(compositor.name, compositor.version, this);
+    QVERIFY(m_compositor->isValid());
+    const auto shm = registry.interface(Registry::Interface::Shm);
+    m_shm = registry.createShmPool(shm.name, shm.version, this);
+    QVERIFY(m_shm->isValid());
+    const auto shell = registry.interface(Registry::Interface::Shell);
+    m_shell = registry.createShell(shell.name, shell.version, this);
+    QVERIFY(m_shell->isValid());
+}
+
+void ShellClientLookupTest::cleanup()
+{
+    delete m_compositor;
+    m_compositor = nullptr;
+    delete m_shm;
+    m_shm = nullptr;
+    delete m_shell;
+    m_shell = nullptr;
+    delete m_queue;
+    m_queue = nullptr;
+    if (m_thread) {
+        m_connection->deleteLater();
+        m_thread->quit();
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+        m_connection = nullptr;
+    }
+}
+
+ShellClient *ShellClientLookupTest::showWindow(KWayland::Client::Surface **surface)
+{
+    using namespace KWayland::Client;
+#define VERIFY(statement) \
+    if (!QTest::qVerify((statement), #statement, "", __FILE__, __LINE__))\
+        return nullptr;
+    QSignalSpy clientAddedSpy(waylandServer(), &WaylandServer::shellClientAdded);
+    VERIFY(clientAddedSpy.isValid());
+
+    *surface = m_compositor->createSurface(m_compositor);
+    VERIFY(*surface);
+    ShellSurface *shellSurface = m_shell->createSurface(*surface, *surface);
+    VERIFY(shellSurface);
+    QImage img(QSize(100, 50), QImage::Format_ARGB32);
+    img.fill(Qt::blue);
+    (*surface)->attachBuffer(m_shm->createBuffer(img));
+    (*surface)->damage(QRect(0, 0, 100, 50));
+    (*surface)->commit(Surface::CommitFlag::None);
+    m_connection->flush();
+    VERIFY(clientAddedSpy.wait());
+#undef VERIFY
+    return clientAddedSpy.first().first().value<ShellClient*>();
+}
+
+void ShellClientLookupTest::testLookup()
+{
+    // several windows of one client connection get unique ids and can be found by id and surface
+    using namespace KWayland::Client;
+    QVector<Surface*> surfaces;
+    QVector<ShellClient*> clients;
+    QSet<quint32> ids;
+    for (int i = 0; i < 5; ++i) {
+        Surface *surface = nullptr;
+        ShellClient *c = showWindow(&surface);
+        QVERIFY(c);
+        QVERIFY(c->windowId() != 0);
+        QVERIFY(!ids.contains(c->windowId()));
+        ids << c->windowId();
+        surfaces << surface;
+        clients << c;
+    }
+    // all windows share the client connection part of the id
+    for (quint32 id : ids) {
+        QCOMPARE(id >> 16, clients.first()->windowId() >> 16);
+    }
+    for (ShellClient *c : clients) {
+        QCOMPARE(waylandServer()->findClient(c->windowId()), c);
+        QCOMPARE(waylandServer()->findClient(c->surface()), c);
+    }
+
+    // destroying a window removes it from the lookup
+    ShellClient *first = clients.takeFirst();
+    const quint32 firstId = first->windowId();
+    // only used as lookup key, the surface is gone once the window got destroyed
+    KWayland::Server::SurfaceInterface *firstSurface = first->surface();
+    QSignalSpy removedSpy(waylandServer(), &WaylandServer::shellClientRemoved);
+    QVERIFY(removedSpy.isValid());
+    delete surfaces.takeFirst();
+    QVERIFY(removedSpy.wait());
+    QVERIFY(!waylandServer()->findClient(firstId));
+    QVERIFY(!waylandServer()->findClient(firstSurface));
+    for (ShellClient *c : clients) {
+        QCOMPARE(waylandServer()->findClient(c->windowId()), c);
+        QCOMPARE(waylandServer()->findClient(c->surface()), c);
+    }
+    QVERIFY(!waylandServer()->findClient(quint32(0)));
+    QVERIFY(!waylandServer()->findClient(static_cast<KWayland::Server::SurfaceInterface*>(nullptr)));
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::ShellClientLookupTest)
+#include "shell_client_lookup_test.moc"
@@ -0,0 +1,322 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "abstract_backend.h"
+#include "composite.h"
+#include "effects.h"
+#include "scene.h"
+#include "shell_client.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <kwineffects.h>
+
+#include <KWayland/Server/buffer_interface.h>
+#include <KWayland/Server/subcompositor_interface.h>
+#include <KWayland/Server/surface_interface.h>
+
+#include <KWayland/Client/connection_thread.h>
+#include <KWayland/Client/compositor.h>
+#include <KWayland/Client/event_queue.h>
+#include <KWayland/Client/registry.h>
+#include <KWayland/Client/shell.h>
+#include <KWayland/Client/shm_pool.h>
+#include <KWayland/Client/subcompositor.h>
+#include <KWayland/Client/subsurface.h>
+#include <KWayland/Client/surface.h>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_subsurface-0");
+
+class SubSurfaceTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void testDesynchronizedCommit();
+    void testStackingOrder();
+    void testDestroySubSurface();
+
+private:
+    void render(KWayland::Client::Surface *surface, const QSize &size, const QColor &color);
+    KWayland::Client::ConnectionThread *m_connection = nullptr;
+    KWayland::Client::Compositor *m_compositor = nullptr;
+    KWayland::Client::SubCompositor *m_subCompositor = nullptr;
+    KWayland::Client::ShmPool *m_shm = nullptr;
+    KWayland::Client::Shell *m_shell = nullptr;
+    KWayland::Client::EventQueue *m_queue = nullptr;
+    QThread *m_thread = nullptr;
+};
+
+void SubSurfaceTest::initTestCase()
+{
+    qRegisterMetaType<KWin::ShellClient*>();
+    qRegisterMetaType<KWin::AbstractClient*>();
+    QSignalSpy workspaceCreatedSpy(kwinApp(), &Application::workspaceCreated);
+    QVERIFY(workspaceCreatedSpy.isValid());
+    waylandServer()->backend()->setInitialWindowSize(QSize(1280, 1024));
+    waylandServer()->init(s_socketName.toLocal8Bit());
+    // the subsurfaces are painted by the OpenGL scene
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+    kwinApp()->start();
+    QVERIFY(workspaceCreatedSpy.wait());
+    waylandServer()->initWorkspace();
+    QVERIFY(effects);
+    QCOMPARE(effects->compositingType(), OpenGL2Compositing);
+}
+
+void SubSurfaceTest::init()
+{
+    using namespace KWayland::Client;
+    // setup connection
+    m_connection = new ConnectionThread;
+    QSignalSpy connectedSpy(m_connection, &ConnectionThread::connected);
+    QVERIFY(connectedSpy.isValid());
+    m_connection->setSocketName(s_socketName);
+
+    m_thread = new QThread(this);
+    m_connection->moveToThread(m_thread);
+    m_thread->start();
+
+    m_connection->initConnection();
+    QVERIFY(connectedSpy.wait());
+
+    m_queue = new EventQueue(this);
+    m_queue->setup(m_connection);
+    QVERIFY(m_queue->isValid());
+
+    Registry registry;
+    registry.setEventQueue(m_queue);
+    QSignalSpy allAnnounced(&registry, &Registry::interfacesAnnounced);
+    QVERIFY(allAnnounced.isValid());
+    registry.create(m_connection->display());
+    QVERIFY(registry.isValid());
+    registry.setup();
+    QVERIFY(allAnnounced.wait());
+
+    const auto compositor = registry.interface(Registry::Interface::Compositor);
+    m_compositor = registry.createCompositor(compositor.name, compositor.version, this);
+    QVERIFY(m_compositor->isValid());
+    const auto subCompositor = registry.interface(Registry::Interface::SubCompositor);
+    QVERIFY(subCompositor.name != 0);
+    m_subCompositor = registry.createSubCompositor(subCompositor.name, subCompositor.version, this);
+    QVERIFY(m_subCompositor->isValid());
+    const auto shm = registry.interface(Registry::Interface::Shm);
+    m_shm = registry.createShmPool(shm.name, shm.version, this);
+    QVERIFY(m_shm->isValid());
+    const auto shell = registry.interface(Registry::Interface::Shell);
+    m_shell = registry.createShell(shell.name, shell.version, this);
+    QVERIFY(m_shell->isValid());
+}
+
+void SubSurfaceTest::cleanup()
+{
+    delete m_compositor;
+    m_compositor = nullptr;
+    delete m_subCompositor;
+    m_subCompositor = nullptr;
+    delete m_shm;
+    m_shm = nullptr;
+    delete m_shell;
+    m_shell = nullptr;
+    delete m_queue;
+    m_queue = nullptr;
+    if (m_thread) {
+        m_connection->deleteLater();
+        m_thread->quit();
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+        m_connection = nullptr;
+    }
+}
+
+void SubSurfaceTest::render(KWayland::Client::Surface *surface, const QSize &size, const QColor &color)
+{
+    QImage img(size, QImage::Format_ARGB32);
+    img.fill(color);
+    surface->attachBuffer(m_shm->createBuffer(img));
+    surface->damage(QRect(QPoint(0, 0), size));
+    surface->commit(KWayland::Client::Surface::CommitFlag::FrameCallback);
+    m_connection->flush();
+}
+
+void SubSurfaceTest::testDesynchronizedCommit()
+{
+    // a desynchronized subsurface gets repainted without the main surface committing
+    using namespace KWayland::Client;
+    QScopedPointer<Surface> surface(m_compositor->createSurface());
+    QScopedPointer<ShellSurface> shellSurface(m_shell->createSurface(surface.data()));
+    QScopedPointer<Surface> childSurface(m_compositor->createSurface());
+    QScopedPointer<SubSurface> subSurface(m_subCompositor->createSubSurface(childSurface.data(), surface.data()));
+    QVERIFY(subSurface->isValid());
+    subSurface->setPosition(QPoint(20, 10));
+    subSurface->setMode(SubSurface::Mode::Desynchronized);
+    render(childSurface.data(), QSize(20, 20), Qt::red);
+
+    QSignalSpy clientAddedSpy(waylandServer(), &WaylandServer::shellClientAdded);
+    QVERIFY(clientAddedSpy.isValid());
+    render(surface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(clientAddedSpy.wait());
+    ShellClient *c = clientAddedSpy.first().first().value<ShellClient*>();
+    QVERIFY(c);
+    QCOMPARE(c->surface()->childSubSurfaces().count(), 1);
+
+    QSignalSpy frameRenderedSpy(surface.data(), &Surface::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+    QVERIFY(frameRenderedSpy.wait());
+
+    // only the subsurface commits, it gets its frame callback and only its area gets repainted
+    KWayland::Server::SurfaceInterface *serverChild = c->surface()->childSubSurfaces().first()->surface().data();
+    QVERIFY(serverChild);
+    QVector<QRegion> repaints;
+    // connected after the scene, so the repaint of the subsurface damage is already added
+    QMetaObject::Connection damagedConnection = connect(serverChild, &KWayland::Server::SurfaceInterface::damaged, this,
+        [c, &repaints] {
+            repaints << c->repaints();
+        }
+    );
+    QSignalSpy childFrameRenderedSpy(childSurface.data(), &Surface::frameRendered);
+    QVERIFY(childFrameRenderedSpy.isValid());
+    for (int i = 0; i < 5; ++i) {
+        render(childSurface.data(), QSize(20, 20), i % 2 ? Qt::red : Qt::green);
+        QVERIFY(childFrameRenderedSpy.wait());
+        QCOMPARE(repaints.count(), i + 1);
+        QCOMPARE(repaints.last(), QRegion(QRect(c->clientPos() + QPoint(20, 10), QSize(20, 20))));
+        QVERIFY(frameRenderedSpy.count() == 1);
+    }
+    // the subsurface is allowed to change its size without the main surface
+    render(childSurface.data(), QSize(40, 30), Qt::green);
+    QVERIFY(childFrameRenderedSpy.wait());
+    QCOMPARE(repaints.last(), QRegion(QRect(c->clientPos() + QPoint(20, 10), QSize(40, 30))));
+    QCOMPARE(c->surface()->childSubSurfaces().first()->surface()->buffer()->size(), QSize(40, 30));
+    disconnect(damagedConnection);
+}
+
+void SubSurfaceTest::testStackingOrder()
+{
+    // the subsurfaces are painted in the stacking order of the subsurface tree
+    using namespace KWayland::Client;
+    QScopedPointer<Surface> surface(m_compositor->createSurface());
+    QScopedPointer<ShellSurface> shellSurface(m_shell->createSurface(surface.data()));
+    QScopedPointer<Surface> firstSurface(m_compositor->createSurface());
+    QScopedPointer<SubSurface> first(m_subCompositor->createSubSurface(firstSurface.data(), surface.data()));
+    QScopedPointer<Surface> secondSurface(m_compositor->createSurface());
+    QScopedPointer<SubSurface> second(m_subCompositor->createSubSurface(secondSurface.data(), surface.data()));
+    // overlapping
+    first->setPosition(QPoint(10, 10));
+    second->setPosition(QPoint(20, 15));
+    render(firstSurface.data(), QSize(40, 20), Qt::red);
+    render(secondSurface.data(), QSize(40, 20), Qt::green);
+
+    QSignalSpy clientAddedSpy(waylandServer(), &WaylandServer::shellClientAdded);
+    QVERIFY(clientAddedSpy.isValid());
+    render(surface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(clientAddedSpy.wait());
+    ShellClient *c = clientAddedSpy.first().first().value<ShellClient*>();
+    QVERIFY(c);
+    QSignalSpy frameRenderedSpy(surface.data(), &Surface::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+    QVERIFY(frameRenderedSpy.wait());
+
+    // the order KWin paints the subsurfaces in, the scene paints the children of the WindowPixmap
+    auto stackingOrder = [c] {
+        QVector<KWayland::Server::SurfaceInterface*> order;
+        WindowPixmap *pixmap = c->effectWindow()->sceneWindow()->windowPixmap<WindowPixmap>();
+        if (!pixmap) {
+            return order;
+        }
+        for (WindowPixmap *child : pixmap->children()) {
+            order << (child->subSurface() ? child->subSurface()->surface().data() : nullptr);
+        }
+        return order;
+    };
+    const auto serverSubSurfaces = c->surface()->childSubSurfaces();
+    QCOMPARE(serverSubSurfaces.count(), 2);
+    KWayland::Server::SurfaceInterface *serverFirst = serverSubSurfaces.at(0)->surface().data();
+    KWayland::Server::SurfaceInterface *serverSecond = serverSubSurfaces.at(1)->surface().data();
+    QCOMPARE(serverSubSurfaces.first()->position(), QPoint(10, 10));
+    QCOMPARE(stackingOrder(), (QVector<KWayland::Server::SurfaceInterface*>{serverFirst, serverSecond}));
+
+    // restacking is applied with the next commit of the parent, even if the parent is not damaged
+    QSignalSpy treeChangedSpy(c->surface(), &KWayland::Server::SurfaceInterface::subSurfaceTreeChanged);
+    QVERIFY(treeChangedSpy.isValid());
+    QSignalSpy repaintsSpy(c, &Toplevel::needsRepaint);
+    QVERIFY(repaintsSpy.isValid());
+    first->placeAbove(secondSurface.data());
+    surface->commit(Surface::CommitFlag::None);
+    QVERIFY(treeChangedSpy.wait());
+    QVERIFY(!repaintsSpy.isEmpty());
+    QCOMPARE(stackingOrder(), (QVector<KWayland::Server::SurfaceInterface*>{serverSecond, serverFirst}));
+
+    first->placeBelow(secondSurface.data());
+    render(surface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(frameRenderedSpy.wait());
+    QCOMPARE(stackingOrder(), (QVector<KWayland::Server::SurfaceInterface*>{serverFirst, serverSecond}));
+
+    // both subsurfaces still get their frame callbacks in the new order
+    QSignalSpy firstFrameRenderedSpy(firstSurface.data(), &Surface::frameRendered);
+    QVERIFY(firstFrameRenderedSpy.isValid());
+    QSignalSpy secondFrameRenderedSpy(secondSurface.data(), &Surface::frameRendered);
+    QVERIFY(secondFrameRenderedSpy.isValid());
+    render(firstSurface.data(), QSize(40, 20), Qt::green);
+    render(secondSurface.data(), QSize(40, 20), Qt::red);
+    QVERIFY(firstFrameRenderedSpy.wait());
+    if (secondFrameRenderedSpy.isEmpty()) {
+        QVERIFY(secondFrameRenderedSpy.wait());
+    }
+}
+
+void SubSurfaceTest::testDestroySubSurface()
+{
+    // destroying the subsurface removes it from the tree without destroying the window
+    using namespace KWayland::Client;
+    QScopedPointer<Surface> surface(m_compositor->createSurface());
+    QScopedPointer<ShellSurface> shellSurface(m_shell->createSurface(surface.data()));
+    QScopedPointer<Surface> childSurface(m_compositor->createSurface());
+    QScopedPointer<SubSurface> subSurface(m_subCompositor->createSubSurface(childSurface.data(), surface.data()));
+    render(childSurface.data(), QSize(20, 20), Qt::red);
+
+    QSignalSpy clientAddedSpy(waylandServer(), &WaylandServer::shellClientAdded);
+    QVERIFY(clientAddedSpy.isValid());
+    render(surface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(clientAddedSpy.wait());
+    ShellClient *c = clientAddedSpy.first().first().value<ShellClient*>();
+    QVERIFY(c);
+    QSignalSpy frameRenderedSpy(surface.data(), &Surface::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+    QVERIFY(frameRenderedSpy.wait());
+
+    subSurface.reset();
+    childSurface.reset();
+    render(surface.data(), QSize(100, 50), Qt::red);
+    QVERIFY(frameRenderedSpy.wait());
+    QVERIFY(c->surface()->childSubSurfaces().isEmpty());
+    QVERIFY(waylandServer()->clients().contains(c));
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::SubSurfaceTest)
+#include "subsurface_test.moc"
@@ -0,0 +1,308 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "abstract_backend.h"
+#include "composite.h"
+#include "effects.h"
+#include "lanczosfilter.h"
+#include "scene.h"
+#include "shell_client.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <KWayland/Client/registry.h>
+#include <KWayland/Client/connection_thread.h>
+#include <KWayland/Client/compositor.h>
+#include <KWayland/Client/shm_pool.h>
+#include <KWayland/Client/shell.h>
+#include <KWayland/Client/surface.h>
+#include <KWayland/Client/event_queue.h>
+
+#include <QElapsedTimer>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_thumbnail_benchmark-0");
+static const int s_windowCount = 100;
+static const int s_columns = 10;
+static const QSize s_windowSize = QSize(400, 300);
+static const QSize s_cellSize = QSize(128, 96);
+static const int s_frames = 60;
+// windows which update their content in every frame when the updating rows are benchmarked
+static const int s_updatingWindows = 10;
+
+/**
+ * Effect painting all windows scaled down in a grid, like present windows or the
+ * thumbnails of the window switcher, and measuring the time spent painting a frame.
+ **/
+class ThumbnailGridEffect : public Effect
+{
+    Q_OBJECT
+public:
+    void prePaintScreen(ScreenPrePaintData &data, int time) override {
+        m_timer.start();
+        data.mask |= PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS;
+        effects->prePaintScreen(data, time);
+    }
+    void postPaintScreen() override {
+        effects->postPaintScreen();
+        m_paintTime += m_timer.nsecsElapsed();
+        m_frames++;
+        effects->addRepaintFull();
+    }
+    void prePaintWindow(EffectWindow *w, WindowPrePaintData &data, int time) override {
+        if (m_windows.contains(w)) {
+            data.setTransformed();
+        }
+        effects->prePaintWindow(w, data, time);
+    }
+    void paintWindow(EffectWindow *w, int mask, QRegion region, WindowPaintData &data) override {
+        const int index = m_windows.indexOf(w);
+        if (index != -1) {
+            data.setXScale(s_cellSize.width() / qreal(w->width()));
+            data.setYScale(s_cellSize.height() / qreal(w->height()));
+            data.setXTranslation((index % s_columns) * s_cellSize.width() - w->x());
+            data.setYTranslation((index / s_columns) * s_cellSize.height() - w->y());
+            mask |= PAINT_WINDOW_TRANSFORMED | PAINT_WINDOW_LANCZOS;
+        }
+        effects->paintWindow(w, mask, region, data);
+    }
+    bool isActive() const override {
+        return !m_windows.isEmpty();
+    }
+
+    void setWindows(const EffectWindowList &windows) {
+        m_windows = windows;
+        effects->addRepaintFull();
+    }
+    void resetMeasurement() {
+        m_paintTime = 0;
+        m_frames = 0;
+    }
+    qreal averagePaintTime() const {
+        return m_frames ? qreal(m_paintTime) / qreal(m_frames) / 1000000.0 : 0.0;
+    }
+    int frames() const {
+        return m_frames;
+    }
+
+private:
+    EffectWindowList m_windows;
+    QElapsedTimer m_timer;
+    qint64 m_paintTime = 0;
+    int m_frames = 0;
+};
+
+class ThumbnailBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkThumbnails_data();
+    void benchmarkThumbnails();
+
+private:
+    void render(KWayland::Client::Surface *surface, const QColor &color);
+    KWayland::Client::ConnectionThread *m_connection = nullptr;
+    KWayland::Client::Compositor *m_compositor = nullptr;
+    KWayland::Client::ShmPool *m_shm = nullptr;
+    KWayland::Client::Shell *m_shell = nullptr;
+    KWayland::Client::EventQueue *m_queue = nullptr;
+    QThread *m_thread = nullptr;
+    QList<KWayland::Client::Surface*> m_surfaces;
+    EffectWindowList m_windows;
+    ThumbnailGridEffect *m_effect = nullptr;
+};
+
+void ThumbnailBenchmark::initTestCase()
+{
+    qRegisterMetaType<KWin::ShellClient*>();
+    qRegisterMetaType<KWin::AbstractClient*>();
+    waylandServer()->backend()->setInitialWindowSize(QSize(1280, 1024));
+    waylandServer()->init(s_socketName.toLocal8Bit());
+
+    // the thumbnail cache is part of the lanczos filter of the OpenGL scene
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+    qputenv("KWIN_FORCE_LANCZOS", QByteArrayLiteral("1"));
+    kwinApp()->start();
+    QVERIFY(Compositor::self());
+    QSignalSpy compositorToggledSpy(Compositor::self(), &Compositor::compositingToggled);
+    QVERIFY(compositorToggledSpy.isValid());
+    QVERIFY(compositorToggledSpy.wait());
+    QVERIFY(effects);
+    QCOMPARE(effects->compositingType(), OpenGL2Compositing);
+
+    // load the grid effect
+    QObject *loader = nullptr;
+    const auto children = effects->children();
+    for (auto it = children.begin(); it != children.end(); ++it) {
+        if (qstrcmp((*it)->metaObject()->className(), "KWin::EffectLoader") == 0) {
+            loader = *it;
+            break;
+        }
+    }
+    QVERIFY(loader);
+    m_effect = new ThumbnailGridEffect;
+    QVERIFY(QMetaObject::invokeMethod(loader, "effectLoaded", Q_ARG(KWin::Effect*, m_effect), Q_ARG(QString, QStringLiteral("thumbnailgrid"))));
+
+    using namespace KWayland::Client;
+    // setup connection
+    m_connection = new ConnectionThread;
+    QSignalSpy connectedSpy(m_connection, &ConnectionThread::connected);
+    QVERIFY(connectedSpy.isValid());
+    m_connection->setSocketName(s_socketName);
+
+    m_thread = new QThread(this);
+    m_connection->moveToThread(m_thread);
+    m_thread->start();
+
+    m_connection->initConnection();
+    QVERIFY(connectedSpy.wait());
+
+    m_queue = new EventQueue(this);
+    m_queue->setup(m_connection);
+    QVERIFY(m_queue->isValid());
+
+    Registry registry;
+    registry.setEventQueue(m_queue);
+    QSignalSpy allAnnounced(&registry, &Registry::interfacesAnnounced);
+    QVERIFY(allAnnounced.isValid());
+    registry.create(m_connection->display());
+    QVERIFY(registry.isValid());
+    registry.setup();
+    QVERIFY(allAnnounced.wait());
+
+    const auto compositor = registry.interface(Registry::Interface::Compositor);
+    m_compositor = registry.createCompositor(compositor.name, compositor.version, this);
+    QVERIFY(m_compositor->isValid());
+    const auto shm = registry.interface(Registry::Interface::Shm);
+    m_shm = registry.createShmPool(shm.name, shm.version, this);
+    QVERIFY(m_shm->isValid());
+    const auto shell = registry.interface(Registry::Interface::Shell);
+    m_shell = registry.createShell(shell.name, shell.version, this);
+    QVERIFY(m_shell->isValid());
+
+    // create the windows
+    QSignalSpy clientAddedSpy(waylandServer(), &WaylandServer::shellClientAdded);
+    QVERIFY(clientAddedSpy.isValid());
+    for (int i = 0; i < s_windowCount; ++i) {
+        Surface *surface = m_compositor->createSurface(m_compositor);
+        QVERIFY(surface);
+        ShellSurface *shellSurface = m_shell->createSurface(surface, surface);
+        QVERIFY(shellSurface);
+        render(surface, Qt::blue);
+        QVERIFY(clientAddedSpy.wait());
+        ShellClient *c = clientAddedSpy.last().first().value<ShellClient*>();
+        QVERIFY(c);
+        QVERIFY(c->effectWindow());
+        m_surfaces << surface;
+        m_windows << c->effectWindow();
+    }
+}
+
+void ThumbnailBenchmark::cleanupTestCase()
+{
+    m_windows.clear();
+    m_surfaces.clear();
+    delete m_compositor;
+    m_compositor = nullptr;
+    delete m_shm;
+    m_shm = nullptr;
+    delete m_shell;
+    m_shell = nullptr;
+    delete m_queue;
+    m_queue = nullptr;
+    if (m_thread) {
+        m_connection->deleteLater();
+        m_thread->quit();
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+        m_connection = nullptr;
+    }
+}
+
+void ThumbnailBenchmark::render(KWayland::Client::Surface *surface, const QColor &color)
+{
+    QImage img(s_windowSize, QImage::Format_ARGB32);
+    img.fill(color);
+    surface->attachBuffer(m_shm->createBuffer(img));
+    surface->damage(QRect(QPoint(0, 0), s_windowSize));
+    surface->commit(KWayland::Client::Surface::CommitFlag::None);
+    m_connection->flush();
+}
+
+void ThumbnailBenchmark::benchmarkThumbnails_data()
+{
+    QTest::addColumn<bool>("updating");
+    QTest::addColumn<QString>("metric");
+
+    for (bool updating : {false, true}) {
+        const QString prefix = updating ? QStringLiteral("updating windows") : QStringLiteral("static windows");
+        QTest::newRow(qPrintable(prefix + QStringLiteral("/frame time"))) << updating << QStringLiteral("time");
+        QTest::newRow(qPrintable(prefix + QStringLiteral("/rendered thumbnails per frame"))) << updating << QStringLiteral("rendered");
+        QTest::newRow(qPrintable(prefix + QStringLiteral("/deferred thumbnails per frame"))) << updating << QStringLiteral("deferred");
+    }
+}
+
+void ThumbnailBenchmark::benchmarkThumbnails()
+{
+    QFETCH(bool, updating);
+    QFETCH(QString, metric);
+    Scene *scene = Compositor::self()->scene();
+    QVERIFY(scene);
+    QSignalSpy frameSpy(Compositor::self(), &Compositor::aboutToPaintFrame);
+    QVERIFY(frameSpy.isValid());
+
+    m_effect->setWindows(m_windows);
+    // let the first frames fill the cache
+    for (int i = 0; i < s_windowCount / LanczosFilter::MaximumUpdatesPerFrame + 2; ++i) {
+        QVERIFY(frameSpy.wait());
+    }
+
+    m_effect->resetMeasurement();
+    const Scene::ThumbnailStatistics before = scene->thumbnailStatistics();
+    for (int i = 0; i < s_frames; ++i) {
+        if (updating) {
+            for (int j = 0; j < s_updatingWindows; ++j) {
+                render(m_surfaces.at(j), i % 2 ? Qt::red : Qt::green);
+            }
+        }
+        QVERIFY(frameSpy.wait());
+    }
+    const Scene::ThumbnailStatistics &after = scene->thumbnailStatistics();
+    const int frames = qMax(1, m_effect->frames());
+    m_effect->setWindows(EffectWindowList());
+
+    if (metric == QLatin1String("time")) {
+        QTest::setBenchmarkResult(m_effect->averagePaintTime(), QTest::WalltimeMilliseconds);
+    } else if (metric == QLatin1String("rendered")) {
+        QTest::setBenchmarkResult(qreal(after.renderedThumbnails - before.renderedThumbnails) / frames, QTest::Events);
+    } else {
+        QTest::setBenchmarkResult(qreal(after.deferredThumbnails - before.deferredThumbnails) / frames, QTest::Events);
+    }
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::ThumbnailBenchmark)
+#include "thumbnail_benchmark.moc"
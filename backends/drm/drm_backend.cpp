@@ -280,8 +280,6 @@ void DrmBackend::pageFlipHandler(int fd, unsigned int frame, unsigned int sec, u
 {
     Q_UNUSED(fd)
     Q_UNUSED(frame)
-    Q_UNUSED(sec)
-    Q_UNUSED(usec)
     auto output = reinterpret_cast<DrmOutput*>(data);
     output->pageFlipped();
     output->m_backend->m_pageFlipsPending--;
@@ -289,6 +287,8 @@ void DrmBackend::pageFlipHandler(int fd, unsigned int frame, unsigned int sec, u
         // TODO: improve, this currently means we wait for all page flips or all outputs.
         // It would be better to driver the repaint per output
         if (Compositor::self()) {
+            // the vblank of the last page flip, the timestamps are from the monotonic clock
+            Compositor::self()->setPresentationTimestamp(qint64(sec) * 1000 + usec / 1000);
             Compositor::self()->bufferSwapComplete();
         }
     }
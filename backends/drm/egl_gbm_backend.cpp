@@ -265,17 +265,7 @@ QRegion EglGbmBackend::prepareRenderingForScreen(int screenId)
     const Output &o = m_outputs.at(screenId);
     makeContextCurrent(o);
     if (supportsBufferAge()) {
-        QRegion region;
-
-        // Note: An age of zero means the buffer contents are undefined
-        if (o.bufferAge > 0 && o.bufferAge <= o.damageHistory.count()) {
-            for (int i = 0; i < o.bufferAge - 1; i++)
-                region |= o.damageHistory[i];
-        } else {
-            region = o.output->geometry();
-        }
-
-        return region;
+        return o.damageHistory.accumulate(o.bufferAge, o.output->geometry());
     }
     return QRegion();
 }
@@ -317,11 +307,7 @@ void EglGbmBackend::endRenderingFrameForScreen(int screenId, const QRegion &rend
     // age on the first output. To properly support buffer age on all outputs the rendering needs to
     // be refactored in general.
     if (supportsBufferAge() && screenId == 0) {
-        if (o.damageHistory.count() > 10) {
-            o.damageHistory.removeLast();
-        }
-
-        o.damageHistory.prepend(damagedRegion.intersected(o.output->geometry()));
+        o.damageHistory.add(damagedRegion.intersected(o.output->geometry()));
     }
 }
 
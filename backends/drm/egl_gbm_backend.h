@@ -65,9 +65,9 @@ private:
         EGLSurface eglSurface = EGL_NO_SURFACE;
         int bufferAge = 0;
         /**
-        * @brief The damage history for the past 10 frames.
+        * @brief The damage history for the past frames.
         */
-        QList<QRegion> damageHistory;
+        DamageHistory damageHistory;
     };
     bool makeContextCurrent(const Output &output);
     void presentOnOutput(Output &output);
@@ -39,12 +39,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "xcbutils.h"
 #include "abstract_backend.h"
 #include "shell_client.h"
+#include "tracing.h"
 #include "wayland_server.h"
 #include "decorations/decoratedclient.h"
 
 #include <KWayland/Server/surface_interface.h>
 
 #include <stdio.h>
+#include <time.h>
 
 #include <QtConcurrentRun>
 #include <QFutureWatcher>
@@ -384,7 +386,7 @@ void Compositor::finish()
     delete m_scene;
     m_scene = NULL;
     compositeTimer.stop();
-    repaints_region = QRegion();
+    repaints_region.clear();
     if (Workspace::self()) {
         for (ClientList::ConstIterator it = Workspace::self()->clientList().constBegin();
                 it != Workspace::self()->clientList().constEnd();
@@ -580,7 +582,7 @@ void Compositor::addRepaint(int x, int y, int w, int h)
 {
     if (!hasScene())
         return;
-    repaints_region += QRegion(x, y, w, h);
+    repaints_region += QRect(x, y, w, h);
     scheduleRepaint();
 }
 
@@ -605,7 +607,7 @@ void Compositor::addRepaintFull()
     if (!hasScene())
         return;
     const QSize &s = screens()->size();
-    repaints_region = QRegion(0, 0, s.width(), s.height());
+    repaints_region = DamageRegion(QRect(0, 0, s.width(), s.height()));
     scheduleRepaint();
 }
 
@@ -624,11 +626,26 @@ void Compositor::aboutToSwapBuffers()
     m_bufferSwapPending = true;
 }
 
+static qint64 monotonicTime()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+void Compositor::setPresentationTimestamp(qint64 timestamp)
+{
+    m_presentationTimestamp = timestamp;
+}
+
 void Compositor::bufferSwapComplete()
 {
     assert(m_bufferSwapPending);
     m_bufferSwapPending = false;
 
+    presentFrame(m_presentationTimestamp >= 0 ? m_presentationTimestamp : monotonicTime());
+    m_presentationTimestamp = -1;
+
     if (m_composeAtSwapCompletion) {
         m_composeAtSwapCompletion = false;
         performCompositing();
@@ -637,6 +654,7 @@ void Compositor::bufferSwapComplete()
 
 void Compositor::performCompositing()
 {
+    KWIN_TRACE("compositor", "performCompositing");
     if (m_scene->usesOverlayWindow() && !isOverlayWindowVisible())
         return; // nothing is visible anyway
 
@@ -655,6 +673,8 @@ void Compositor::performCompositing()
         return;
     }
 
+    emit aboutToPaintFrame();
+
     // Create a list of all windows in the stacking order
     ToplevelList windows = Workspace::self()->xStackingOrder();
     ToplevelList damaged;
@@ -680,22 +700,12 @@ void Compositor::performCompositing()
 
     // Get the replies
     foreach (Toplevel *win, damaged) {
-        // Discard the cached lanczos texture
-        if (win->effectWindow()) {
-            const QVariant texture = win->effectWindow()->data(LanczosCacheRole);
-            if (texture.isValid()) {
-                delete static_cast<GLTexture *>(texture.value<void*>());
-                win->effectWindow()->setData(LanczosCacheRole, QVariant());
-            }
-        }
-
         win->getDamageRegionReply();
     }
 
     if (repaints_region.isEmpty() && !windowRepaintsPending()) {
         m_scene->idle();
         m_timeSinceLastVBlank = fpsInterval - (options->vBlankTime() + 1); // means "start now"
-        m_timeSinceStart += m_timeSinceLastVBlank;
         // Note: It would seem here we should undo suspended unredirect, but when scenes need
         // it for some reason, e.g. transformations or translucency, the next pass that does not
         // need this anymore and paints normally will also reset the suspended unredirect.
@@ -720,19 +730,27 @@ void Compositor::performCompositing()
         }
     }
 
-    QRegion repaints = repaints_region;
+    QRegion repaints = repaints_region.toRegion();
     // clear all repaints, so that post-pass can add repaints for the next repaint
-    repaints_region = QRegion();
+    repaints_region.clear();
 
+    m_scene->clearPresentedWindows();
     m_timeSinceLastVBlank = m_scene->paint(repaints, windows);
-    m_timeSinceStart += m_timeSinceLastVBlank;
 
     if (kwinApp()->shouldUseWaylandForCompositing()) {
-        for (Toplevel *win : damaged) {
-            if (auto surface = win->surface()) {
-                surface->frameRendered(m_timeSinceStart);
+        // only surfaces which actually got painted get their frame callbacks, and only
+        // once the frame is on the screen
+        for (Toplevel *win : m_scene->presentedWindows()) {
+            auto surface = win->surface();
+            if (surface && !m_presentedSurfaces.contains(surface)) {
+                m_presentedSurfaces << surface;
             }
         }
+        m_scene->clearPresentedWindows();
+    }
+    if (!m_bufferSwapPending) {
+        // the backend does not report when the frame is on screen, it is as soon as it got submitted
+        presentFrame(monotonicTime());
     }
 
     compositeTimer.stop(); // stop here to ensure *we* cause the next repaint schedule - not some effect through m_scene->paint()
@@ -748,6 +766,18 @@ void Compositor::performCompositing()
     }
 }
 
+void Compositor::presentFrame(qint64 timestamp)
+{
+    const auto surfaces = m_presentedSurfaces;
+    m_presentedSurfaces.clear();
+    for (const auto &surface : surfaces) {
+        if (surface) {
+            surface->frameRendered(quint32(timestamp));
+        }
+    }
+    emit framePresented(timestamp);
+}
+
 bool Compositor::windowRepaintsPending() const
 {
     foreach (Toplevel * c, Workspace::self()->clientList())
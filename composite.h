@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define KWIN_COMPOSITE_H
 // KWin
 #include <kwinglobals.h>
+#include "damageregion.h"
 // KDE
 #include <KSelectionOwner>
 // Qt
@@ -30,8 +31,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QElapsedTimer>
 #include <QTimer>
 #include <QBasicTimer>
+#include <QPointer>
 #include <QRegion>
 
+namespace KWayland
+{
+namespace Server
+{
+class SurfaceInterface;
+}
+}
+
 namespace KWin {
 
 class Client;
@@ -182,11 +192,30 @@ public Q_SLOTS:
      * Notifies the compositor that a pending buffer swap has completed.
      */
     void bufferSwapComplete();
+    /**
+     * Notifies the compositor about the time the pending frame got presented, e.g. the
+     * timestamp of the page flip event. The @p timestamp is in milliseconds of the
+     * monotonic clock. Backends knowing the actual presentation time should call this
+     * right before bufferSwapComplete().
+     **/
+    void setPresentationTimestamp(qint64 timestamp);
 
 Q_SIGNALS:
     void compositingToggled(bool active);
     void aboutToDestroy();
     void sceneCreated();
+    /**
+     * Emitted when the Compositor starts a new frame, before the windows are painted.
+     * Work deferred to once per frame should be done when this signal is emitted.
+     **/
+    void aboutToPaintFrame();
+    /**
+     * Emitted when the last painted frame got presented on the outputs. The @p timestamp is
+     * the time of the presentation in milliseconds of the monotonic clock, either reported by
+     * the backend or taken when the frame got submitted. The frame callbacks of the presented
+     * Wayland surfaces are sent with the same timestamp.
+     **/
+    void framePresented(qint64 timestamp);
 
 protected:
     void timerEvent(QTimerEvent *te);
@@ -214,6 +243,7 @@ private:
     void claimCompositorSelection();
     void setCompositeTimer();
     bool windowRepaintsPending() const;
+    void presentFrame(qint64 timestamp);
     /**
      * Continues the startup after Scene And Workspace are created
      **/
@@ -232,7 +262,7 @@ private:
     qint64 vBlankInterval, fpsInterval;
     int m_xrrRefreshRate;
     QElapsedTimer nextPaintReference;
-    QRegion repaints_region;
+    DamageRegion repaints_region;
 
     QTimer unredirectTimer;
     bool forceUnredirectCheck;
@@ -240,10 +270,12 @@ private:
     bool m_finishing; // finish() sets this variable while shutting down
     bool m_starting; // start() sets this variable while starting
     qint64 m_timeSinceLastVBlank;
-    qint64 m_timeSinceStart = 0;
     Scene *m_scene;
     bool m_bufferSwapPending;
     bool m_composeAtSwapCompletion;
+    // surfaces presented in the last frame, waiting for the frame to be on screen
+    QVector<QPointer<KWayland::Server::SurfaceInterface>> m_presentedSurfaces;
+    qint64 m_presentationTimestamp = -1;
 
     KWIN_SINGLETON_VARIABLE(Compositor, s_compositor)
 };
@@ -0,0 +1,198 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "damageregion.h"
+
+namespace KWin
+{
+
+static const int s_defaultMaximumRects = 16;
+static int s_maximumRects = -1;
+
+static inline qint64 area(const QRect &rect)
+{
+    return qint64(rect.width()) * qint64(rect.height());
+}
+
+/**
+ * Two rectangles get merged if the united rectangle does not add more than a quarter
+ * of the covered area, plus some slack so that tiny rectangles close to each other
+ * (e.g. glyphs while typing) end up in one rectangle.
+ **/
+static inline bool shouldMerge(const QRect &a, const QRect &b)
+{
+    const qint64 covered = area(a) + area(b) - area(a & b);
+    const qint64 waste = area(a | b) - covered;
+    return waste <= covered / 4 + 1024;
+}
+
+DamageRegion::DamageRegion() = default;
+
+DamageRegion::DamageRegion(const QRect &rect)
+{
+    add(rect);
+}
+
+DamageRegion::DamageRegion(const QRegion &region)
+{
+    add(region);
+}
+
+int DamageRegion::maximumRects()
+{
+    if (s_maximumRects < 0) {
+        bool ok = false;
+        const int count = qgetenv("KWIN_MAX_DAMAGE_RECTS").toInt(&ok);
+        s_maximumRects = (ok && count > 0) ? count : s_defaultMaximumRects;
+    }
+    return s_maximumRects;
+}
+
+void DamageRegion::setMaximumRects(int count)
+{
+    s_maximumRects = qMax(1, count);
+}
+
+void DamageRegion::clear()
+{
+    m_rects.clear();
+    m_boundingRect = QRect();
+}
+
+bool DamageRegion::intersects(const QRect &rect) const
+{
+    if (!m_boundingRect.intersects(rect)) {
+        return false;
+    }
+    for (const QRect &r : m_rects) {
+        if (r.intersects(rect)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QRegion DamageRegion::toRegion() const
+{
+    if (m_rects.count() == 1) {
+        return QRegion(m_rects.first());
+    }
+    QRegion region;
+    for (const QRect &r : m_rects) {
+        region += r;
+    }
+    return region;
+}
+
+void DamageRegion::add(const QRect &rect)
+{
+    if (rect.isEmpty()) {
+        return;
+    }
+    if (m_boundingRect.contains(rect) && m_rects.count() == 1) {
+        // collapsed to the bounding rect
+        return;
+    }
+    QRect united = rect;
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < m_rects.count(); ++i) {
+            const QRect &existing = m_rects.at(i);
+            if (existing.contains(united)) {
+                if (united == rect) {
+                    // damage is already covered
+                    return;
+                }
+                // a merged rect ended up inside another rect, keep the bigger one
+                united = existing;
+                m_rects.remove(i);
+                merged = true;
+                break;
+            }
+            if (united.contains(existing) || shouldMerge(existing, united)) {
+                united |= existing;
+                m_rects.remove(i);
+                merged = true;
+                break;
+            }
+        }
+    }
+    m_boundingRect |= united;
+    if (m_rects.count() >= maximumRects()) {
+        m_rects.clear();
+        m_rects.append(m_boundingRect);
+        return;
+    }
+    m_rects.append(united);
+}
+
+void DamageRegion::add(const QRegion &region)
+{
+    if (region.rectCount() == 1) {
+        add(region.boundingRect());
+        return;
+    }
+    const auto rects = region.rects();
+    for (const QRect &r : rects) {
+        add(r);
+    }
+}
+
+void DamageRegion::add(const DamageRegion &other)
+{
+    if (isEmpty()) {
+        *this = other;
+        return;
+    }
+    for (const QRect &r : other.m_rects) {
+        add(r);
+    }
+}
+
+void DamageHistory::add(const QRegion &damage)
+{
+    m_head = (m_head + 1) % MaximumBufferAge;
+    m_ring[m_head] = DamageRegion(damage);
+    m_count = qMin(m_count + 1, int(MaximumBufferAge));
+}
+
+void DamageHistory::clear()
+{
+    for (int i = 0; i < MaximumBufferAge; ++i) {
+        m_ring[i].clear();
+    }
+    m_head = 0;
+    m_count = 0;
+}
+
+QRegion DamageHistory::accumulate(int bufferAge, const QRect &fullRepaint) const
+{
+    // Note: An age of zero means the buffer contents are undefined
+    if (bufferAge <= 0 || bufferAge > m_count) {
+        return fullRepaint;
+    }
+    DamageRegion damage;
+    for (int i = 0; i < bufferAge - 1; ++i) {
+        damage += m_ring[(m_head - i + MaximumBufferAge) % MaximumBufferAge];
+    }
+    return damage.toRegion();
+}
+
+}
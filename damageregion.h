@@ -0,0 +1,136 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_DAMAGEREGION_H
+#define KWIN_DAMAGEREGION_H
+
+#include <kwin_export.h>
+
+#include <QRect>
+#include <QRegion>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * @brief Container for accumulating damage.
+ *
+ * In contrast to QRegion, which keeps its rectangles y-x banded and has to
+ * re-band on every union, the DamageRegion is a bounded list of rectangles.
+ * Adding a rectangle drops it if it is already covered, absorbs covered
+ * rectangles and merges it with a neighbour if the union does not waste
+ * much area. Once more than maximumRects() rectangles are tracked the
+ * region collapses to its bounding rectangle.
+ *
+ * The result is a superset of the added damage, which is all the compositor
+ * needs. Conversion to QRegion is only done once per frame through toRegion().
+ **/
+class KWIN_EXPORT DamageRegion
+{
+public:
+    DamageRegion();
+    DamageRegion(const QRect &rect);
+    DamageRegion(const QRegion &region);
+
+    bool isEmpty() const {
+        return m_rects.isEmpty();
+    }
+    /**
+     * @returns the bounding rectangle of all damage
+     **/
+    const QRect &boundingRect() const {
+        return m_boundingRect;
+    }
+    /**
+     * @returns the tracked rectangles, they might overlap
+     **/
+    const QVector<QRect> &rects() const {
+        return m_rects;
+    }
+    bool intersects(const QRect &rect) const;
+    QRegion toRegion() const;
+
+    void clear();
+    void add(const QRect &rect);
+    void add(const QRegion &region);
+    void add(const DamageRegion &other);
+
+    DamageRegion &operator+=(const QRect &rect) {
+        add(rect);
+        return *this;
+    }
+    DamageRegion &operator+=(const QRegion &region) {
+        add(region);
+        return *this;
+    }
+    DamageRegion &operator+=(const DamageRegion &other) {
+        add(other);
+        return *this;
+    }
+
+    /**
+     * The maximum number of rectangles a DamageRegion tracks before collapsing
+     * to the bounding rectangle. Defaults to 16, can be overridden through the
+     * environment variable KWIN_MAX_DAMAGE_RECTS.
+     **/
+    static int maximumRects();
+    static void setMaximumRects(int count);
+
+private:
+    QVector<QRect> m_rects;
+    QRect m_boundingRect;
+};
+
+/**
+ * @brief Ring of the damage of the last frames, used to repair buffers with a known age.
+ *
+ * Each output rendering with buffer age support should keep its own history.
+ **/
+class KWIN_EXPORT DamageHistory
+{
+public:
+    /**
+     * The oldest buffer age which can be repaired from the history.
+     **/
+    static const int MaximumBufferAge = 10;
+
+    /**
+     * Adds the @p damage of the frame which just got presented.
+     **/
+    void add(const QRegion &damage);
+    void clear();
+    int count() const {
+        return m_count;
+    }
+    /**
+     * @returns the region which needs to be repainted in a buffer of @p bufferAge,
+     * or @p fullRepaint if the history does not cover that age.
+     **/
+    QRegion accumulate(int bufferAge, const QRect &fullRepaint) const;
+
+private:
+    DamageRegion m_ring[MaximumBufferAge];
+    int m_head = 0;
+    int m_count = 0;
+};
+
+}
+
+#endif
@@ -30,11 +30,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "placement.h"
 #include "kwinadaptor.h"
 #include "scene.h"
+#include "tracing.h"
 #include "workspace.h"
 #include "virtualdesktops.h"
 #ifdef KWIN_BUILD_ACTIVITIES
 #include "activities.h"
 #endif
+#if HAVE_INPUT
+#include "libinput/connection.h"
+#endif
 
 // Qt
 #include <QOpenGLContext>
@@ -256,4 +260,83 @@ QStringList CompositorDBusInterface::supportedOpenGLPlatformInterfaces() const
     return interfaces;
 }
 
+InputLatencyDBusInterface::InputLatencyDBusInterface(LibInput::Connection *connection, QObject *parent)
+    : QObject(parent)
+    , m_connection(connection)
+{
+    QDBusConnection::sessionBus().registerObject(QStringLiteral("/InputLatency"), this, QDBusConnection::ExportAllSlots);
+}
+
+InputLatencyDBusInterface::~InputLatencyDBusInterface()
+{
+    QDBusConnection::sessionBus().unregisterObject(QStringLiteral("/InputLatency"));
+}
+
+QVariantMap InputLatencyDBusInterface::histogram() const
+{
+    QVariantMap histogram;
+#if HAVE_INPUT
+    const LibInput::LatencyHistogram &latency = m_connection->latencyHistogram();
+    for (int i = 0; i < LibInput::LatencyHistogram::BucketCount; ++i) {
+        const QString key = (i == LibInput::LatencyHistogram::BucketCount - 1)
+            ? QStringLiteral("inf")
+            : QString::number(LibInput::LatencyHistogram::upperBound(i));
+        histogram.insert(key, latency.bucket(i));
+    }
+#endif
+    return histogram;
+}
+
+uint InputLatencyDBusInterface::eventCount() const
+{
+#if HAVE_INPUT
+    return m_connection->latencyHistogram().count();
+#else
+    return 0;
+#endif
+}
+
+void InputLatencyDBusInterface::reset()
+{
+#if HAVE_INPUT
+    m_connection->latencyHistogram().reset();
+#endif
+}
+
+TracingDBusInterface::TracingDBusInterface(QObject *parent)
+    : QObject(parent)
+{
+    QDBusConnection::sessionBus().registerObject(QStringLiteral("/Tracing"), this, QDBusConnection::ExportAllSlots);
+}
+
+TracingDBusInterface::~TracingDBusInterface()
+{
+    QDBusConnection::sessionBus().unregisterObject(QStringLiteral("/Tracing"));
+}
+
+void TracingDBusInterface::start()
+{
+    Tracing::setEnabled(true);
+}
+
+void TracingDBusInterface::stop()
+{
+    Tracing::setEnabled(false);
+}
+
+bool TracingDBusInterface::isEnabled() const
+{
+    return Tracing::isEnabled();
+}
+
+uint TracingDBusInterface::eventCount() const
+{
+    return Tracing::eventCount();
+}
+
+bool TracingDBusInterface::dump(const QString &fileName)
+{
+    return Tracing::dump(fileName);
+}
+
 } // namespace
@@ -28,6 +28,10 @@ namespace KWin
 {
 
 class Compositor;
+namespace LibInput
+{
+class Connection;
+}
 
 /**
  * @brief This class is a wrapper for the org.kde.KWin D-Bus interface.
@@ -163,6 +167,76 @@ private:
     Compositor *m_compositor;
 };
 
+/**
+ * @brief Exports the latency of the input events read through libinput as object /InputLatency.
+ *
+ * The latency is measured from the kernel timestamp of an event till the event got
+ * delivered to the input filters.
+ **/
+class InputLatencyDBusInterface : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.kwin.InputLatency")
+public:
+    explicit InputLatencyDBusInterface(LibInput::Connection *connection, QObject *parent);
+    virtual ~InputLatencyDBusInterface();
+
+public Q_SLOTS:
+    /**
+     * @brief The number of delivered input events per latency bucket.
+     *
+     * The key is the exclusive upper bound of the bucket in milliseconds,
+     * @c inf for the last bucket.
+     **/
+    QVariantMap histogram() const;
+    /**
+     * @brief The number of input events in the histogram.
+     **/
+    uint eventCount() const;
+    /**
+     * @brief Clears the histogram.
+     **/
+    void reset();
+
+private:
+    LibInput::Connection *m_connection;
+};
+
+/**
+ * @brief Controls the frame timeline tracing, exported as object /Tracing.
+ *
+ * @see Tracing
+ **/
+class TracingDBusInterface : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.kwin.Tracing")
+public:
+    explicit TracingDBusInterface(QObject *parent);
+    virtual ~TracingDBusInterface();
+
+public Q_SLOTS:
+    /**
+     * @brief Discards the recorded events and starts recording.
+     **/
+    void start();
+    /**
+     * @brief Stops recording, the recorded events are kept till the next start.
+     **/
+    void stop();
+    bool isEnabled() const;
+    /**
+     * @brief The number of recorded events of all threads.
+     **/
+    uint eventCount() const;
+    /**
+     * @brief Writes the recorded events in the Chrome trace event format to @p fileName.
+     *
+     * The file can be loaded in chrome://tracing or Perfetto.
+     **/
+    bool dump(const QString &fileName);
+};
+
 } // namespace
 
 #endif // KWIN_DBUS_INTERFACE_H
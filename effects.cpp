@@ -43,6 +43,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "thumbnailitem.h"
 #include "virtualdesktops.h"
 #include "workspace.h"
+#include "tracing.h"
 #include "kwinglutils.h"
 
 #include <QDebug>
@@ -51,6 +52,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDBusServiceWatcher>
 #include <QDBusPendingCallWatcher>
 
+#include <KConfigGroup>
 #include <Plasma/Theme>
 
 #include <assert.h>
@@ -312,7 +314,18 @@ EffectsHandlerImpl::EffectsHandlerImpl(Compositor *compositor, Scene *scene)
             }
         );
     }
-    reconfigure();
+    if (kwinApp()->config()->group("Compositing").readEntry("LoadEffectsAfterFirstFrame", false)) {
+        // The effects are not needed to get the first frame on screen, so loading them
+        // (and compiling their shaders) can be postponed till that frame got presented.
+        m_deferredLoading = connect(m_compositor, &Compositor::framePresented, this,
+            [this] {
+                disconnect(m_deferredLoading);
+                reconfigure();
+            }
+        );
+    } else {
+        reconfigure();
+    }
 }
 
 EffectsHandlerImpl::~EffectsHandlerImpl()
@@ -407,20 +420,25 @@ void EffectsHandlerImpl::reconfigure()
 // the idea is that effects call this function again which calls the next one
 void EffectsHandlerImpl::prePaintScreen(ScreenPrePaintData& data, int time)
 {
-    if (m_currentPaintScreenIterator != m_activeEffects.constEnd()) {
-        (*m_currentPaintScreenIterator++)->prePaintScreen(data, time);
-        --m_currentPaintScreenIterator;
+    const EffectsIterator saved = m_prePaintScreenChain.current;
+    KWIN_TRACE_IF(saved == m_prePaintScreenChain.effects.constBegin(), "effects", "prePaintScreen");
+    if (Effect *e = m_prePaintScreenChain.next()) {
+        e->prePaintScreen(data, time);
     }
+    m_prePaintScreenChain.current = saved;
     // no special final code
 }
 
 void EffectsHandlerImpl::paintScreen(int mask, QRegion region, ScreenPaintData& data)
 {
-    if (m_currentPaintScreenIterator != m_activeEffects.constEnd()) {
-        (*m_currentPaintScreenIterator++)->paintScreen(mask, region, data);
-        --m_currentPaintScreenIterator;
-    } else
+    const EffectsIterator saved = m_paintScreenChain.current;
+    KWIN_TRACE_IF(saved == m_paintScreenChain.effects.constBegin(), "effects", "paintScreen");
+    if (Effect *e = m_paintScreenChain.next()) {
+        e->paintScreen(mask, region, data);
+    } else {
         m_scene->finalPaintScreen(mask, region, data);
+    }
+    m_paintScreenChain.current = saved;
 }
 
 void EffectsHandlerImpl::paintDesktop(int desktop, int mask, QRegion region, ScreenPaintData &data)
@@ -431,58 +449,68 @@ void EffectsHandlerImpl::paintDesktop(int desktop, int mask, QRegion region, Scr
     m_currentRenderedDesktop = desktop;
     m_desktopRendering = true;
     // save the paint screen iterator
-    EffectsIterator savedIterator = m_currentPaintScreenIterator;
-    m_currentPaintScreenIterator = m_activeEffects.constBegin();
+    EffectsIterator savedIterator = m_paintScreenChain.current;
+    m_paintScreenChain.reset();
     effects->paintScreen(mask, region, data);
     // restore the saved iterator
-    m_currentPaintScreenIterator = savedIterator;
+    m_paintScreenChain.current = savedIterator;
     m_desktopRendering = false;
 }
 
 void EffectsHandlerImpl::postPaintScreen()
 {
-    if (m_currentPaintScreenIterator != m_activeEffects.constEnd()) {
-        (*m_currentPaintScreenIterator++)->postPaintScreen();
-        --m_currentPaintScreenIterator;
+    const EffectsIterator saved = m_postPaintScreenChain.current;
+    KWIN_TRACE_IF(saved == m_postPaintScreenChain.effects.constBegin(), "effects", "postPaintScreen");
+    if (Effect *e = m_postPaintScreenChain.next()) {
+        e->postPaintScreen();
     }
+    m_postPaintScreenChain.current = saved;
     // no special final code
 }
 
 void EffectsHandlerImpl::prePaintWindow(EffectWindow* w, WindowPrePaintData& data, int time)
 {
-    if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
-        (*m_currentPaintWindowIterator++)->prePaintWindow(w, data, time);
-        --m_currentPaintWindowIterator;
+    const EffectsIterator saved = m_prePaintWindowChain.current;
+    KWIN_TRACE_IF(saved == m_prePaintWindowChain.effects.constBegin(), "effects", "prePaintWindow");
+    if (Effect *e = m_prePaintWindowChain.nextForWindow(w)) {
+        e->prePaintWindow(w, data, time);
     }
+    m_prePaintWindowChain.current = saved;
     // no special final code
 }
 
 void EffectsHandlerImpl::paintWindow(EffectWindow* w, int mask, QRegion region, WindowPaintData& data)
 {
-    if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
-        (*m_currentPaintWindowIterator++)->paintWindow(w, mask, region, data);
-        --m_currentPaintWindowIterator;
-    } else
+    const EffectsIterator saved = m_paintWindowChain.current;
+    KWIN_TRACE_IF(saved == m_paintWindowChain.effects.constBegin(), "effects", "paintWindow");
+    if (Effect *e = m_paintWindowChain.nextForWindow(w)) {
+        e->paintWindow(w, mask, region, data);
+    } else {
         m_scene->finalPaintWindow(static_cast<EffectWindowImpl*>(w), mask, region, data);
+    }
+    m_paintWindowChain.current = saved;
 }
 
 void EffectsHandlerImpl::paintEffectFrame(EffectFrame* frame, QRegion region, double opacity, double frameOpacity)
 {
-    if (m_currentPaintEffectFrameIterator != m_activeEffects.constEnd()) {
-        (*m_currentPaintEffectFrameIterator++)->paintEffectFrame(frame, region, opacity, frameOpacity);
-        --m_currentPaintEffectFrameIterator;
+    const EffectsIterator saved = m_paintEffectFrameChain.current;
+    if (Effect *e = m_paintEffectFrameChain.next()) {
+        e->paintEffectFrame(frame, region, opacity, frameOpacity);
     } else {
         const EffectFrameImpl* frameImpl = static_cast<const EffectFrameImpl*>(frame);
         frameImpl->finalRender(region, opacity, frameOpacity);
     }
+    m_paintEffectFrameChain.current = saved;
 }
 
 void EffectsHandlerImpl::postPaintWindow(EffectWindow* w)
 {
-    if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
-        (*m_currentPaintWindowIterator++)->postPaintWindow(w);
-        --m_currentPaintWindowIterator;
+    const EffectsIterator saved = m_postPaintWindowChain.current;
+    KWIN_TRACE_IF(saved == m_postPaintWindowChain.effects.constBegin(), "effects", "postPaintWindow");
+    if (Effect *e = m_postPaintWindowChain.nextForWindow(w)) {
+        e->postPaintWindow(w);
     }
+    m_postPaintWindowChain.current = saved;
     // no special final code
 }
 
@@ -496,11 +524,15 @@ Effect *EffectsHandlerImpl::provides(Effect::Feature ef)
 
 void EffectsHandlerImpl::drawWindow(EffectWindow* w, int mask, QRegion region, WindowPaintData& data)
 {
-    if (m_currentDrawWindowIterator != m_activeEffects.constEnd()) {
-        (*m_currentDrawWindowIterator++)->drawWindow(w, mask, region, data);
-        --m_currentDrawWindowIterator;
-    } else
+    const EffectsIterator saved = m_drawWindowChain.current;
+    KWIN_TRACE_IF(saved == m_drawWindowChain.effects.constBegin(), "effects", "drawWindow");
+    if (Effect *e = m_drawWindowChain.nextForWindow(w)) {
+        e->drawWindow(w, mask, region, data);
+    } else {
+        m_scene->addPresentedWindow(static_cast<EffectWindowImpl*>(w)->window());
         m_scene->finalDrawWindow(static_cast<EffectWindowImpl*>(w), mask, region, data);
+    }
+    m_drawWindowChain.current = saved;
 }
 
 void EffectsHandlerImpl::buildQuads(EffectWindow* w, WindowQuadList& quadList)
@@ -538,15 +570,61 @@ void EffectsHandlerImpl::startPaint()
 {
     m_activeEffects.clear();
     m_activeEffects.reserve(loaded_effects.count());
+    clearEffectChains();
     for(QVector< KWin::EffectPair >::const_iterator it = loaded_effects.constBegin(); it != loaded_effects.constEnd(); ++it) {
-        if (it->second->isActive()) {
-            m_activeEffects << it->second;
+        Effect *effect = it->second;
+        if (!effect->isActive()) {
+            continue;
+        }
+        m_activeEffects << effect;
+        // only put the effect into the chains it actually hooks into, this keeps the
+        // per window chains short if most active effects only paint on screen level
+        const Effect::PaintHooks hooks = effect->paintHooks();
+        if (hooks.testFlag(Effect::PrePaintScreenHook)) {
+            m_prePaintScreenChain.effects << effect;
+        }
+        if (hooks.testFlag(Effect::PaintScreenHook)) {
+            m_paintScreenChain.effects << effect;
+        }
+        if (hooks.testFlag(Effect::PostPaintScreenHook)) {
+            m_postPaintScreenChain.effects << effect;
+        }
+        if (hooks.testFlag(Effect::PrePaintWindowHook)) {
+            m_prePaintWindowChain.effects << effect;
+        }
+        if (hooks.testFlag(Effect::PaintWindowHook)) {
+            m_paintWindowChain.effects << effect;
+        }
+        if (hooks.testFlag(Effect::PostPaintWindowHook)) {
+            m_postPaintWindowChain.effects << effect;
+        }
+        if (hooks.testFlag(Effect::DrawWindowHook)) {
+            m_drawWindowChain.effects << effect;
+        }
+        if (hooks.testFlag(Effect::PaintEffectFrameHook)) {
+            m_paintEffectFrameChain.effects << effect;
         }
     }
-    m_currentDrawWindowIterator = m_activeEffects.constBegin();
-    m_currentPaintWindowIterator = m_activeEffects.constBegin();
-    m_currentPaintScreenIterator = m_activeEffects.constBegin();
-    m_currentPaintEffectFrameIterator = m_activeEffects.constBegin();
+    m_prePaintScreenChain.reset();
+    m_paintScreenChain.reset();
+    m_postPaintScreenChain.reset();
+    m_prePaintWindowChain.reset();
+    m_paintWindowChain.reset();
+    m_postPaintWindowChain.reset();
+    m_drawWindowChain.reset();
+    m_paintEffectFrameChain.reset();
+}
+
+void EffectsHandlerImpl::clearEffectChains()
+{
+    m_prePaintScreenChain.clear();
+    m_paintScreenChain.clear();
+    m_postPaintScreenChain.clear();
+    m_prePaintWindowChain.clear();
+    m_paintWindowChain.clear();
+    m_postPaintWindowChain.clear();
+    m_drawWindowChain.clear();
+    m_paintEffectFrameChain.clear();
 }
 
 void EffectsHandlerImpl::slotClientMaximized(KWin::AbstractClient *c, MaximizeMode maxMode)
@@ -1491,6 +1569,9 @@ void EffectsHandlerImpl::effectsChanged()
 {
     loaded_effects.clear();
     m_activeEffects.clear(); // it's possible to have a reconfigure and a quad rebuild between two paint cycles - bug #308201
+    clearEffectChains();
+    // the cached window quads might have been built by effects which are no longer loaded
+    m_scene->discardQuads();
 //    qDebug() << "Recreating effects' list:";
     for (const EffectPair & effect : effect_order) {
 //        qDebug() << effect.first;
@@ -1602,11 +1683,6 @@ EffectWindowImpl::EffectWindowImpl(Toplevel *toplevel)
 
 EffectWindowImpl::~EffectWindowImpl()
 {
-    QVariant cachedTextureVariant = data(LanczosCacheRole);
-    if (cachedTextureVariant.isValid()) {
-        GLTexture *cachedTexture = static_cast< GLTexture*>(cachedTextureVariant.value<void*>());
-        delete cachedTexture;
-    }
 }
 
 bool EffectWindowImpl::isPaintingEnabled()
@@ -265,6 +265,7 @@ protected:
     void connectNotify(const QMetaMethod &signal) override;
     void disconnectNotify(const QMetaMethod &signal) override;
     void effectsChanged();
+    void clearEffectChains();
     void setupAbstractClientConnections(KWin::AbstractClient *c);
     void setupClientConnections(KWin::Client *c);
     void setupUnmanagedConnections(KWin::Unmanaged *u);
@@ -279,11 +280,47 @@ protected:
 private:
     typedef QVector< Effect*> EffectsList;
     typedef EffectsList::const_iterator EffectsIterator;
+    /**
+     * The active Effects reimplementing one of the chained paint methods together with the
+     * position of the next Effect to invoke in the chain.
+     **/
+    class EffectChain
+    {
+    public:
+        EffectChain()
+            : current(effects.constBegin()) {
+        }
+        void clear() {
+            effects.clear();
+            reset();
+        }
+        void reset() {
+            current = effects.constBegin();
+        }
+        Effect *next() {
+            return current != effects.constEnd() ? *current++ : nullptr;
+        }
+        Effect *nextForWindow(EffectWindow *w) {
+            while (current != effects.constEnd()) {
+                Effect *e = *current++;
+                if (e->isActiveForWindow(w)) {
+                    return e;
+                }
+            }
+            return nullptr;
+        }
+        EffectsList effects;
+        EffectsIterator current;
+    };
     EffectsList m_activeEffects;
-    EffectsIterator m_currentDrawWindowIterator;
-    EffectsIterator m_currentPaintWindowIterator;
-    EffectsIterator m_currentPaintEffectFrameIterator;
-    EffectsIterator m_currentPaintScreenIterator;
+    EffectChain m_prePaintScreenChain;
+    EffectChain m_paintScreenChain;
+    EffectChain m_postPaintScreenChain;
+    EffectChain m_prePaintWindowChain;
+    EffectChain m_paintWindowChain;
+    EffectChain m_postPaintWindowChain;
+    EffectChain m_drawWindowChain;
+    EffectChain m_paintEffectFrameChain;
     EffectsIterator m_currentBuildQuadsIterator;
     typedef QHash< QByteArray, QList< Effect*> > PropertyEffectMap;
     PropertyEffectMap m_propertiesForEffects;
@@ -296,6 +333,7 @@ private:
     Xcb::Window m_mouseInterceptionWindow;
     QList<Effect*> m_grabbedMouseEffects;
     EffectLoader *m_effectLoader;
+    QMetaObject::Connection m_deferredLoading;
     int m_trackingCursorChanges;
 };
 
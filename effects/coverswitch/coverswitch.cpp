@@ -53,6 +53,7 @@ CoverSwitchEffect::CoverSwitchEffect()
     , captionFrame(NULL)
     , primaryTabBox(false)
     , secondaryTabBox(false)
+    , m_reflectionShader(NULL)
 {
     reconfigure(ReconfigureAll);
 
@@ -60,11 +61,6 @@ CoverSwitchEffect::CoverSwitchEffect()
     captionFont.setBold(true);
     captionFont.setPointSize(captionFont.pointSize() * 2);
 
-    if (effects->compositingType() == OpenGL2Compositing) {
-        m_reflectionShader = ShaderManager::instance()->generateShaderFromResources(ShaderTrait::MapTexture, QString(), QStringLiteral("coverswitch-reflection.glsl"));
-    } else {
-        m_reflectionShader = NULL;
-    }
     connect(effects, SIGNAL(windowClosed(KWin::EffectWindow*)), this, SLOT(slotWindowClosed(KWin::EffectWindow*)));
     connect(effects, SIGNAL(tabBoxAdded(int)), this, SLOT(slotTabBoxAdded(int)));
     connect(effects, SIGNAL(tabBoxClosed()), this, SLOT(slotTabBoxClosed()));
@@ -116,6 +112,13 @@ void CoverSwitchEffect::reconfigure(ReconfigureFlags)
 void CoverSwitchEffect::prePaintScreen(ScreenPrePaintData& data, int time)
 {
     if (mActivated || stop || stopRequested) {
+        if (!m_reflectionShaderLoaded) {
+            // created on first use, the reflection is not needed before the tabbox is shown
+            m_reflectionShaderLoaded = true;
+            if (effects->compositingType() == OpenGL2Compositing) {
+                m_reflectionShader = ShaderManager::instance()->generateShaderFromResources(ShaderTrait::MapTexture, QString(), QStringLiteral("coverswitch-reflection.glsl"));
+            }
+        }
         data.mask |= Effect::PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS;
         if (animation || start || stop) {
             timeLine.setCurrentTime(timeLine.currentTime() + time);
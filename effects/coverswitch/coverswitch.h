@@ -157,6 +157,7 @@ private:
     bool secondaryTabBox;
 
     GLShader *m_reflectionShader;
+    bool m_reflectionShaderLoaded = false;
     QMatrix4x4 m_projectionMatrix;
     QMatrix4x4 m_modelviewMatrix;
 };
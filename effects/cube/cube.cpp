@@ -86,6 +86,8 @@ CubeEffect::CubeEffect()
     , useShaders(false)
     , cylinderShader(0)
     , sphereShader(0)
+    , m_reflectionShader(NULL)
+    , m_capShader(NULL)
     , zOrderingFactor(0.0f)
     , mAddedHeightCoeff1(0.0f)
     , mAddedHeightCoeff2(0.0f)
@@ -95,13 +97,6 @@ CubeEffect::CubeEffect()
     desktopNameFont.setBold(true);
     desktopNameFont.setPointSize(14);
 
-    if (effects->compositingType() == OpenGL2Compositing) {
-        m_reflectionShader = ShaderManager::instance()->generateShaderFromResources(ShaderTrait::MapTexture, QString(), QStringLiteral("cube-reflection.glsl"));
-        m_capShader = ShaderManager::instance()->generateShaderFromResources(ShaderTrait::MapTexture, QString(), QStringLiteral("cube-cap.glsl"));
-    } else {
-        m_reflectionShader = NULL;
-        m_capShader = NULL;
-    }
     m_textureMirrorMatrix.scale(1.0, -1.0, 1.0);
     m_textureMirrorMatrix.translate(0.0, -1.0, 0.0);
     connect(effects, SIGNAL(tabBoxAdded(int)), this, SLOT(slotTabBoxAdded(int)));
@@ -282,6 +277,24 @@ void CubeEffect::slotWallPaperLoaded()
     watcher->deleteLater();
 }
 
+void CubeEffect::loadCubeShaders()
+{
+    // the shaders are only created on first activation, most sessions never show the cube
+    if (m_shadersLoaded) {
+        return;
+    }
+    m_shadersLoaded = true;
+    if (effects->compositingType() != OpenGL2Compositing) {
+        return;
+    }
+    m_reflectionShader = ShaderManager::instance()->generateShaderFromResources(ShaderTrait::MapTexture, QString(), QStringLiteral("cube-reflection.glsl"));
+    m_capShader = ShaderManager::instance()->generateShaderFromResources(ShaderTrait::MapTexture, QString(), QStringLiteral("cube-cap.glsl"));
+    if (m_capShader->isValid()) {
+        ShaderBinder binder(m_capShader);
+        m_capShader->setUniform(GLShader::Color, capColor);
+    }
+}
+
 bool CubeEffect::loadShader()
 {
     effects->makeOpenGLContextCurrent();
@@ -318,6 +331,7 @@ bool CubeEffect::loadShader()
 void CubeEffect::prePaintScreen(ScreenPrePaintData& data, int time)
 {
     if (activated) {
+        loadCubeShaders();
         data.mask |= PAINT_SCREEN_TRANSFORMED | Effect::PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS | PAINT_SCREEN_BACKGROUND_FIRST;
 
         if (rotating || start || stop) {
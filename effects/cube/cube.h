@@ -164,6 +164,7 @@ private:
     void paintCylinderCap();
     void paintSphereCap();
     bool loadShader();
+    void loadCubeShaders();
     void rotateCube();
     void rotateToDesktop(int desktop);
     void setActive(bool active);
@@ -223,6 +224,7 @@ private:
     GLShader* sphereShader;
     GLShader* m_reflectionShader;
     GLShader* m_capShader;
+    bool m_shadersLoaded = false;
     float capDeformationFactor;
     bool useZOrdering;
     float zOrderingFactor;
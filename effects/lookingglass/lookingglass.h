@@ -48,6 +48,9 @@ public:
     virtual void prePaintScreen(ScreenPrePaintData& data, int time);
     void paintScreen(int mask, QRegion region, ScreenPaintData &data) override;
     virtual bool isActive() const;
+    PaintHooks paintHooks() const override {
+        return PrePaintScreenHook | PaintScreenHook;
+    }
 
     static bool supported();
 
@@ -45,6 +45,9 @@ public:
     virtual void paintScreen(int mask, QRegion region, ScreenPaintData& data);
     virtual void postPaintScreen();
     virtual bool isActive() const;
+    PaintHooks paintHooks() const override {
+        return ScreenPaintHooks;
+    }
     static bool supported();
 
     // for properties
@@ -106,6 +106,9 @@ public:
     virtual void paintScreen(int mask, QRegion region, ScreenPaintData& data);
     virtual void postPaintScreen();
     virtual bool isActive() const;
+    PaintHooks paintHooks() const override {
+        return ScreenPaintHooks;
+    }
 
     // for properties
     QColor color1() const {
@@ -42,6 +42,9 @@ public:
     virtual void reconfigure(ReconfigureFlags);
     virtual void paintScreen(int mask, QRegion region, ScreenPaintData& data);
     virtual bool isActive() const;
+    PaintHooks paintHooks() const override {
+        return PaintScreenHook;
+    }
 
     // for properties
     int configuredWidth() const {
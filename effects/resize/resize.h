@@ -39,6 +39,12 @@ public:
         return ef == Effect::Resize;
     }
     inline bool isActive() const { return m_active || AnimationEffect::isActive(); }
+    PaintHooks paintHooks() const override {
+        return animationPaintHooks();
+    }
+    bool isActiveForWindow(EffectWindow *w) const override {
+        return (m_active && w == m_resizeWindow) || isAnimatedWindow(w);
+    }
     virtual void prePaintScreen(ScreenPrePaintData& data, int time);
     virtual void prePaintWindow(EffectWindow* w, WindowPrePaintData& data, int time);
     virtual void paintWindow(EffectWindow* w, int mask, QRegion region, WindowPaintData& data);
@@ -39,6 +39,9 @@ public:
     virtual void prePaintScreen(ScreenPrePaintData &data, int time);
     virtual void paintScreen(int mask, QRegion region, ScreenPaintData &data);
     virtual bool isActive() const;
+    PaintHooks paintHooks() const override {
+        return PrePaintScreenHook | PaintScreenHook;
+    }
 
     int requestedEffectChainPosition() const override {
         return 90;
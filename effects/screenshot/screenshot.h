@@ -41,6 +41,9 @@ public:
     virtual ~ScreenShotEffect();
     virtual void postPaintScreen();
     virtual bool isActive() const;
+    PaintHooks paintHooks() const override {
+        return PostPaintScreenHook;
+    }
 
     int requestedEffectChainPosition() const override {
         return 50;
@@ -40,6 +40,9 @@ public:
     virtual void prePaintScreen(ScreenPrePaintData &data, int time);
     void paintScreen(int mask, QRegion region, ScreenPaintData &data) override;
     virtual bool isActive() const;
+    PaintHooks paintHooks() const override {
+        return PrePaintScreenHook | PaintScreenHook;
+    }
 
 public Q_SLOTS:
     void slotWindowClosed(KWin::EffectWindow *w);
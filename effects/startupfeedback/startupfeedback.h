@@ -43,6 +43,9 @@ public:
     virtual void paintScreen(int mask, QRegion region, ScreenPaintData& data);
     virtual void postPaintScreen();
     virtual bool isActive() const;
+    PaintHooks paintHooks() const override {
+        return ScreenPaintHooks;
+    }
 
     int requestedEffectChainPosition() const override {
         return 90;
@@ -44,6 +44,9 @@ public:
     virtual void postPaintScreen();
     virtual void reconfigure(ReconfigureFlags);
     virtual bool isActive() const;
+    PaintHooks paintHooks() const override {
+        return ScreenPaintHooks;
+    }
 
     // for properties
     Qt::KeyboardModifiers modifiers() const {
@@ -52,6 +52,9 @@ public:
     virtual void paintScreen(int mask, QRegion region, ScreenPaintData& data);
     virtual void postPaintScreen();
     virtual bool isActive() const;
+    PaintHooks paintHooks() const override {
+        return ScreenPaintHooks;
+    }
     // for properties
     qreal configuredZoomFactor() const {
         return zoomFactor;
@@ -42,6 +42,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "effects.h"
 #include "screenedge.h"
 #include "screens.h"
+#include "tracing.h"
 #include "xcbutils.h"
 
 #include <KDecoration2/Decoration>
@@ -202,6 +203,7 @@ void Workspace::unregisterEventFilter(X11EventFilter *filter)
  */
 bool Workspace::workspaceEvent(xcb_generic_event_t *e)
 {
+    KWIN_TRACE("x11", "workspaceEvent");
     const uint8_t eventType = e->response_type & ~0x80;
     if (!eventType) {
         // let's check whether it's an error from one of the extensions KWin uses
@@ -39,20 +39,97 @@ FocusChain::~FocusChain()
     s_manager = NULL;
 }
 
+void FocusChain::Chain::remove(AbstractClient *client)
+{
+    auto it = m_links.find(client);
+    if (it == m_links.end()) {
+        return;
+    }
+    const Links links = it.value();
+    m_links.erase(it);
+    if (links.previous) {
+        m_links[links.previous].next = links.next;
+    } else {
+        m_first = links.next;
+    }
+    if (links.next) {
+        m_links[links.next].previous = links.previous;
+    } else {
+        m_last = links.previous;
+    }
+}
+
+void FocusChain::Chain::append(AbstractClient *client)
+{
+    Q_ASSERT(!m_links.contains(client));
+    Links links;
+    links.previous = m_last;
+    m_links.insert(client, links);
+    if (m_last) {
+        m_links[m_last].next = client;
+    } else {
+        m_first = client;
+    }
+    m_last = client;
+}
+
+void FocusChain::Chain::prepend(AbstractClient *client)
+{
+    Q_ASSERT(!m_links.contains(client));
+    Links links;
+    links.next = m_first;
+    m_links.insert(client, links);
+    if (m_first) {
+        m_links[m_first].previous = client;
+    } else {
+        m_last = client;
+    }
+    m_first = client;
+}
+
+void FocusChain::Chain::insertBefore(AbstractClient *client, AbstractClient *reference)
+{
+    Q_ASSERT(!m_links.contains(client));
+    Q_ASSERT(m_links.contains(reference));
+    AbstractClient *previous = m_links.value(reference).previous;
+    if (!previous) {
+        prepend(client);
+        return;
+    }
+    insertAfter(client, previous);
+}
+
+void FocusChain::Chain::insertAfter(AbstractClient *client, AbstractClient *reference)
+{
+    Q_ASSERT(!m_links.contains(client));
+    Q_ASSERT(m_links.contains(reference));
+    AbstractClient *next = m_links.value(reference).next;
+    if (!next) {
+        append(client);
+        return;
+    }
+    Links links;
+    links.previous = reference;
+    links.next = next;
+    m_links.insert(client, links);
+    m_links[reference].next = client;
+    m_links[next].previous = client;
+}
+
 void FocusChain::remove(AbstractClient *client)
 {
     for (DesktopChains::iterator it = m_desktopFocusChains.begin();
             it != m_desktopFocusChains.end();
             ++it) {
-        it.value().removeAll(client);
+        it.value().remove(client);
     }
-    m_mostRecentlyUsed.removeAll(client);
+    m_mostRecentlyUsed.remove(client);
 }
 
 void FocusChain::resize(uint previousSize, uint newSize)
 {
     for (uint i = previousSize + 1; i <= newSize; ++i) {
-        m_desktopFocusChains.insert(i, QList<AbstractClient*>());
+        m_desktopFocusChains.insert(i, Chain());
     }
     for (uint i = previousSize; i > newSize; --i) {
         m_desktopFocusChains.remove(i);
@@ -71,8 +148,7 @@ AbstractClient *FocusChain::getForActivation(uint desktop, int screen) const
         return NULL;
     }
     const auto &chain = it.value();
-    for (int i = chain.size() - 1; i >= 0; --i) {
-        auto tmp = chain.at(i);
+    for (auto tmp = chain.last(); tmp; tmp = chain.previous(tmp)) {
         // TODO: move the check into Client
         if (tmp->isShown(false) && tmp->isOnCurrentActivity()
             && ( !m_separateScreenFocus || tmp->screen() == screen)) {
@@ -117,7 +193,7 @@ void FocusChain::update(AbstractClient *client, FocusChain::Change change)
             if (client->isOnDesktop(it.key())) {
                 updateClientInChain(client, change, chain);
             } else {
-                chain.removeAll(client);
+                chain.remove(client);
             }
         }
     }
@@ -126,7 +202,7 @@ void FocusChain::update(AbstractClient *client, FocusChain::Change change)
     updateClientInChain(client, change, m_mostRecentlyUsed);
 }
 
-void FocusChain::updateClientInChain(AbstractClient *client, FocusChain::Change change, QList< AbstractClient * >& chain)
+void FocusChain::updateClientInChain(AbstractClient *client, FocusChain::Change change, Chain &chain)
 {
     if (change == MakeFirst) {
         makeFirstInChain(client, chain);
@@ -137,15 +213,15 @@ void FocusChain::updateClientInChain(AbstractClient *client, FocusChain::Change
     }
 }
 
-void FocusChain::insertClientIntoChain(AbstractClient *client, QList< AbstractClient * >& chain)
+void FocusChain::insertClientIntoChain(AbstractClient *client, Chain &chain)
 {
     if (chain.contains(client)) {
         return;
     }
     if (m_activeClient && m_activeClient != client &&
-            !chain.empty() && chain.last() == m_activeClient) {
+            !chain.isEmpty() && chain.last() == m_activeClient) {
         // Add it after the active client
-        chain.insert(chain.size() - 1, client);
+        chain.insertBefore(client, m_activeClient);
     } else {
         // Otherwise add as the first one
         chain.append(client);
@@ -169,19 +245,19 @@ void FocusChain::moveAfterClient(AbstractClient *client, AbstractClient *referen
     moveAfterClientInChain(client, reference, m_mostRecentlyUsed);
 }
 
-void FocusChain::moveAfterClientInChain(AbstractClient *client, AbstractClient *reference, QList<AbstractClient *> &chain)
+void FocusChain::moveAfterClientInChain(AbstractClient *client, AbstractClient *reference, Chain &chain)
 {
-    if (!chain.contains(reference)) {
+    if (client == reference || !chain.contains(reference)) {
         return;
     }
     if (AbstractClient::belongToSameApplication(reference, client)) {
-        chain.removeAll(client);
-        chain.insert(chain.indexOf(reference), client);
+        chain.remove(client);
+        chain.insertBefore(client, reference);
     } else {
-        chain.removeAll(client);
-        for (int i = chain.size() - 1; i >= 0; --i) {
-            if (AbstractClient::belongToSameApplication(reference, chain.at(i))) {
-                chain.insert(i, client);
+        chain.remove(client);
+        for (auto c = chain.last(); c; c = chain.previous(c)) {
+            if (AbstractClient::belongToSameApplication(reference, c)) {
+                chain.insertBefore(client, c);
                 break;
             }
         }
@@ -201,14 +277,13 @@ AbstractClient *FocusChain::nextMostRecentlyUsed(AbstractClient *reference) cons
     if (m_mostRecentlyUsed.isEmpty()) {
         return NULL;
     }
-    const int index = m_mostRecentlyUsed.indexOf(reference);
-    if (index == -1) {
+    if (!m_mostRecentlyUsed.contains(reference)) {
         return m_mostRecentlyUsed.first();
     }
-    if (index == 0) {
+    if (reference == m_mostRecentlyUsed.first()) {
         return m_mostRecentlyUsed.last();
     }
-    return m_mostRecentlyUsed.at(index - 1);
+    return m_mostRecentlyUsed.previous(reference);
 }
 
 // copied from activation.cpp
@@ -226,8 +301,7 @@ AbstractClient *FocusChain::nextForDesktop(AbstractClient *reference, uint deskt
         return NULL;
     }
     const auto &chain = it.value();
-    for (int i = chain.size() - 1; i >= 0; --i) {
-        auto client = chain.at(i);
+    for (auto client = chain.last(); client; client = chain.previous(client)) {
         if (isUsableFocusCandidate(client, reference)) {
             return client;
         }
@@ -235,13 +309,13 @@ AbstractClient *FocusChain::nextForDesktop(AbstractClient *reference, uint deskt
     return NULL;
 }
 
-void FocusChain::makeFirstInChain(AbstractClient *client, QList< AbstractClient * >& chain)
+void FocusChain::makeFirstInChain(AbstractClient *client, Chain &chain)
 {
-    chain.removeAll(client);
+    chain.remove(client);
     if (client->isMinimized()) { // add it before the first minimized ...
-        for (int i = chain.count()-1; i >= 0; --i) {
-            if (chain.at(i)->isMinimized()) {
-                chain.insert(i+1, client);
+        for (auto c = chain.last(); c; c = chain.previous(c)) {
+            if (c->isMinimized()) {
+                chain.insertAfter(client, c);
                 return;
             }
         }
@@ -251,9 +325,9 @@ void FocusChain::makeFirstInChain(AbstractClient *client, QList< AbstractClient
     }
 }
 
-void FocusChain::makeLastInChain(AbstractClient *client, QList< AbstractClient * >& chain)
+void FocusChain::makeLastInChain(AbstractClient *client, Chain &chain)
 {
-    chain.removeAll(client);
+    chain.remove(client);
     chain.prepend(client);
 }
 
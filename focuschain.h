@@ -37,8 +37,9 @@ class AbstractClient;
  *
  * Internally this FocusChain holds multiple independent chains. There is one chain of most recently
  * used Clients which is primarily used by TabBox to build up the list of Clients for navigation.
- * The chains are organized as a normal QList of Clients with the most recently used Client being the
- * last item of the list, that is a LIFO like structure.
+ * The chains are organized as doubly linked lists of Clients with the most recently used Client being
+ * the last item of the list, that is a LIFO like structure. The links of each Client are indexed, so
+ * that moving a Client to the front, removing it and navigating from it are constant time operations.
  *
  * In addition there is one chain for each virtual desktop which is used to determine which Client
  * should get activated when the user switches to another virtual desktop.
@@ -189,6 +190,64 @@ public Q_SLOTS:
     bool isUsableFocusCandidate(AbstractClient *c, AbstractClient *prev) const;
 
 private:
+    /**
+     * @brief A single focus chain.
+     *
+     * The chain is a doubly linked list of Clients, the first item is the least recently used
+     * Client, the last item the most recently used one. Instead of embedding the links into the
+     * Clients they are kept in a hash, so a Client can be part of any number of chains.
+     **/
+    class Chain
+    {
+    public:
+        bool isEmpty() const {
+            return m_links.isEmpty();
+        }
+        int count() const {
+            return m_links.count();
+        }
+        bool contains(AbstractClient *client) const {
+            return m_links.contains(client);
+        }
+        AbstractClient *first() const {
+            return m_first;
+        }
+        AbstractClient *last() const {
+            return m_last;
+        }
+        /**
+         * @returns the Client directly before @p client, that is the next less recently used one
+         **/
+        AbstractClient *previous(AbstractClient *client) const {
+            return m_links.value(client).previous;
+        }
+        /**
+         * @returns the Client directly after @p client, that is the next more recently used one
+         **/
+        AbstractClient *next(AbstractClient *client) const {
+            return m_links.value(client).next;
+        }
+        void remove(AbstractClient *client);
+        void append(AbstractClient *client);
+        void prepend(AbstractClient *client);
+        /**
+         * Inserts @p client directly before @p reference, @p client must not be in the chain.
+         **/
+        void insertBefore(AbstractClient *client, AbstractClient *reference);
+        /**
+         * Inserts @p client directly after @p reference, @p client must not be in the chain.
+         **/
+        void insertAfter(AbstractClient *client, AbstractClient *reference);
+
+    private:
+        struct Links {
+            AbstractClient *previous = nullptr;
+            AbstractClient *next = nullptr;
+        };
+        QHash<AbstractClient*, Links> m_links;
+        AbstractClient *m_first = nullptr;
+        AbstractClient *m_last = nullptr;
+    };
     /**
      * @brief Makes @p client the first Client in the given focus @p chain.
      *
@@ -199,7 +258,7 @@ private:
      * @param chain The focus chain to operate on
      * @return void
      **/
-    void makeFirstInChain(AbstractClient *client, QList<AbstractClient*> &chain);
+    void makeFirstInChain(AbstractClient *client, Chain &chain);
     /**
      * @brief Makes @p client the last Client in the given focus @p chain.
      *
@@ -210,12 +269,12 @@ private:
      * @param chain The focus chain to operate on
      * @return void
      **/
-    void makeLastInChain(AbstractClient *client, QList<AbstractClient*> &chain);
-    void moveAfterClientInChain(AbstractClient *client, AbstractClient *reference, QList<AbstractClient*> &chain);
-    void updateClientInChain(AbstractClient *client, Change change, QList<AbstractClient*> &chain);
-    void insertClientIntoChain(AbstractClient *client, QList<AbstractClient*> &chain);
-    typedef QHash<uint, QList<AbstractClient*> > DesktopChains;
-    QList<AbstractClient*> m_mostRecentlyUsed;
+    void makeLastInChain(AbstractClient *client, Chain &chain);
+    void moveAfterClientInChain(AbstractClient *client, AbstractClient *reference, Chain &chain);
+    void updateClientInChain(AbstractClient *client, Change change, Chain &chain);
+    void insertClientIntoChain(AbstractClient *client, Chain &chain);
+    typedef QHash<uint, Chain> DesktopChains;
+    Chain m_mostRecentlyUsed;
     DesktopChains m_desktopFocusChains;
     bool m_separateScreenFocus;
     AbstractClient *m_activeClient;
@@ -2847,8 +2847,15 @@ bool Client::isWaitingForMoveResizeSync() const
 
 void AbstractClient::handleMoveResize(int x, int y, int x_root, int y_root)
 {
-    if (isWaitingForMoveResizeSync())
-        return; // we're still waiting for the client or the timeout
+    if (isWaitingForMoveResizeSync()) {
+        // we're still waiting for the client or the timeout, the last position
+        // gets applied once the client caught up
+        m_moveResize.deferredLocal = QPoint(x, y);
+        m_moveResize.deferredGlobal = QPoint(x_root, y_root);
+        m_moveResize.hasDeferredMotion = true;
+        return;
+    }
+    m_moveResize.hasDeferredMotion = false;
 
     const Position mode = moveResizePointerMode();
     if ((mode == PositionCenter && !isMovableAcrossScreens())
@@ -3195,6 +3202,34 @@ void AbstractClient::performMoveResize()
         addRepaintFull();
     positionGeometryTip();
     emit clientStepUserMovedResized(this, moveResizeGeom);
+    if (m_moveResize.hasDeferredMotion && !isWaitingForMoveResizeSync()) {
+        scheduleDeferredMoveResize();
+    }
+}
+
+void AbstractClient::scheduleDeferredMoveResize()
+{
+    if (m_moveResize.deferredMotionScheduled) {
+        return;
+    }
+    m_moveResize.deferredMotionScheduled = true;
+    // don't configure the client more often than the result can be shown
+    if (Compositor::compositing()) {
+        m_moveResize.deferredConnection = connect(Compositor::self(), &Compositor::aboutToPaintFrame,
+                                                  this, &AbstractClient::applyDeferredMoveResize);
+    } else {
+        QTimer::singleShot(0, this, &AbstractClient::applyDeferredMoveResize);
+    }
+}
+
+void AbstractClient::applyDeferredMoveResize()
+{
+    disconnect(m_moveResize.deferredConnection);
+    m_moveResize.deferredMotionScheduled = false;
+    if (!m_moveResize.hasDeferredMotion || !isMoveResize() || isWaitingForMoveResizeSync()) {
+        return;
+    }
+    handleMoveResize(m_moveResize.deferredLocal, m_moveResize.deferredGlobal);
 }
 
 void Client::doPerformMoveResize()
@@ -127,6 +127,20 @@ void GlobalShortcutsManager::init()
     }
 }
 
+void GlobalShortcutsManager::setKGlobalAccelInterface(KGlobalAccelInterface *interface)
+{
+    m_kglobalAccelInterface = interface;
+    // resolve once instead of looking up the method by name on each key press
+    m_checkKeyPressed = QMetaMethod();
+    if (interface) {
+        const QMetaObject *mo = interface->metaObject();
+        const int index = mo->indexOfMethod(QMetaObject::normalizedSignature("checkKeyPressed(int)").constData());
+        if (index != -1) {
+            m_checkKeyPressed = mo->method(index);
+        }
+    }
+}
+
 template <typename T>
 void handleDestroyedAction(QObject *object, T &shortcuts)
 {
@@ -149,6 +163,7 @@ void handleDestroyedAction(QObject *object, T &shortcuts)
 void GlobalShortcutsManager::objectDeleted(QObject *object)
 {
     handleDestroyedAction(object, m_shortcuts);
+    m_keyTableDirty = true;
     handleDestroyedAction(object, m_pointerShortcuts);
     handleDestroyedAction(object, m_axisShortcuts);
 }
@@ -194,6 +209,7 @@ void GlobalShortcutsManager::registerShortcut(QAction *action, const QKeySequenc
         return;
     }
     addShortcut(m_shortcuts, action, mods, static_cast<uint32_t>(keysym));
+    m_keyTableDirty = true;
     connect(action, &QAction::destroyed, this, &GlobalShortcutsManager::objectDeleted);
 }
 
@@ -244,26 +260,46 @@ bool processShortcut(Qt::KeyboardModifiers mods, T key, U &shortcuts)
     return true;
 }
 
-bool GlobalShortcutsManager::processKey(Qt::KeyboardModifiers mods, uint32_t key)
+static inline quint64 keyTableKey(Qt::KeyboardModifiers mods, uint32_t key)
+{
+    return (quint64(uint(mods)) << 32) | quint64(key);
+}
+
+void GlobalShortcutsManager::compileKeyTable()
 {
-    if (m_kglobalAccelInterface) {
+    m_keyTable.clear();
+    for (auto it = m_shortcuts.constBegin(); it != m_shortcuts.constEnd(); ++it) {
+        const auto &keys = it.value();
+        for (auto it2 = keys.constBegin(); it2 != keys.constEnd(); ++it2) {
+            m_keyTable.insert(keyTableKey(it.key(), it2.key()), it2.value());
+        }
+    }
+    m_keyTableDirty = false;
+}
+
+bool GlobalShortcutsManager::processKey(Qt::KeyboardModifiers mods, uint32_t key, int keyQt)
+{
+    if (m_kglobalAccelInterface && m_checkKeyPressed.isValid()) {
         bool retVal = false;
-        int keyQt = 0;
-        if (KKeyServer::symXToKeyQt(key, &keyQt)) {
-            QMetaObject::invokeMethod(m_kglobalAccelInterface,
-                                    "checkKeyPressed",
-                                    Qt::DirectConnection,
-                                    Q_RETURN_ARG(bool, retVal),
-                                    Q_ARG(int, int(mods) | keyQt));
+        if (keyQt != Qt::Key_unknown || KKeyServer::symXToKeyQt(key, &keyQt)) {
+            m_checkKeyPressed.invoke(m_kglobalAccelInterface,
+                                     Qt::DirectConnection,
+                                     Q_RETURN_ARG(bool, retVal),
+                                     Q_ARG(int, int(mods) | keyQt));
             if (retVal) {
                 return true;
             }
         }
     }
-    if (processShortcut(mods, key, m_shortcuts)) {
-        return true;
+    if (m_keyTableDirty) {
+        compileKeyTable();
+    }
+    const auto it = m_keyTable.constFind(keyTableKey(mods, key));
+    if (it == m_keyTable.constEnd()) {
+        return false;
     }
-    return false;
+    it.value()->invoke();
+    return true;
 }
 
 bool GlobalShortcutsManager::processPointerPressed(Qt::KeyboardModifiers mods, Qt::MouseButtons pointerButtons)
@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <KSharedConfig>
 // Qt
 #include <QKeySequence>
+#include <QMetaMethod>
 
 class QAction;
 class KGlobalAccelD;
@@ -85,9 +86,10 @@ public:
      *
      * @param modifiers The current hold modifiers
      * @param key The keysymbol which has been pressed
+     * @param keyQt The Qt key code of @p key, if already known. Otherwise it gets looked up.
      * @return @c true if a shortcut triggered, @c false otherwise
      */
-    bool processKey(Qt::KeyboardModifiers modifiers, uint32_t key);
+    bool processKey(Qt::KeyboardModifiers modifiers, uint32_t key, int keyQt = Qt::Key_unknown);
     bool processPointerPressed(Qt::KeyboardModifiers modifiers, Qt::MouseButtons pointerButtons);
     /**
      * @brief Processes a pointer axis event to decide whether a shortcut needs to be triggered.
@@ -102,19 +104,28 @@ public:
      */
     bool processAxis(Qt::KeyboardModifiers modifiers, PointerAxisDirection axis);
 
-    void setKGlobalAccelInterface(KGlobalAccelInterface *interface) {
-        m_kglobalAccelInterface = interface;
-    }
+    void setKGlobalAccelInterface(KGlobalAccelInterface *interface);
 
 private:
     void objectDeleted(QObject *object);
+    /**
+     * Flattens m_shortcuts into m_keyTable. Only done if the registered
+     * shortcuts changed since the last key press.
+     **/
+    void compileKeyTable();
     QKeySequence getShortcutForAction(const QString &componentName, const QString &actionName, const QKeySequence &defaultShortcut);
     QHash<Qt::KeyboardModifiers, QHash<uint32_t, GlobalShortcut*> > m_shortcuts;
     QHash<Qt::KeyboardModifiers, QHash<Qt::MouseButtons, GlobalShortcut*> > m_pointerShortcuts;
     QHash<Qt::KeyboardModifiers, QHash<PointerAxisDirection, GlobalShortcut*> > m_axisShortcuts;
+    /**
+     * The key shortcuts keyed by the modifiers in the upper and the keysym in the lower 32 bits.
+     **/
+    QHash<quint64, GlobalShortcut*> m_keyTable;
+    bool m_keyTableDirty = false;
     KSharedConfigPtr m_config;
     KGlobalAccelD *m_kglobalAccel = nullptr;
     KGlobalAccelInterface *m_kglobalAccelInterface = nullptr;
+    QMetaMethod m_checkKeyPressed;
 };
 
 class GlobalShortcut
@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "pointer_input.h"
 #include "touch_input.h"
 #include "client.h"
+#include "dbusinterface.h"
 #include "effects.h"
 #include "globalshortcuts.h"
 #include "logind.h"
@@ -32,6 +33,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "unmanaged.h"
 #include "screenedge.h"
 #include "screens.h"
+#include "tracing.h"
 #include "workspace.h"
 #if HAVE_INPUT
 #include "libinput/connection.h"
@@ -64,6 +66,16 @@ InputEventFilter::~InputEventFilter()
     }
 }
 
+InputEventFilter::EventTypes InputEventFilter::eventTypes() const
+{
+    return AllEvents;
+}
+
+bool InputEventFilter::isActive() const
+{
+    return true;
+}
+
 bool InputEventFilter::pointerEvent(QMouseEvent *event, quint32 nativeButton)
 {
     Q_UNUSED(event)
@@ -109,6 +121,9 @@ bool InputEventFilter::touchUp(quint32 id, quint32 time)
 #if HAVE_INPUT
 class VirtualTerminalFilter : public InputEventFilter {
 public:
+    EventTypes eventTypes() const override {
+        return KeyEvents;
+    }
     bool keyEvent(QKeyEvent *event) override {
         // really on press and not on release? X11 switches on press.
         if (event->type() == QEvent::KeyPress && !event->isAutoRepeat()) {
@@ -125,6 +140,9 @@ public:
 
 class LockScreenFilter : public InputEventFilter {
 public:
+    bool isActive() const override {
+        return waylandServer()->isScreenLocked();
+    }
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         if (!waylandServer()->isScreenLocked()) {
             return false;
@@ -134,7 +152,7 @@ public:
         if (event->type() == QEvent::MouseMove) {
             if (event->buttons() == Qt::NoButton) {
                 // update pointer window only if no button is pressed
-                input()->pointer()->update();
+                input()->pointer()->scheduleUpdate();
             }
             if (pointerSurfaceAllowed()) {
                 seat->setPointerPos(event->screenPos().toPoint());
@@ -261,6 +279,16 @@ private:
 
 class EffectsFilter : public InputEventFilter {
 public:
+    EventTypes eventTypes() const override {
+        return PointerEvents | KeyEvents;
+    }
+    bool isActive() const override {
+        if (!effects) {
+            return false;
+        }
+        auto e = static_cast<EffectsHandlerImpl*>(effects);
+        return e->isMouseInterception() || e->hasKeyboardGrab();
+    }
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         Q_UNUSED(nativeButton)
         if (!effects) {
@@ -279,6 +307,12 @@ public:
 
 class MoveResizeFilter : public InputEventFilter {
 public:
+    EventTypes eventTypes() const override {
+        return PointerEvents | WheelEvents | KeyEvents;
+    }
+    bool isActive() const override {
+        return workspace() && workspace()->getMovingClient();
+    }
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         Q_UNUSED(nativeButton)
         AbstractClient *c = workspace()->getMovingClient();
@@ -322,6 +356,9 @@ public:
 
 class GlobalShortcutFilter : public InputEventFilter {
 public:
+    EventTypes eventTypes() const override {
+        return PointerEvents | WheelEvents | KeyEvents;
+    }
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         Q_UNUSED(nativeButton);
         if (event->type() == QEvent::MouseButtonPress) {
@@ -349,13 +386,16 @@ public:
     }
     bool keyEvent(QKeyEvent *event) override {
         if (event->type() == QEvent::KeyPress && !event->isAutoRepeat()) {
-            return input()->shortcuts()->processKey(event->modifiers(), event->nativeVirtualKey());
+            return input()->shortcuts()->processKey(event->modifiers(), event->nativeVirtualKey(), event->key());
         }
         return false;
     }
 };
 
 class InternalWindowEventFilter : public InputEventFilter {
+    EventTypes eventTypes() const override {
+        return PointerEvents | WheelEvents | KeyEvents;
+    }
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         Q_UNUSED(nativeButton)
         auto internal = input()->pointer()->internalWindow();
@@ -418,6 +458,12 @@ class InternalWindowEventFilter : public InputEventFilter {
 
 class DecorationEventFilter : public InputEventFilter {
 public:
+    EventTypes eventTypes() const override {
+        return PointerEvents | WheelEvents;
+    }
+    bool isActive() const override {
+        return !input()->pointer()->decoration().isNull();
+    }
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         Q_UNUSED(nativeButton)
         auto decoration = input()->pointer()->decoration();
@@ -484,6 +530,12 @@ public:
 class TabBoxInputFilter : public InputEventFilter
 {
 public:
+    EventTypes eventTypes() const override {
+        return PointerEvents | WheelEvents | KeyEvents;
+    }
+    bool isActive() const override {
+        return TabBox::TabBox::self() && TabBox::TabBox::self()->isGrabbed();
+    }
     bool pointerEvent(QMouseEvent *event, quint32 button) override {
         Q_UNUSED(button)
         if (!TabBox::TabBox::self() || !TabBox::TabBox::self()->isGrabbed()) {
@@ -511,8 +563,15 @@ public:
 class ScreenEdgeInputFilter : public InputEventFilter
 {
 public:
+    EventTypes eventTypes() const override {
+        return PointerEvents;
+    }
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         Q_UNUSED(nativeButton)
+        if (event->type() == QEvent::MouseMove && input()->pointer()->isFrameAligned()) {
+            input()->pointer()->scheduleScreenEdgeCheck(event->timestamp());
+            return false;
+        }
         ScreenEdges::self()->isEntered(event);
         // always forward
         return false;
@@ -526,6 +585,9 @@ public:
 class WindowActionInputFilter : public InputEventFilter
 {
 public:
+    EventTypes eventTypes() const override {
+        return PointerEvents | WheelEvents | TouchEvents;
+    }
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         Q_UNUSED(nativeButton)
         if (event->type() != QEvent::MouseButtonPress) {
@@ -617,7 +679,7 @@ public:
         case QEvent::MouseMove:
             if (event->buttons() == Qt::NoButton) {
                 // update pointer window only if no button is pressed
-                input()->pointer()->update();
+                input()->pointer()->scheduleUpdate();
             }
             seat->setPointerPos(event->globalPos());
             break;
@@ -707,6 +769,12 @@ public:
 class DragAndDropInputFilter : public InputEventFilter
 {
 public:
+    EventTypes eventTypes() const override {
+        return PointerEvents;
+    }
+    bool isActive() const override {
+        return waylandServer()->seat()->isDragPointer();
+    }
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         auto seat = waylandServer()->seat();
         if (!seat->isDragPointer()) {
@@ -779,16 +847,69 @@ InputRedirection::~InputRedirection()
 void InputRedirection::installInputEventFilter(InputEventFilter *filter)
 {
     m_filters << filter;
+    updateFilterChains();
 }
 
 void InputRedirection::prepandInputEventFilter(InputEventFilter *filter)
 {
     m_filters.prepend(filter);
+    updateFilterChains();
 }
 
 void InputRedirection::uninstallInputEventFilter(InputEventFilter *filter)
 {
-    m_filters.removeAll(filter);
+    if (m_filters.removeAll(filter) > 0) {
+        updateFilterChains();
+    }
+}
+
+static int filterChainIndex(InputEventFilter::EventType type)
+{
+    switch (type) {
+    case InputEventFilter::PointerEvents:
+        return 0;
+    case InputEventFilter::WheelEvents:
+        return 1;
+    case InputEventFilter::KeyEvents:
+        return 2;
+    case InputEventFilter::TouchEvents:
+        return 3;
+    default:
+        Q_UNREACHABLE();
+        return 0;
+    }
+}
+
+void InputRedirection::updateFilterChains()
+{
+    for (auto type : {InputEventFilter::PointerEvents, InputEventFilter::WheelEvents,
+                      InputEventFilter::KeyEvents, InputEventFilter::TouchEvents}) {
+        QVector<InputEventFilter*> &chain = m_filterChains[filterChainIndex(type)];
+        chain.clear();
+        for (auto it = m_filters.constBegin(), end = m_filters.constEnd(); it != end; ++it) {
+            InputEventFilter *filter = *it;
+            if (filter->eventTypes().testFlag(type)) {
+                chain << filter;
+            }
+        }
+    }
+}
+
+QVector<InputEventFilter*> InputRedirection::filters(InputEventFilter::EventType type) const
+{
+    return m_filterChains[filterChainIndex(type)];
+}
+
+QVarLengthArray<InputEventFilter*, 16> InputRedirection::activeFilters(InputEventFilter::EventType type) const
+{
+    QVarLengthArray<InputEventFilter*, 16> active;
+    const QVector<InputEventFilter*> &chain = m_filterChains[filterChainIndex(type)];
+    for (InputEventFilter *filter : chain) {
+        if (filter->isActive()) {
+            active.append(filter);
+        }
+    }
+    return active;
 }
 
 void InputRedirection::init()
@@ -920,8 +1041,10 @@ void InputRedirection::setupLibInput()
     m_libInput = conn;
     if (conn) {
         conn->setup();
+        new InputLatencyDBusInterface(conn, this);
         connect(conn, &LibInput::Connection::eventsRead, this,
             [this] {
+                KWIN_TRACE("input", "processEvents");
                 m_libInput->processEvents();
             }, Qt::QueuedConnection
         );
@@ -1006,21 +1129,25 @@ void InputRedirection::setupLibInputWithScreens()
 
 void InputRedirection::processPointerMotion(const QPointF &pos, uint32_t time)
 {
+    KWIN_TRACE("input", "processPointerMotion");
     m_pointer->processMotion(pos, time);
 }
 
 void InputRedirection::processPointerButton(uint32_t button, InputRedirection::PointerButtonState state, uint32_t time)
 {
+    KWIN_TRACE("input", "processPointerButton");
     m_pointer->processButton(button, state, time);
 }
 
 void InputRedirection::processPointerAxis(InputRedirection::PointerAxis axis, qreal delta, uint32_t time)
 {
+    KWIN_TRACE("input", "processPointerAxis");
     m_pointer->processAxis(axis, delta, time);
 }
 
 void InputRedirection::processKeyboardKey(uint32_t key, InputRedirection::KeyboardKeyState state, uint32_t time)
 {
+    KWIN_TRACE("input", "processKeyboardKey");
     m_keyboard->processKey(key, state, time);
 }
 
@@ -1036,16 +1163,19 @@ void InputRedirection::processKeymapChange(int fd, uint32_t size)
 
 void InputRedirection::processTouchDown(qint32 id, const QPointF &pos, quint32 time)
 {
+    KWIN_TRACE("input", "processTouchDown");
     m_touch->processDown(id, pos, time);
 }
 
 void InputRedirection::processTouchUp(qint32 id, quint32 time)
 {
+    KWIN_TRACE("input", "processTouchUp");
     m_touch->processUp(id, time);
 }
 
 void InputRedirection::processTouchMotion(qint32 id, const QPointF &pos, quint32 time)
 {
+    KWIN_TRACE("input", "processTouchMotion");
     m_touch->processMotion(id, pos, time);
 }
 
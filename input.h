@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QAction>
 #include <QObject>
 #include <QPoint>
+#include <QVarLengthArray>
 #include <config-kwin.h>
 
 class KGlobalAccelInterface;
@@ -35,7 +36,6 @@ namespace KWin
 {
 class GlobalShortcutsManager;
 class Toplevel;
-class InputEventFilter;
 class KeyboardInputRedirection;
 class PointerInputRedirection;
 class TouchInputRedirection;
@@ -45,6 +45,95 @@ namespace LibInput
     class Connection;
 }
 
+/**
+ * Base class for filtering input events inside InputRedirection.
+ *
+ * The idea behind the InputEventFilter is to have task oriented
+ * filters. E.g. there is one filter taking care of a locked screen,
+ * one to take care of interacting with window decorations, etc.
+ *
+ * A concrete subclass can reimplement the virtual methods and decide
+ * whether an event should be filtered out or not by returning either
+ * @c true or @c false. E.g. the lock screen filter can easily ensure
+ * that all events are filtered out.
+ *
+ * As soon as a filter returns @c true the processing is stopped. If
+ * a filter returns @c false the next one is invoked. This means a filter
+ * installed early gets to see more events than a filter installed later on.
+ *
+ * Deleting an instance of InputEventFilter automatically uninstalls it from
+ * InputRedirection.
+ *
+ * To keep the per event overhead low a filter can announce the types of events
+ * it is interested in through eventTypes() and whether it currently wants to see
+ * events at all through isActive(). InputRedirection only passes events to active
+ * filters handling the event's type.
+ **/
+class KWIN_EXPORT InputEventFilter
+{
+public:
+    InputEventFilter();
+    virtual ~InputEventFilter();
+
+    enum EventType {
+        PointerEvents = 1 << 0,
+        WheelEvents = 1 << 1,
+        KeyEvents = 1 << 2,
+        TouchEvents = 1 << 3,
+        AllEvents = PointerEvents | WheelEvents | KeyEvents | TouchEvents
+    };
+    Q_DECLARE_FLAGS(EventTypes, EventType)
+
+    /**
+     * The types of events this filter handles. Only evaluated when the filter gets
+     * installed, thus it must not change afterwards.
+     *
+     * Default implementation returns AllEvents.
+     **/
+    virtual EventTypes eventTypes() const;
+    /**
+     * Whether the filter currently wants to see events. Invoked once for each
+     * event, so it should be cheap. It is fine to return @c true and filter
+     * nothing out.
+     *
+     * Default implementation returns @c true.
+     **/
+    virtual bool isActive() const;
+
+    /**
+     * Event filter for pointer events which can be described by a QMouseEvent.
+     *
+     * Please note that the button translation in QMouseEvent cannot cover all
+     * possible buttons. Because of that also the @p nativeButton code is passed
+     * through the filter. For internal areas it's fine to use @p event, but for
+     * passing to client windows the @p nativeButton should be used.
+     *
+     * @param event The event information about the move or button press/release
+     * @param nativeButton The native key code of the button, for move events 0
+     * @return @c true to stop further event processing, @c false to pass to next filter
+     **/
+    virtual bool pointerEvent(QMouseEvent *event, quint32 nativeButton);
+    /**
+     * Event filter for pointer axis events.
+     *
+     * @param event The event information about the axis event
+     * @return @c true to stop further event processing, @c false to pass to next filter
+     **/
+    virtual bool wheelEvent(QWheelEvent *event);
+    /**
+     * Event filter for keyboard events.
+     *
+     * @param event The event information about the key event
+     * @return @c tru to stop further event processing, @c false to pass to next filter.
+     **/
+    virtual bool keyEvent(QKeyEvent *event);
+    virtual bool touchDown(quint32 id, const QPointF &pos, quint32 time);
+    virtual bool touchMotion(quint32 id, const QPointF &pos, quint32 time);
+    virtual bool touchUp(quint32 id, quint32 time);
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(InputEventFilter::EventTypes)
+
 /**
  * @brief This class is responsible for redirecting incoming input to the surface which currently
  * has input or send enter/leave events.
@@ -146,6 +235,15 @@ public:
     QVector<InputEventFilter*> filters() const {
         return m_filters;
     }
+    /**
+     * @returns the installed filters which handle events of @p type, in processing order
+     **/
+    QVector<InputEventFilter*> filters(InputEventFilter::EventType type) const;
+    /**
+     * The filters handling events of @p type which are currently active, in processing order.
+     * If the returned chain is empty there is no need to construct the event at all.
+     **/
+    QVarLengthArray<InputEventFilter*, 16> activeFilters(InputEventFilter::EventType type) const;
     KeyboardInputRedirection *keyboard() const {
         return m_keyboard;
     }
@@ -203,6 +301,7 @@ private:
     void reconfigure();
     void setupInputFilters();
     void installInputEventFilter(InputEventFilter *filter);
+    void updateFilterChains();
     KeyboardInputRedirection *m_keyboard;
     PointerInputRedirection *m_pointer;
     TouchInputRedirection *m_touch;
@@ -212,6 +311,11 @@ private:
     LibInput::Connection *m_libInput = nullptr;
 
     QVector<InputEventFilter*> m_filters;
+    /**
+     * m_filters split by the event types the filters handle, indexed by
+     * the bit position of InputEventFilter::EventType.
+     **/
+    QVector<InputEventFilter*> m_filterChains[4];
 
     KWIN_SINGLETON(InputRedirection)
     friend InputRedirection *input();
@@ -220,63 +324,6 @@ private:
     friend class ForwardInputFilter;
 };
 
-/**
- * Base class for filtering input events inside InputRedirection.
- *
- * The idea behind the InputEventFilter is to have task oriented
- * filters. E.g. there is one filter taking care of a locked screen,
- * one to take care of interacting with window decorations, etc.
- *
- * A concrete subclass can reimplement the virtual methods and decide
- * whether an event should be filtered out or not by returning either
- * @c true or @c false. E.g. the lock screen filter can easily ensure
- * that all events are filtered out.
- *
- * As soon as a filter returns @c true the processing is stopped. If
- * a filter returns @c false the next one is invoked. This means a filter
- * installed early gets to see more events than a filter installed later on.
- *
- * Deleting an instance of InputEventFilter automatically uninstalls it from
- * InputRedirection.
- **/
-class KWIN_EXPORT InputEventFilter
-{
-public:
-    InputEventFilter();
-    virtual ~InputEventFilter();
-
-    /**
-     * Event filter for pointer events which can be described by a QMouseEvent.
-     *
-     * Please note that the button translation in QMouseEvent cannot cover all
-     * possible buttons. Because of that also the @p nativeButton code is passed
-     * through the filter. For internal areas it's fine to use @p event, but for
-     * passing to client windows the @p nativeButton should be used.
-     *
-     * @param event The event information about the move or button press/release
-     * @param nativeButton The native key code of the button, for move events 0
-     * @return @c true to stop further event processing, @c false to pass to next filter
-     **/
-    virtual bool pointerEvent(QMouseEvent *event, quint32 nativeButton);
-    /**
-     * Event filter for pointer axis events.
-     *
-     * @param event The event information about the axis event
-     * @return @c true to stop further event processing, @c false to pass to next filter
-     **/
-    virtual bool wheelEvent(QWheelEvent *event);
-    /**
-     * Event filter for keyboard events.
-     *
-     * @param event The event information about the key event
-     * @return @c tru to stop further event processing, @c false to pass to next filter.
-     **/
-    virtual bool keyEvent(QKeyEvent *event);
-    virtual bool touchDown(quint32 id, const QPointF &pos, quint32 time);
-    virtual bool touchMotion(quint32 id, const QPointF &pos, quint32 time);
-    virtual bool touchUp(quint32 id, quint32 time);
-};
-
 inline
 InputRedirection *input()
 {
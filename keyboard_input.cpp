@@ -37,6 +37,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDBusPendingCall>
 #include <QKeyEvent>
 #include <QTemporaryFile>
+#include <QTimer>
 // xkbcommon
 #include <xkbcommon/xkbcommon.h>
 #include <xkbcommon/xkbcommon-keysyms.h>
@@ -183,9 +184,49 @@ void Xkb::updateKeymap(xkb_keymap *keymap)
     m_metaModifier    = xkb_keymap_mod_get_index(m_keymap, XKB_MOD_NAME_LOGO);
     m_currentLayout = xkb_state_serialize_layout(m_state, XKB_STATE_LAYOUT_EFFECTIVE);
 
+    updateKeysymTable();
     createKeymapFile();
 }
 
+static QString keysymToString(xkb_keysym_t keysym)
+{
+    QByteArray byteArray(7, 0);
+    int ok = xkb_keysym_to_utf8(keysym, byteArray.data(), byteArray.size());
+    if (ok == -1 || ok == 0) {
+        return QString();
+    }
+    return QString::fromUtf8(byteArray.constData());
+}
+
+static Qt::Key keysymToQtKey(xkb_keysym_t keysym)
+{
+    int key = Qt::Key_unknown;
+    KKeyServer::symXToKeyQt(keysym, &key);
+    return static_cast<Qt::Key>(key);
+}
+
+void Xkb::updateKeysymTable()
+{
+    m_keysymTable.clear();
+    const xkb_keycode_t max = xkb_keymap_max_keycode(m_keymap);
+    for (xkb_keycode_t keycode = xkb_keymap_min_keycode(m_keymap); keycode <= max; ++keycode) {
+        const xkb_layout_index_t layouts = xkb_keymap_num_layouts_for_key(m_keymap, keycode);
+        for (xkb_layout_index_t layout = 0; layout < layouts; ++layout) {
+            const xkb_level_index_t levels = xkb_keymap_num_levels_for_key(m_keymap, keycode, layout);
+            for (xkb_level_index_t level = 0; level < levels; ++level) {
+                const xkb_keysym_t *syms = nullptr;
+                const int count = xkb_keymap_key_get_syms_by_level(m_keymap, keycode, layout, level, &syms);
+                for (int i = 0; i < count; ++i) {
+                    if (syms[i] == XKB_KEY_NoSymbol || m_keysymTable.contains(syms[i])) {
+                        continue;
+                    }
+                    m_keysymTable.insert(syms[i], KeysymInfo{keysymToQtKey(syms[i]), keysymToString(syms[i])});
+                }
+            }
+        }
+    }
+}
+
 void Xkb::createKeymapFile()
 {
     if (!waylandServer()) {
@@ -316,19 +357,20 @@ QString Xkb::toString(xkb_keysym_t keysym)
     if (!m_state || keysym == XKB_KEY_NoSymbol) {
         return QString();
     }
-    QByteArray byteArray(7, 0);
-    int ok = xkb_keysym_to_utf8(keysym, byteArray.data(), byteArray.size());
-    if (ok == -1 || ok == 0) {
-        return QString();
+    auto it = m_keysymTable.constFind(keysym);
+    if (it != m_keysymTable.constEnd()) {
+        return it.value().text;
     }
-    return QString::fromUtf8(byteArray.constData());
+    return keysymToString(keysym);
 }
 
 Qt::Key Xkb::toQtKey(xkb_keysym_t keysym)
 {
-    int key = Qt::Key_unknown;
-    KKeyServer::symXToKeyQt(keysym, &key);
-    return static_cast<Qt::Key>(key);
+    auto it = m_keysymTable.constFind(keysym);
+    if (it != m_keysymTable.constEnd()) {
+        return it.value().key;
+    }
+    return keysymToQtKey(keysym);
 }
 
 bool Xkb::shouldKeyRepeat(quint32 key) const
@@ -357,14 +399,13 @@ KeyboardInputRedirection::KeyboardInputRedirection(InputRedirection *parent)
     : QObject(parent)
     , m_input(parent)
     , m_xkb(new Xkb(parent))
+    , m_repeatTimer(new QTimer(this))
 {
+    m_repeatTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_repeatTimer, &QTimer::timeout, this, &KeyboardInputRedirection::repeatKey);
 }
 
-KeyboardInputRedirection::~KeyboardInputRedirection()
-{
-    qDeleteAll(m_repeatTimers);
-    m_repeatTimers.clear();
-}
+KeyboardInputRedirection::~KeyboardInputRedirection() = default;
 
 void KeyboardInputRedirection::init()
 {
@@ -475,6 +516,23 @@ void KeyboardInputRedirection::processKey(uint32_t key, InputRedirection::Keyboa
         }
     }
 
+    if (state == InputRedirection::KeyboardKeyPressed) {
+        if (m_xkb->shouldKeyRepeat(key) && waylandServer()->seat()->keyRepeatDelay() != 0) {
+            // a newly pressed key takes over the repeat
+            m_repeat.key = key;
+            m_repeat.time = time;
+            m_repeatTimer->start(waylandServer()->seat()->keyRepeatDelay());
+        }
+    } else if (state == InputRedirection::KeyboardKeyReleased) {
+        if (m_repeatTimer->isActive() && m_repeat.key == key) {
+            m_repeatTimer->stop();
+        }
+    }
+
+    const auto filters = m_input->activeFilters(InputEventFilter::KeyEvents);
+    if (filters.isEmpty()) {
+        return;
+    }
     const xkb_keysym_t keySym = m_xkb->toKeysym(key);
     QKeyEvent event(type,
                     m_xkb->toQtKey(keySym),
@@ -482,35 +540,10 @@ void KeyboardInputRedirection::processKey(uint32_t key, InputRedirection::Keyboa
                     key,
                     keySym,
                     0,
-                    m_xkb->toString(m_xkb->toKeysym(key)),
+                    m_xkb->toString(keySym),
                     autoRepeat);
     event.setTimestamp(time);
-    if (state == InputRedirection::KeyboardKeyPressed) {
-        if (m_xkb->shouldKeyRepeat(key) && waylandServer()->seat()->keyRepeatDelay() != 0) {
-            QTimer *timer = new QTimer;
-            timer->setInterval(waylandServer()->seat()->keyRepeatDelay());
-            connect(timer, &QTimer::timeout, this,
-                [this, timer, time, key] {
-                    const int delay = 1000 / waylandServer()->seat()->keyRepeatRate();
-                    if (timer->interval() != delay) {
-                        timer->setInterval(delay);
-                    }
-                    // TODO: better time
-                    processKey(key, InputRedirection::KeyboardKeyAutoRepeat, time);
-                }
-            );
-            m_repeatTimers.insert(key, timer);
-            timer->start();
-        }
-    } else if (state == InputRedirection::KeyboardKeyReleased) {
-        auto it = m_repeatTimers.find(key);
-        if (it != m_repeatTimers.end()) {
-            delete it.value();
-            m_repeatTimers.erase(it);
-        }
-    }
 
-    const auto &filters = m_input->filters();
     for (auto it = filters.begin(), end = filters.end(); it != end; it++) {
         if ((*it)->keyEvent(&event)) {
             return;
@@ -518,6 +551,22 @@ void KeyboardInputRedirection::processKey(uint32_t key, InputRedirection::Keyboa
     }
 }
 
+void KeyboardInputRedirection::repeatKey()
+{
+    const qint32 rate = waylandServer()->seat()->keyRepeatRate();
+    if (rate <= 0) {
+        m_repeatTimer->stop();
+        return;
+    }
+    // derive the time of the repeated event from the time of the press
+    m_repeat.time += m_repeatTimer->interval();
+    const int delay = 1000 / rate;
+    if (m_repeatTimer->interval() != delay) {
+        m_repeatTimer->setInterval(delay);
+    }
+    processKey(m_repeat.key, InputRedirection::KeyboardKeyAutoRepeat, m_repeat.time);
+}
+
 void KeyboardInputRedirection::processModifiers(uint32_t modsDepressed, uint32_t modsLatched, uint32_t modsLocked, uint32_t group)
 {
     if (!m_inited) {
@@ -29,6 +29,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QLoggingCategory>
 Q_DECLARE_LOGGING_CATEGORY(KWIN_XKB)
 
+class QTimer;
 class QWindow;
 struct xkb_context;
 struct xkb_keymap;
@@ -66,6 +67,7 @@ private:
     void updateKeymap(xkb_keymap *keymap);
     void createKeymapFile();
     void updateModifiers();
+    void updateKeysymTable();
     InputRedirection *m_input;
     xkb_context *m_context;
     xkb_keymap *m_keymap;
@@ -80,6 +82,16 @@ private:
         Qt::KeyboardModifier modifier = Qt::NoModifier;
     } m_modOnlyShortcut;
     quint32 m_currentLayout = 0;
+    struct KeysymInfo {
+        Qt::Key key;
+        QString text;
+    };
+    /**
+     * Qt key and text of all keysyms in the keymap, so that translating a key
+     * does not need to search the KKeyServer tables on each key event.
+     * Rebuilt whenever the keymap changes.
+     **/
+    QHash<xkb_keysym_t, KeysymInfo> m_keysymTable;
 };
 
 class KeyboardInputRedirection : public QObject
@@ -117,10 +129,18 @@ private Q_SLOTS:
     void reconfigure();
 
 private:
+    void repeatKey();
     InputRedirection *m_input;
     bool m_inited = false;
     QScopedPointer<Xkb> m_xkb;
-    QHash<quint32, QTimer*> m_repeatTimers;
+    /**
+     * Only the last pressed key repeats, so one timer serves all keys.
+     **/
+    QTimer *m_repeatTimer;
+    struct {
+        quint32 key = 0;
+        quint32 time = 0;
+    } m_repeat;
 };
 
 inline
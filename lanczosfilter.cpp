@@ -20,11 +20,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 
 #include "lanczosfilter.h"
-#include "client.h"
-#include "deleted.h"
+#include "composite.h"
 #include "effects.h"
 #include "screens.h"
-#include "unmanaged.h"
 #include "options.h"
 #include "workspace.h"
 
@@ -41,7 +39,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 namespace KWin
 {
 
-LanczosFilter::LanczosFilter(QObject* parent)
+LanczosFilter::LanczosFilter(Scene::ThumbnailStatistics *statistics, QObject* parent)
     : QObject(parent)
     , m_offscreenTex(0)
     , m_offscreenTarget(0)
@@ -49,13 +47,26 @@ LanczosFilter::LanczosFilter(QObject* parent)
     , m_shader(0)
     , m_uOffsets(0)
     , m_uKernel(0)
+    , m_updates(0)
+    , m_statistics(statistics)
 {
+    connect(Compositor::self(), &Compositor::aboutToPaintFrame, this, [this] { m_updates = 0; });
+    connect(effects, &EffectsHandler::windowDamaged, this,
+        [this] (EffectWindow *w) {
+            auto it = m_cache.find(w);
+            if (it != m_cache.end()) {
+                it->dirty = true;
+            }
+        }
+    );
+    connect(effects, &EffectsHandler::windowDeleted, this, &LanczosFilter::discardCacheTexture);
 }
 
 LanczosFilter::~LanczosFilter()
 {
     delete m_offscreenTarget;
     delete m_offscreenTex;
+    discardCache();
 }
 
 void LanczosFilter::init()
@@ -203,44 +214,43 @@ void LanczosFilter::performPaint(EffectWindowImpl* w, int mask, QRegion region,
             int sw = width;
             int sh = height;
 
-            GLTexture *cachedTexture = static_cast< GLTexture*>(w->data(LanczosCacheRole).value<void*>());
-            if (cachedTexture) {
-                if (cachedTexture->width() == tw && cachedTexture->height() == th) {
-                    cachedTexture->bind();
-                    if (hardwareClipping) {
-                        glEnable(GL_SCISSOR_TEST);
+            GLTexture *cache = nullptr;
+            auto it = m_cache.find(w);
+            if (it != m_cache.end()) {
+                const QSize cacheSize = it->texture->size();
+                // a texture which is at most twice as big is good enough thanks to the mipmaps, that
+                // way the thumbnail survives the animations of e.g. present windows
+                const bool fits = tw <= cacheSize.width() && th <= cacheSize.height() &&
+                                  tw * 2 >= cacheSize.width() && th * 2 >= cacheSize.height();
+                if (fits && (!it->dirty || m_updates >= MaximumUpdatesPerFrame)) {
+                    if (it->dirty) {
+                        // no budget left in this frame, show the old content and update it later
+                        m_statistics->deferredThumbnails++;
+                        effects->addRepaint(textureRect);
+                    } else {
+                        m_statistics->cachedThumbnails++;
                     }
-
-                    glEnable(GL_BLEND);
-                    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-
-                    const qreal rgb = data.brightness() * data.opacity();
-                    const qreal a = data.opacity();
-
-                    ShaderBinder binder(ShaderTrait::MapTexture | ShaderTrait::Modulate | ShaderTrait::AdjustSaturation);
-                    GLShader *shader = binder.shader();
-                    QMatrix4x4 mvp = data.screenProjectionMatrix();
-                    mvp.translate(textureRect.x(), textureRect.y());
-                    shader->setUniform(GLShader::ModelViewProjectionMatrix, mvp);
-                    shader->setUniform(GLShader::ModulationConstant, QVector4D(rgb, rgb, rgb, a));
-                    shader->setUniform(GLShader::Saturation, data.saturation());
-
-                    cachedTexture->render(region, textureRect, hardwareClipping);
-
-                    glDisable(GL_BLEND);
-                    if (hardwareClipping) {
-                        glDisable(GL_SCISSOR_TEST);
-                    }
-                    cachedTexture->unbind();
+                    paintCacheTexture(it->texture, region, textureRect, hardwareClipping, data);
                     m_timer.start(5000, this);
                     return;
+                }
+                if (cacheSize == QSize(tw, th)) {
+                    // render into the existing texture
+                    cache = it->texture;
                 } else {
-                    // offscreen texture not matching - delete
-                    delete cachedTexture;
-                    cachedTexture = 0;
-                    w->setData(LanczosCacheRole, QVariant());
+                    delete it->texture;
                 }
+                m_cache.erase(it);
             }
+            if (!cache && m_updates >= MaximumUpdatesPerFrame) {
+                // nothing to show yet, paint the window directly in this frame
+                m_statistics->deferredThumbnails++;
+                effects->addRepaint(textureRect);
+                w->sceneWindow()->performPaint(mask, region, data);
+                return;
+            }
+            m_updates++;
+            m_statistics->renderedThumbnails++;
 
             WindowPaintData thumbData = data;
             thumbData.setXScale(1.0);
@@ -337,42 +347,22 @@ void LanczosFilter::performPaint(EffectWindowImpl* w, int mask, QRegion region,
             ShaderManager::instance()->popShader();
 
             // create cache texture
-            GLTexture *cache = new GLTexture(GL_RGBA8, tw, th);
-
-            cache->setFilter(GL_LINEAR);
-            cache->setWrapMode(GL_CLAMP_TO_EDGE);
+            if (!cache) {
+                const int levels = qFloor(std::log2(qMax(1, qMax(tw, th)))) + 1;
+                cache = new GLTexture(GL_RGBA8, tw, th, levels);
+                cache->setFilter(GL_LINEAR_MIPMAP_LINEAR);
+                cache->setWrapMode(GL_CLAMP_TO_EDGE);
+            }
             cache->bind();
             glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, m_offscreenTex->height() - th, tw, th);
+            cache->generateMipmaps();
+            cache->unbind();
             GLRenderTarget::popRenderTarget();
 
-            if (hardwareClipping) {
-                glEnable(GL_SCISSOR_TEST);
-            }
-
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-
-            const qreal rgb = data.brightness() * data.opacity();
-            const qreal a = data.opacity();
-
-            ShaderBinder binder(ShaderTrait::MapTexture | ShaderTrait::Modulate | ShaderTrait::AdjustSaturation);
-            GLShader *shader = binder.shader();
-            QMatrix4x4 mvp = data.screenProjectionMatrix();
-            mvp.translate(textureRect.x(), textureRect.y());
-            shader->setUniform(GLShader::ModelViewProjectionMatrix, mvp);
-            shader->setUniform(GLShader::ModulationConstant, QVector4D(rgb, rgb, rgb, a));
-            shader->setUniform(GLShader::Saturation, data.saturation());
-
-            cache->render(region, textureRect, hardwareClipping);
-
-            glDisable(GL_BLEND);
-
-            if (hardwareClipping) {
-                glDisable(GL_SCISSOR_TEST);
-            }
-
-            cache->unbind();
-            w->setData(LanczosCacheRole, QVariant::fromValue(static_cast<void*>(cache)));
+            CacheEntry entry;
+            entry.texture = cache;
+            m_cache.insert(w, entry);
+            paintCacheTexture(cache, region, textureRect, hardwareClipping, data);
 
             // Delete the offscreen surface after 5 seconds
             m_timer.start(5000, this);
@@ -382,6 +372,37 @@ void LanczosFilter::performPaint(EffectWindowImpl* w, int mask, QRegion region,
     w->sceneWindow()->performPaint(mask, region, data);
 } // End of function
 
+void LanczosFilter::paintCacheTexture(GLTexture *texture, const QRegion &region, const QRect &textureRect,
+                                      bool hardwareClipping, const WindowPaintData &data)
+{
+    texture->bind();
+    if (hardwareClipping) {
+        glEnable(GL_SCISSOR_TEST);
+    }
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    const qreal rgb = data.brightness() * data.opacity();
+    const qreal a = data.opacity();
+
+    ShaderBinder binder(ShaderTrait::MapTexture | ShaderTrait::Modulate | ShaderTrait::AdjustSaturation);
+    GLShader *shader = binder.shader();
+    QMatrix4x4 mvp = data.screenProjectionMatrix();
+    mvp.translate(textureRect.x(), textureRect.y());
+    shader->setUniform(GLShader::ModelViewProjectionMatrix, mvp);
+    shader->setUniform(GLShader::ModulationConstant, QVector4D(rgb, rgb, rgb, a));
+    shader->setUniform(GLShader::Saturation, data.saturation());
+
+    texture->render(region, textureRect, hardwareClipping);
+
+    glDisable(GL_BLEND);
+    if (hardwareClipping) {
+        glDisable(GL_SCISSOR_TEST);
+    }
+    texture->unbind();
+}
+
 void LanczosFilter::timerEvent(QTimerEvent *event)
 {
     if (event->timerId() == m_timer.timerId()) {
@@ -391,28 +412,25 @@ void LanczosFilter::timerEvent(QTimerEvent *event)
         delete m_offscreenTex;
         m_offscreenTarget = 0;
         m_offscreenTex = 0;
-        foreach (Client *c, Workspace::self()->clientList()) {
-            discardCacheTexture(c->effectWindow());
-        }
-        foreach (Client *c, Workspace::self()->desktopList()) {
-            discardCacheTexture(c->effectWindow());
-        }
-        foreach (Unmanaged *u, Workspace::self()->unmanagedList()) {
-            discardCacheTexture(u->effectWindow());
-        }
-        foreach (Deleted *d, Workspace::self()->deletedList()) {
-            discardCacheTexture(d->effectWindow());
-        }
+        discardCache();
     }
 }
 
 void LanczosFilter::discardCacheTexture(EffectWindow *w)
 {
-    QVariant cachedTextureVariant = w->data(LanczosCacheRole);
-    if (cachedTextureVariant.isValid()) {
-        delete static_cast< GLTexture*>(cachedTextureVariant.value<void*>());
-        w->setData(LanczosCacheRole, QVariant());
+    auto it = m_cache.find(w);
+    if (it != m_cache.end()) {
+        delete it->texture;
+        m_cache.erase(it);
+    }
+}
+
+void LanczosFilter::discardCache()
+{
+    for (auto it = m_cache.constBegin(); it != m_cache.constEnd(); ++it) {
+        delete it->texture;
     }
+    m_cache.clear();
 }
 
 void LanczosFilter::setUniforms()
@@ -24,12 +24,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QObject>
 #include <QBasicTimer>
+#include <QHash>
 #include <QVector>
 #include <QVector2D>
 #include <QVector4D>
 
 #include <kwinconfig.h>
 
+#include "scene.h"
+
 namespace KWin
 {
 
@@ -46,17 +49,34 @@ class LanczosFilter
     Q_OBJECT
 
 public:
-    explicit LanczosFilter(QObject* parent = 0);
+    explicit LanczosFilter(Scene::ThumbnailStatistics *statistics, QObject* parent = 0);
     ~LanczosFilter();
     void performPaint(EffectWindowImpl* w, int mask, QRegion region, WindowPaintData& data);
 
+    /**
+     * The number of thumbnails which get rendered into their cache texture per frame. Further
+     * outdated thumbnails keep showing their old content and get updated in a later frame.
+     **/
+    static const int MaximumUpdatesPerFrame = 4;
+
 protected:
     virtual void timerEvent(QTimerEvent*);
 private:
+    /**
+     * The downscaled, mipmapped rendering of a window. It gets shared by everything painting
+     * the window scaled down and is only rendered again after the window got damaged.
+     **/
+    struct CacheEntry {
+        GLTexture *texture = nullptr;
+        bool dirty = false;
+    };
     void init();
     void updateOffscreenSurfaces();
     void setUniforms();
     void discardCacheTexture(EffectWindow *w);
+    void discardCache();
+    void paintCacheTexture(GLTexture *texture, const QRegion &region, const QRect &textureRect,
+                           bool hardwareClipping, const WindowPaintData &data);
 
     void createKernel(float delta, int *kernelSize);
     void createOffsets(int count, float width, Qt::Orientation direction);
@@ -69,6 +89,10 @@ private:
     int m_uKernel;
     QVector2D m_offsets[16];
     QVector4D m_kernel[16];
+    QHash<EffectWindow*, CacheEntry> m_cache;
+    // thumbnails rendered in the current frame
+    int m_updates;
+    Scene::ThumbnailStatistics *m_statistics;
 };
 
 } // namespace
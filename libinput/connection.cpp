@@ -24,11 +24,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "../udev.h"
 #include "libinput_logging.h"
 
-#include <QMutexLocker>
 #include <QSocketNotifier>
 #include <QThread>
 
 #include <libinput.h>
+#include <time.h>
 
 namespace KWin
 {
@@ -40,6 +40,16 @@ QThread *Connection::s_thread = nullptr;
 
 static Context *s_context = nullptr;
 
+/**
+ * The current time in the clock domain of the libinput event times.
+ **/
+static quint32 currentTime()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return quint32(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
 Connection::Connection(QObject *parent)
     : Connection(nullptr, parent)
 {
@@ -71,9 +81,11 @@ Connection *Connection::create(QObject *parent)
         }
     }
     s_thread = new QThread();
+    s_thread->setObjectName(QStringLiteral("libinput"));
     s_self = new Connection(s_context);
     s_self->moveToThread(s_thread);
-    s_thread->start();
+    // input should be read even if the main thread is busy
+    s_thread->start(QThread::HighestPriority);
     QObject::connect(s_thread, &QThread::finished, s_self, &QObject::deleteLater);
     QObject::connect(s_thread, &QThread::finished, s_thread, &QObject::deleteLater);
     QObject::connect(parent, &QObject::destroyed, s_thread, &QThread::quit);
@@ -84,13 +96,15 @@ Connection::Connection(Context *input, QObject *parent)
     : QObject(parent)
     , m_input(input)
     , m_notifier(nullptr)
-    , m_mutex(QMutex::Recursive)
 {
     Q_ASSERT(m_input);
 }
 
 Connection::~Connection()
 {
+    while (Event *event = m_eventQueue.take()) {
+        delete event;
+    }
     s_self = nullptr;
     delete s_context;
     s_context = nullptr;
@@ -138,26 +152,43 @@ void Connection::deactivate()
 
 void Connection::handleEvent()
 {
-    QMutexLocker locker(&m_mutex);
-    const bool wasEmpty = m_eventQueue.isEmpty();
-    do {
-        m_input->dispatch();
-        Event *event = m_input->event();
-        if (!event) {
+    bool pushed = false;
+    bool drained = false;
+    while (!drained) {
+        while (!m_eventQueue.isFull()) {
+            m_input->dispatch();
+            Event *event = m_input->event();
+            if (!event) {
+                drained = true;
+                break;
+            }
+            m_eventQueue.push(event);
+            pushed = true;
+        }
+        if (drained) {
+            break;
+        }
+        // The ring is full, processEvents continues reading once it took Events out of it.
+        // If the main thread already did so in the meantime, continue directly.
+        m_readBlocked.storeRelease(1);
+        if (m_eventQueue.isFull() || !m_readBlocked.testAndSetOrdered(1, 0)) {
             break;
         }
-        m_eventQueue << event;
-    } while (true);
-    if (wasEmpty && !m_eventQueue.isEmpty()) {
+    }
+    if (pushed && m_drainScheduled.testAndSetOrdered(0, 1)) {
         emit eventsRead();
     }
 }
 
 void Connection::processEvents()
 {
-    QMutexLocker locker(&m_mutex);
-    while (!m_eventQueue.isEmpty()) {
-        QScopedPointer<Event> event(m_eventQueue.takeFirst());
+    // Events pushed from now on need another processEvents call
+    m_drainScheduled.storeRelease(0);
+    auto delivered = [this] (quint32 time) {
+        m_latency.record(currentTime() - time);
+    };
+    while (Event *e = m_eventQueue.take()) {
+        QScopedPointer<Event> event(e);
         switch (event->type()) {
             case LIBINPUT_EVENT_DEVICE_ADDED:
                 if (libinput_device_has_capability(event->device(), LIBINPUT_DEVICE_CAP_KEYBOARD)) {
@@ -202,6 +233,7 @@ void Connection::processEvents()
             case LIBINPUT_EVENT_KEYBOARD_KEY: {
                 KeyEvent *ke = static_cast<KeyEvent*>(event.data());
                 emit keyChanged(ke->key(), ke->state(), ke->time());
+                delivered(ke->time());
                 break;
             }
             case LIBINPUT_EVENT_POINTER_AXIS: {
@@ -219,62 +251,66 @@ void Connection::processEvents()
                     }
                 };
                 update(pe);
-                auto it = m_eventQueue.begin();
-                while (it != m_eventQueue.end()) {
-                    if ((*it)->type() == LIBINPUT_EVENT_POINTER_AXIS) {
-                        QScopedPointer<PointerEvent> p(static_cast<PointerEvent*>(*it));
-                        update(p.data());
-                        it = m_eventQueue.erase(it);
-                    } else {
+                while (Event *next = m_eventQueue.peek()) {
+                    if (next->type() != LIBINPUT_EVENT_POINTER_AXIS) {
                         break;
                     }
+                    QScopedPointer<PointerEvent> p(static_cast<PointerEvent*>(m_eventQueue.take()));
+                    update(p.data());
                 }
                 for (auto it = deltas.constBegin(); it != deltas.constEnd(); ++it) {
                     emit pointerAxisChanged(it.key(), it.value().delta, it.value().time);
                 }
+                // the oldest merged axis event waited longest
+                delivered(pe->time());
                 break;
             }
             case LIBINPUT_EVENT_POINTER_BUTTON: {
                 PointerEvent *pe = static_cast<PointerEvent*>(event.data());
                 emit pointerButtonChanged(pe->button(), pe->buttonState(), pe->time());
+                delivered(pe->time());
                 break;
             }
             case LIBINPUT_EVENT_POINTER_MOTION: {
                 PointerEvent *pe = static_cast<PointerEvent*>(event.data());
                 QPointF delta = pe->delta();
-                quint32 latestTime = pe->time();
-                auto it = m_eventQueue.begin();
-                while (it != m_eventQueue.end()) {
-                    if ((*it)->type() == LIBINPUT_EVENT_POINTER_MOTION) {
-                        QScopedPointer<PointerEvent> p(static_cast<PointerEvent*>(*it));
-                        delta += p->delta();
-                        latestTime = p->time();
-                        it = m_eventQueue.erase(it);
-                    } else {
+                const quint32 firstTime = pe->time();
+                quint32 latestTime = firstTime;
+                while (Event *next = m_eventQueue.peek()) {
+                    if (next->type() != LIBINPUT_EVENT_POINTER_MOTION) {
                         break;
                     }
+                    QScopedPointer<PointerEvent> p(static_cast<PointerEvent*>(m_eventQueue.take()));
+                    delta += p->delta();
+                    latestTime = p->time();
                 }
                 emit pointerMotion(delta, latestTime);
+                // the oldest merged motion event waited longest
+                delivered(firstTime);
                 break;
             }
             case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE: {
                 PointerEvent *pe = static_cast<PointerEvent*>(event.data());
                 emit pointerMotionAbsolute(pe->absolutePos(), pe->absolutePos(m_size), pe->time());
+                delivered(pe->time());
                 break;
             }
             case LIBINPUT_EVENT_TOUCH_DOWN: {
                 TouchEvent *te = static_cast<TouchEvent*>(event.data());
                 emit touchDown(te->id(), te->absolutePos(m_size), te->time());
+                delivered(te->time());
                 break;
             }
             case LIBINPUT_EVENT_TOUCH_UP: {
                 TouchEvent *te = static_cast<TouchEvent*>(event.data());
                 emit touchUp(te->id(), te->time());
+                delivered(te->time());
                 break;
             }
             case LIBINPUT_EVENT_TOUCH_MOTION: {
                 TouchEvent *te = static_cast<TouchEvent*>(event.data());
                 emit touchMotion(te->id(), te->absolutePos(m_size), te->time());
+                delivered(te->time());
                 break;
             }
             case LIBINPUT_EVENT_TOUCH_CANCEL: {
@@ -302,6 +338,10 @@ void Connection::processEvents()
         }
         wasSuspended = false;
     }
+    if (m_readBlocked.testAndSetOrdered(1, 0)) {
+        // the libinput thread stopped reading as the ring was full
+        QMetaObject::invokeMethod(this, "handleEvent", Qt::QueuedConnection);
+    }
 }
 
 void Connection::setScreenSize(const QSize &size)
@@ -21,12 +21,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define KWIN_LIBINPUT_CONNECTION_H
 
 #include "../input.h"
+#include "eventring.h"
 #include <kwinglobals.h>
 
 #include <QObject>
 #include <QSize>
-#include <QMutex>
-#include <QVector>
+#include <QAtomicInt>
 
 class QSocketNotifier;
 class QThread;
@@ -39,6 +39,50 @@ namespace LibInput
 class Event;
 class Context;
 
+/**
+ * @brief Histogram of the latency between the kernel timestamp of an input event and
+ * its delivery to the input filters.
+ *
+ * Bucket @c i counts latencies below 2^i milliseconds (and not counted in a previous bucket),
+ * the last bucket counts everything above.
+ **/
+class LatencyHistogram
+{
+public:
+    static const int BucketCount = 8;
+
+    void record(quint32 latency) {
+        int bucket = 0;
+        while (bucket < BucketCount - 1 && latency >= upperBound(bucket)) {
+            bucket++;
+        }
+        m_buckets[bucket]++;
+        m_count++;
+    }
+    void reset() {
+        for (int i = 0; i < BucketCount; ++i) {
+            m_buckets[i] = 0;
+        }
+        m_count = 0;
+    }
+    quint32 bucket(int index) const {
+        return m_buckets[index];
+    }
+    quint32 count() const {
+        return m_count;
+    }
+    /**
+     * @returns the exclusive upper bound of @p bucket in milliseconds
+     **/
+    static quint32 upperBound(int bucket) {
+        return 1u << bucket;
+    }
+
+private:
+    quint32 m_buckets[BucketCount] = {};
+    quint32 m_count = 0;
+};
+
 class Connection : public QObject
 {
     Q_OBJECT
@@ -66,8 +110,18 @@ public:
 
     void deactivate();
 
+    /**
+     * Delivers the Events read by the libinput thread, only to be called from the main thread.
+     **/
     void processEvents();
 
+    /**
+     * The latency of the Events delivered in processEvents.
+     **/
+    LatencyHistogram &latencyHistogram() {
+        return m_latency;
+    }
+
 Q_SIGNALS:
     void keyChanged(quint32 key, KWin::InputRedirection::KeyboardKeyState, quint32 time);
     void pointerButtonChanged(quint32 button, KWin::InputRedirection::PointerButtonState state, quint32 time);
@@ -87,10 +141,10 @@ Q_SIGNALS:
 
 private Q_SLOTS:
     void doSetup();
+    void handleEvent();
 
 private:
     Connection(Context *input, QObject *parent = nullptr);
-    void handleEvent();
     Context *m_input;
     QSocketNotifier *m_notifier;
     QSize m_size;
@@ -100,8 +154,12 @@ private:
     bool m_keyboardBeforeSuspend = false;
     bool m_pointerBeforeSuspend = false;
     bool m_touchBeforeSuspend = false;
-    QMutex m_mutex;
-    QVector<Event*> m_eventQueue;
+    EventRing m_eventQueue;
+    // whether eventsRead got emitted and processEvents did not yet start draining
+    QAtomicInt m_drainScheduled;
+    // whether the libinput thread stopped reading as the ring was full
+    QAtomicInt m_readBlocked;
+    LatencyHistogram m_latency;
     bool wasSuspended = false;
 
     KWIN_SINGLETON(Connection)
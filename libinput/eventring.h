@@ -0,0 +1,96 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_LIBINPUT_EVENTRING_H
+#define KWIN_LIBINPUT_EVENTRING_H
+
+#include <QAtomicInt>
+
+namespace KWin
+{
+namespace LibInput
+{
+
+class Event;
+
+/**
+ * @brief Lock free single producer single consumer ring of Events.
+ *
+ * The libinput thread is the only producer (push), the main thread the only
+ * consumer (peek, take). The ring does not take ownership of the Events.
+ **/
+class EventRing
+{
+public:
+    static const int Capacity = 1024;
+
+    bool isEmpty() const {
+        return m_head.loadAcquire() == m_tail.loadAcquire();
+    }
+    bool isFull() const {
+        return next(m_tail.loadAcquire()) == m_head.loadAcquire();
+    }
+    /**
+     * Only to be called by the producer and only if the ring is not full.
+     **/
+    void push(Event *event) {
+        const int tail = m_tail.loadAcquire();
+        m_events[tail] = event;
+        m_tail.storeRelease(next(tail));
+    }
+    /**
+     * Only to be called by the consumer.
+     * @returns the oldest Event without removing it or @c nullptr if the ring is empty
+     **/
+    Event *peek() const {
+        const int head = m_head.loadAcquire();
+        if (head == m_tail.loadAcquire()) {
+            return nullptr;
+        }
+        return m_events[head];
+    }
+    /**
+     * Only to be called by the consumer.
+     * @returns the oldest Event or @c nullptr if the ring is empty
+     **/
+    Event *take() {
+        const int head = m_head.loadAcquire();
+        if (head == m_tail.loadAcquire()) {
+            return nullptr;
+        }
+        Event *event = m_events[head];
+        m_head.storeRelease(next(head));
+        return event;
+    }
+
+private:
+    static int next(int index) {
+        return (index + 1) % Capacity;
+    }
+    Event *m_events[Capacity];
+    // index of the next Event to take, only written by the consumer
+    QAtomicInt m_head;
+    // index of the next Event to push, only written by the producer
+    QAtomicInt m_tail;
+};
+
+}
+}
+
+#endif
@@ -36,6 +36,7 @@ AniData::AniData()
  , customCurve(0) // Linear
  , time(0)
  , duration(0)
+ , frameProgress(0.0)
  , meta(0)
  , startTime(0)
  , windowType((NET::WindowTypeMask)0)
@@ -52,6 +53,7 @@ AniData::AniData(AnimationEffect::Attribute a, int meta_, int ms, const FPx2 &to
  , to(to_)
  , time(0)
  , duration(ms)
+ , frameProgress(0.0)
  , meta(meta_)
  , startTime(AnimationEffect::clock() + delay)
  , windowType((NET::WindowTypeMask)0)
@@ -68,6 +70,7 @@ AniData::AniData(const AniData &other)
  , to(other.to)
  , time(other.time)
  , duration(other.duration)
+ , frameProgress(other.frameProgress)
  , meta(other.meta)
  , startTime(other.startTime)
  , windowType(other.windowType)
@@ -110,6 +113,7 @@ AniData::AniData(const QString &str) // format: WindowMask:Attribute:Meta:Durati
  : customCurve(0) // Linear
  , time(0)
  , duration(1) // invalidate
+ , frameProgress(0.0)
 {
     const QVector<QStringRef> animation = str.splitRef(u':');
     if (animation.count() < 5)
@@ -48,6 +48,8 @@ public:
     int customCurve;
     FPx2 from, to;
     int time, duration;
+    // eased progress of the animation in the current frame, updated once per frame
+    float frameProgress;
     uint meta;
     qint64 startTime;
     NET::WindowTypeMask windowType;
@@ -44,6 +44,8 @@ public:
         m_justEndedAnimation = 0;
     }
     AnimationEffect::AniMap m_animations;
+    // maps the animation ids to the animated window for direct lookups in retarget and cancel
+    QHash<quint64, EffectWindow*> m_animationWindows;
     EffectWindowList m_zombies;
     bool m_animated, m_damageDirty, m_needSceneRepaint, m_animationsTouched, m_isInitialized;
     quint64 m_justEndedAnimation; // protect against cancel
@@ -91,6 +93,17 @@ bool AnimationEffect::isActive() const
     return !d->m_animations.isEmpty();
 }
 
+Effect::PaintHooks AnimationEffect::animationPaintHooks() const
+{
+    return PrePaintScreenHook | PostPaintScreenHook | PrePaintWindowHook | PaintWindowHook;
+}
+
+bool AnimationEffect::isAnimatedWindow(EffectWindow *w) const
+{
+    Q_D(const AnimationEffect);
+    return d->m_animations.contains(w);
+}
+
 
 #define RELATIVE_XY(_FIELD_) const bool relative[2] = { static_cast<bool>(metaData(Relative##_FIELD_##X, meta)), \
                                                         static_cast<bool>(metaData(Relative##_FIELD_##Y, meta)) }
@@ -236,11 +249,14 @@ quint64 AnimationEffect::p_animate( EffectWindow *w, Attribute a, uint meta, int
     }
     AniMap::iterator it = d->m_animations.find(w);
     if (it == d->m_animations.end())
-        it = d->m_animations.insert(w, QPair<QList<AniData>, QRect>(QList<AniData>(), QRect()));
+        it = d->m_animations.insert(w, QPair<QVector<AniData>, QRect>(QVector<AniData>(), QRect()));
     it->first.append(AniData(a, meta, ms, to, curve, delay, from, waitAtSource, keepAtTarget));
     quint64 ret_id = ++d->m_animCounter;
-    it->first.last().id = ret_id;
+    AniData &anim = it->first.last();
+    anim.id = ret_id;
+    anim.frameProgress = currentProgress(anim, clock());
     it->second = QRect();
+    d->m_animationWindows.insert(ret_id, w);
 
     d->m_animationsTouched = true;
 
@@ -261,17 +277,18 @@ bool AnimationEffect::retarget(quint64 animationId, FPx2 newTarget, int newRemai
     Q_D(AnimationEffect);
     if (animationId == d->m_justEndedAnimation)
         return false; // this is just ending, do not try to retarget it
-    for (AniMap::iterator entry = d->m_animations.begin(),
-                         mapEnd = d->m_animations.end(); entry != mapEnd; ++entry) {
-        for (QList<AniData>::iterator anim = entry->first.begin(),
-                                   animEnd = entry->first.end(); anim != animEnd; ++anim) {
-            if (anim->id == animationId) {
-                anim->from.set(interpolated(*anim, 0), interpolated(*anim, 1));
-                validate(anim->attribute, anim->meta, nullptr, &newTarget, entry.key());
-                anim->to.set(newTarget[0], newTarget[1]);
-                anim->duration = anim->time + newRemainingTime;
-                return true;
-            }
+    AniMap::iterator entry = d->m_animations.find(d->m_animationWindows.value(animationId));
+    if (entry == d->m_animations.end())
+        return false; // no animation found
+    for (QVector<AniData>::iterator anim = entry->first.begin(),
+                                 animEnd = entry->first.end(); anim != animEnd; ++anim) {
+        if (anim->id == animationId) {
+            anim->from.set(interpolated(*anim, 0), interpolated(*anim, 1));
+            validate(anim->attribute, anim->meta, nullptr, &newTarget, entry.key());
+            anim->to.set(newTarget[0], newTarget[1]);
+            anim->duration = anim->time + newRemainingTime;
+            anim->frameProgress = currentProgress(*anim, clock());
+            return true;
         }
     }
     return false; // no animation found
@@ -282,23 +299,25 @@ bool AnimationEffect::cancel(quint64 animationId)
     Q_D(AnimationEffect);
     if (animationId == d->m_justEndedAnimation)
         return true; // this is just ending, do not try to cancel it but fake success
-    for (AniMap::iterator entry = d->m_animations.begin(), mapEnd = d->m_animations.end(); entry != mapEnd; ++entry) {
-        for (QList<AniData>::iterator anim = entry->first.begin(), animEnd = entry->first.end(); anim != animEnd; ++anim) {
-            if (anim->id == animationId) {
-                entry->first.erase(anim); // remove the animation
-                if (entry->first.isEmpty()) { // no other animations on the window, release it.
-                    const int i = d->m_zombies.indexOf(entry.key());
-                    if ( i > -1 ) {
-                        d->m_zombies.removeAt( i );
-                        entry.key()->unrefWindow();
-                    }
-                    d->m_animations.erase(entry);
+    AniMap::iterator entry = d->m_animations.find(d->m_animationWindows.value(animationId));
+    if (entry == d->m_animations.end())
+        return false;
+    for (QVector<AniData>::iterator anim = entry->first.begin(), animEnd = entry->first.end(); anim != animEnd; ++anim) {
+        if (anim->id == animationId) {
+            entry->first.erase(anim); // remove the animation
+            d->m_animationWindows.remove(animationId);
+            if (entry->first.isEmpty()) { // no other animations on the window, release it.
+                const int i = d->m_zombies.indexOf(entry.key());
+                if ( i > -1 ) {
+                    d->m_zombies.removeAt( i );
+                    entry.key()->unrefWindow();
                 }
-                if (d->m_animations.isEmpty())
-                    disconnectGeometryChanges();
-                d->m_animationsTouched = true; // could be called from animationEnded
-                return true;
+                d->m_animations.erase(entry);
             }
+            if (d->m_animations.isEmpty())
+                disconnectGeometryChanges();
+            d->m_animationsTouched = true; // could be called from animationEnded
+            return true;
         }
     }
     return false;
@@ -313,15 +332,21 @@ void AnimationEffect::prePaintScreen( ScreenPrePaintData& data, int time )
     }
 
     d->m_animationsTouched = false;
-    AniMap::iterator entry = d->m_animations.begin(), mapEnd = d->m_animations.end();
     d->m_animated = false;
+    const qint64 now = clock();
+    // animationEnded might start new animations and thus rehash the animations, so we
+    // iterate over the windows animated at the begin of the frame
+    const QList<EffectWindow*> animatedWindows = d->m_animations.keys();
 //     short int transformed = 0;
-    while (entry != mapEnd) {
+    for (EffectWindow *animatedWindow : animatedWindows) {
+        AniMap::iterator entry = d->m_animations.find(animatedWindow);
+        if (entry == d->m_animations.end())
+            continue;
         bool invalidateLayerRect = false;
-        QList<AniData>::iterator anim = entry->first.begin(), animEnd = entry->first.end();
+        QVector<AniData>::iterator anim = entry->first.begin(), animEnd = entry->first.end();
         int animCounter = 0;
         while (anim != animEnd) {
-            if (anim->startTime > clock()) {
+            if (anim->startTime > now) {
                 if (!anim->waitAtSource) {
                     ++anim;
                     ++animCounter;
@@ -352,15 +377,14 @@ void AnimationEffect::prePaintScreen( ScreenPrePaintData& data, int time )
                 // so we've to restore the former states, ie. find our window list and animation
                 if (d->m_animationsTouched) {
                     d->m_animationsTouched = false;
-                    entry = d->m_animations.begin(), mapEnd = d->m_animations.end();
-                    while (entry.key() != oldW && entry != mapEnd)
-                        ++entry;
-                    Q_ASSERT(entry != mapEnd); // usercode should not delete animations from animationEnded (not even possible atm.)
+                    entry = d->m_animations.find(oldW);
+                    Q_ASSERT(entry != d->m_animations.end()); // usercode should not delete animations from animationEnded (not even possible atm.)
                     anim = entry->first.begin(), animEnd = entry->first.end();
                     Q_ASSERT(animCounter < entry->first.count());
                     for (int i = 0; i < animCounter; ++i)
                         ++anim;
                 }
+                d->m_animationWindows.remove(anim->id);
                 anim = entry->first.erase(anim);
                 invalidateLayerRect = d->m_damageDirty = true;
                 animEnd = entry->first.end();
@@ -374,12 +398,10 @@ void AnimationEffect::prePaintScreen( ScreenPrePaintData& data, int time )
             }
             data.paint |= entry->second;
 //             d->m_damageDirty = true; // TODO likely no longer required
-            entry = d->m_animations.erase(entry);
-            mapEnd = d->m_animations.end();
+            d->m_animations.erase(entry);
         } else {
             if (invalidateLayerRect)
                 *const_cast<QRect*>(&(entry->second)) = QRect(); // invalidate
-            ++entry;
         }
     }
 
@@ -393,6 +415,13 @@ void AnimationEffect::prePaintScreen( ScreenPrePaintData& data, int time )
         }
     }
 
+    // evaluate the easing curves of all animations once for this frame, the paint methods
+    // are invoked per window (and possibly several times per window) and just use the result
+    for (AniMap::iterator it = d->m_animations.begin(), end = d->m_animations.end(); it != end; ++it) {
+        for (QVector<AniData>::iterator anim = it->first.begin(), animEnd = it->first.end(); anim != animEnd; ++anim)
+            anim->frameProgress = currentProgress(*anim, now);
+    }
+
     effects->prePaintScreen(data, time);
 }
 
@@ -496,8 +525,9 @@ void AnimationEffect::prePaintWindow( EffectWindow* w, WindowPrePaintData& data,
         AniMap::const_iterator entry = d->m_animations.constFind( w );
         if ( entry != d->m_animations.constEnd() ) {
             bool isUsed = false;
-            for (QList<AniData>::const_iterator anim = entry->first.constBegin(); anim != entry->first.constEnd(); ++anim) {
-                if (anim->startTime > clock() && !anim->waitAtSource)
+            const qint64 now = clock();
+            for (QVector<AniData>::const_iterator anim = entry->first.constBegin(); anim != entry->first.constEnd(); ++anim) {
+                if (anim->startTime > now && !anim->waitAtSource)
                     continue;
 
                 isUsed = true;
@@ -540,9 +570,10 @@ void AnimationEffect::paintWindow( EffectWindow* w, int mask, QRegion region, Wi
     if ( d->m_animated ) {
         AniMap::const_iterator entry = d->m_animations.constFind( w );
         if ( entry != d->m_animations.constEnd() ) {
-            for ( QList<AniData>::const_iterator anim = entry->first.constBegin(); anim != entry->first.constEnd(); ++anim ) {
+            const qint64 now = clock();
+            for ( QVector<AniData>::const_iterator anim = entry->first.constBegin(); anim != entry->first.constEnd(); ++anim ) {
 
-                if (anim->startTime > clock() && !anim->waitAtSource)
+                if (anim->startTime > now && !anim->waitAtSource)
                     continue;
 
                 switch (anim->attribute) {
@@ -653,12 +684,13 @@ void AnimationEffect::postPaintScreen()
         if (d->m_needSceneRepaint) {
             effects->addRepaintFull();
         } else {
+            const qint64 now = clock();
             AniMap::const_iterator it = d->m_animations.constBegin(), end = d->m_animations.constEnd();
             for (; it != end; ++it) {
                 bool addRepaint = false;
-                QList<AniData>::const_iterator anim = it->first.constBegin();
+                QVector<AniData>::const_iterator anim = it->first.constBegin();
                 for (; anim != it->first.constEnd(); ++anim) {
-                    if (anim->startTime > clock())
+                    if (anim->startTime > now)
                         continue;
                     if (anim->time < anim->duration) {
                         addRepaint = true;
@@ -676,16 +708,21 @@ void AnimationEffect::postPaintScreen()
 
 float AnimationEffect::interpolated( const AniData &a, int i ) const
 {
-    if (a.startTime > clock())
+    if (a.frameProgress == 0.0)
         return a.from[i];
-    if (a.time < a.duration)
-        return a.from[i] + a.curve.valueForProgress( ((float)a.time)/a.duration )*(a.to[i] - a.from[i]);
-    return a.to[i]; // we're done and "waiting" at the target value
+    if (a.frameProgress == 1.0)
+        return a.to[i]; // we're done and "waiting" at the target value
+    return a.from[i] + a.frameProgress*(a.to[i] - a.from[i]);
 }
 
 float AnimationEffect::progress( const AniData &a ) const
 {
-    if (a.startTime > clock())
+    return a.frameProgress;
+}
+
+float AnimationEffect::currentProgress( const AniData &a, qint64 now )
+{
+    if (a.startTime > now)
         return 0.0;
     if (a.time < a.duration)
         return a.curve.valueForProgress( ((float)a.time)/a.duration );
@@ -791,6 +828,7 @@ void AnimationEffect::updateLayerRepaints()
 {
     Q_D(AnimationEffect);
     d->m_needSceneRepaint = false;
+    const qint64 now = clock();
     for (AniMap::const_iterator entry = d->m_animations.constBegin(), mapEnd = d->m_animations.constEnd(); entry != mapEnd; ++entry) {
         if (!entry->second.isNull())
             continue;
@@ -799,8 +837,8 @@ void AnimationEffect::updateLayerRepaints()
         bool createRegion = false;
         QList<QRect> rects;
         QRect *layerRect = const_cast<QRect*>(&(entry->second));
-        for (QList<AniData>::const_iterator anim = entry->first.constBegin(), animEnd = entry->first.constEnd(); anim != animEnd; ++anim) {
-            if (anim->startTime > clock())
+        for (QVector<AniData>::const_iterator anim = entry->first.constBegin(), animEnd = entry->first.constEnd(); anim != animEnd; ++anim) {
+            if (anim->startTime > now)
                 continue;
             switch (anim->attribute) {
                 case Opacity:
@@ -923,7 +961,12 @@ void AnimationEffect::_windowDeleted( EffectWindow* w )
 {
     Q_D(AnimationEffect);
     d->m_zombies.removeAll( w ); // TODO this line is a workaround for a bug in KWin 4.8.0 & 4.8.1
-    d->m_animations.remove( w );
+    AniMap::iterator entry = d->m_animations.find( w );
+    if (entry == d->m_animations.end())
+        return;
+    for (QVector<AniData>::const_iterator anim = entry->first.constBegin(); anim != entry->first.constEnd(); ++anim)
+        d->m_animationWindows.remove(anim->id);
+    d->m_animations.erase( entry );
 }
 
 
@@ -940,7 +983,7 @@ QString AnimationEffect::debug(const QString &/*parameter*/) const
             if (caption.isEmpty())
                 caption = QStringLiteral("[Untitled]");
             dbg += QLatin1String("Animating window: ") + caption + QLatin1Char('\n');
-            QList<AniData>::const_iterator anim = entry->first.constBegin(), animEnd = entry->first.constEnd();
+            QVector<AniData>::const_iterator anim = entry->first.constBegin(), animEnd = entry->first.constEnd();
             for (; anim != animEnd; ++anim)
                 dbg += anim->debugInfo();
         }
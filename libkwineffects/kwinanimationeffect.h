@@ -149,6 +149,18 @@ public:
     }
 
 protected:
+    /**
+     * The paint methods implemented by the AnimationEffect. A subclass which does not reimplement
+     * further paint methods can return these from paintHooks() to be skipped in the other chains.
+     * @since 5.7
+     */
+    PaintHooks animationPaintHooks() const;
+    /**
+     * @returns whether @p w has animations. A subclass which only paints animated windows can
+     * return this from isActiveForWindow().
+     * @since 5.7
+     */
+    bool isAnimatedWindow(EffectWindow *w) const;
     /**
      * The central function of this class - call it to create an animated transition of any supported attribute
      * @param w - The EffectWindow to manipulate
@@ -211,6 +223,7 @@ private:
     void clipWindow(const EffectWindow *, const AniData &, WindowQuadList &) const;
     float interpolated( const AniData&, int i = 0 ) const;
     float progress( const AniData& ) const;
+    static float currentProgress( const AniData&, qint64 now );
     void disconnectGeometryChanges();
     void updateLayerRepaints();
     void validate(Attribute a, uint &meta, FPx2 *from, FPx2 *to, const EffectWindow *w) const;
@@ -222,7 +235,7 @@ private Q_SLOTS:
     void _expandedGeometryChanged(KWin::EffectWindow *w, const QRect &old);
 private:
     static QElapsedTimer s_clock;
-    typedef QMap< EffectWindow*, QPair<QList<AniData>, QRect> > AniMap;
+    typedef QHash< EffectWindow*, QPair<QVector<AniData>, QRect> > AniMap;
     AnimationEffectPrivate * const d_ptr;
     Q_DECLARE_PRIVATE(AnimationEffect)
 };
@@ -609,6 +609,16 @@ bool Effect::isActive() const
     return true;
 }
 
+Effect::PaintHooks Effect::paintHooks() const
+{
+    return AllPaintHooks;
+}
+
+bool Effect::isActiveForWindow(EffectWindow *) const
+{
+    return true;
+}
+
 QString Effect::debug(const QString &) const
 {
     return QString();
@@ -1383,6 +1393,29 @@ WindowQuadList WindowQuadList::filterOut(WindowQuadType type) const
     return *this; // nothing to filter out
 }
 
+WindowQuadList WindowQuadList::clipped(const QVector<QRectF> &rects) const
+{
+    WindowQuadList ret;
+    ret.reserve(count());
+    // split all quads in bounding rect with the actual rects
+    foreach (const WindowQuad & quad, *this) {
+        const QRectF quadRect(QPointF(quad.left(), quad.top()), QPointF(quad.right(), quad.bottom()));
+        foreach (const QRectF & r, rects) {
+            const QRectF &intersected = r.intersected(quadRect);
+            if (intersected.isValid()) {
+                if (quadRect == intersected) {
+                    // case 1: completely contains, include and do not check other rects
+                    ret.append(quad);
+                    break;
+                }
+                // case 2: intersection
+                ret.append(quad.makeSubQuad(intersected.left(), intersected.top(), intersected.right(), intersected.bottom()));
+            }
+        }
+    }
+    return ret;
+}
+
 bool WindowQuadList::smoothNeeded() const
 {
     foreach (const WindowQuad & q, *this)
@@ -182,7 +182,7 @@ X-KDE-Library=kwin4_effect_cooleffect
 
 #define KWIN_EFFECT_API_MAKE_VERSION( major, minor ) (( major ) << 8 | ( minor ))
 #define KWIN_EFFECT_API_VERSION_MAJOR 0
-#define KWIN_EFFECT_API_VERSION_MINOR 224
+#define KWIN_EFFECT_API_VERSION_MINOR 225
 #define KWIN_EFFECT_API_VERSION KWIN_EFFECT_API_MAKE_VERSION( \
         KWIN_EFFECT_API_VERSION_MAJOR, KWIN_EFFECT_API_VERSION_MINOR )
 
@@ -518,6 +518,51 @@ public:
      **/
     virtual bool isActive() const;
 
+    /**
+     * Flags describing the chained paint methods an Effect reimplements.
+     * @see paintHooks
+     * @since 5.7
+     **/
+    enum PaintHook {
+        PrePaintScreenHook = 1 << 0,
+        PaintScreenHook = 1 << 1,
+        PostPaintScreenHook = 1 << 2,
+        PrePaintWindowHook = 1 << 3,
+        PaintWindowHook = 1 << 4,
+        PostPaintWindowHook = 1 << 5,
+        DrawWindowHook = 1 << 6,
+        PaintEffectFrameHook = 1 << 7,
+        ScreenPaintHooks = PrePaintScreenHook | PaintScreenHook | PostPaintScreenHook,
+        WindowPaintHooks = PrePaintWindowHook | PaintWindowHook | PostPaintWindowHook | DrawWindowHook,
+        AllPaintHooks = ScreenPaintHooks | WindowPaintHooks | PaintEffectFrameHook
+    };
+    Q_DECLARE_FLAGS(PaintHooks, PaintHook)
+
+    /**
+     * Reimplement this method to indicate which of the chained paint methods the Effect
+     * reimplements. While the Effect is active it is only put into the chains of the
+     * returned hooks, all other chained methods of the Effect are skipped.
+     *
+     * Like isActive this method is called directly before the paint loop begins, so it
+     * should not perform complex calculations.
+     *
+     * The default implementation returns @c AllPaintHooks.
+     * @since 5.7
+     **/
+    virtual PaintHooks paintHooks() const;
+
+    /**
+     * Reimplement this method to indicate whether the window paint methods (prePaintWindow,
+     * paintWindow, postPaintWindow and drawWindow) of the Effect need to be called for
+     * @p w. If @c false is returned the Effect is skipped in the window chains for @p w.
+     *
+     * The returned value must not change for a window during one paint pass.
+     *
+     * The default implementation returns @c true.
+     * @since 5.7
+     **/
+    virtual bool isActiveForWindow(EffectWindow *w) const;
+
     /**
      * Reimplement this method to provide online debugging.
      * This could be as trivial as printing specific detail informations about the effect state
@@ -2044,6 +2089,14 @@ public:
     WindowQuadList makeRegularGrid(int xSubdivisions, int ySubdivisions) const;
     WindowQuadList select(WindowQuadType type) const;
     WindowQuadList filterOut(WindowQuadType type) const;
+    /**
+     * Clips the quads to @p rects, which are given in the coordinate system of the quads
+     * and must not overlap. Quads fully inside one rect are kept, all others are split
+     * into one sub quad per intersecting rect.
+     * Like splitting, this is only allowed for untransformed quads.
+     * @since 5.7
+     **/
+    WindowQuadList clipped(const QVector<QRectF> &rects) const;
     bool smoothNeeded() const;
     void makeInterleavedArrays(unsigned int type, GLVertex2D *vertices, const QMatrix4x4 &matrix) const;
     void makeArrays(float** vertices, float** texcoords, const QSizeF &size, bool yInverted) const;
@@ -3182,6 +3235,7 @@ int Effect::animationTime(int defaultDuration)
 }
 
 } // namespace
+Q_DECLARE_OPERATORS_FOR_FLAGS(KWin::Effect::PaintHooks)
 Q_DECLARE_METATYPE(KWin::EffectWindow*)
 Q_DECLARE_METATYPE(QList<KWin::EffectWindow*>)
 
@@ -33,7 +33,17 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QPixmap>
 #include <QImage>
 #include <QHash>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QVector>
 #include <QVector2D>
 #include <QVector3D>
 #include <QVector4D>
@@ -44,6 +54,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <deque>
 
 #include <math.h>
+#include <string.h>
+#include <utime.h>
 
 #if HAVE_EPOXY_GLX
 #include <epoxy/glx.h>
@@ -231,6 +243,20 @@ int nearestPowerOfTwo(int x)
 
 bool GLShader::sColorCorrect = false;
 
+// the program which is current in the GL context, binding it again is a no-op
+static GLuint s_boundProgram = 0;
+static ShaderManager::StateStatistics s_stateStatistics;
+// uniforms beyond this location are rare enough to not be worth caching
+static const int s_maxCachedUniformLocation = 255;
+
+// the values last set for a uniform location, the program keeps them till it is linked again
+struct CachedUniform {
+    GLfloat values[16];
+    int count = 0;
+};
+// kept aside by program name instead of in GLShader to not change the size of the exported class
+static QHash<GLuint, QVector<CachedUniform>> s_uniformCaches;
+
 GLShader::GLShader(unsigned int flags)
     : mValid(false)
     , mLocationsResolved(false)
@@ -251,6 +277,12 @@ GLShader::GLShader(const QString& vertexfile, const QString& fragmentfile, unsig
 GLShader::~GLShader()
 {
     if (mProgram) {
+        if (s_boundProgram == mProgram) {
+            // the deletion would be deferred while the program is in use and its name could be reused
+            glUseProgram(0);
+            s_boundProgram = 0;
+        }
+        s_uniformCaches.remove(mProgram);
         glDeleteProgram(mProgram);
     }
 }
@@ -279,6 +311,8 @@ bool GLShader::link()
     // Be optimistic
     mValid = true;
 
+    // linking resets all uniforms
+    s_uniformCaches.remove(mProgram);
     glLinkProgram(mProgram);
 
     // Get the program info log
@@ -407,12 +441,19 @@ void GLShader::bindFragDataLocation(const char *name, int index)
 
 void GLShader::bind()
 {
+    s_stateStatistics.programBinds++;
+    if (s_boundProgram == mProgram) {
+        s_stateStatistics.redundantProgramBinds++;
+        return;
+    }
     glUseProgram(mProgram);
+    s_boundProgram = mProgram;
 }
 
 void GLShader::unbind()
 {
     glUseProgram(0);
+    s_boundProgram = 0;
 }
 
 void GLShader::resolveLocations()
@@ -530,9 +571,29 @@ bool GLShader::setUniform(const char *name, const QColor& color)
     return setUniform(location, color);
 }
 
+bool GLShader::updateUniformCache(int location, const GLfloat *values, int count)
+{
+    s_stateStatistics.uniformUpdates++;
+    if (location > s_maxCachedUniformLocation) {
+        return true;
+    }
+    QVector<CachedUniform> &cache = s_uniformCaches[mProgram];
+    if (location >= cache.size()) {
+        cache.resize(location + 1);
+    }
+    CachedUniform &cached = cache[location];
+    if (cached.count == count && memcmp(cached.values, values, count * sizeof(GLfloat)) == 0) {
+        s_stateStatistics.redundantUniformUpdates++;
+        return false;
+    }
+    memcpy(cached.values, values, count * sizeof(GLfloat));
+    cached.count = count;
+    return true;
+}
+
 bool GLShader::setUniform(int location, float value)
 {
-    if (location >= 0) {
+    if (location >= 0 && updateUniformCache(location, &value, 1)) {
         glUniform1f(location, value);
     }
     return (location >= 0);
@@ -540,7 +601,11 @@ bool GLShader::setUniform(int location, float value)
 
 bool GLShader::setUniform(int location, int value)
 {
-    if (location >= 0) {
+    // only compared bitwise, an int fits into the storage of a float
+    GLfloat bits;
+    static_assert(sizeof(bits) == sizeof(value), "int and float need the same size");
+    memcpy(&bits, &value, sizeof(bits));
+    if (location >= 0 && updateUniformCache(location, &bits, 1)) {
         glUniform1i(location, value);
     }
     return (location >= 0);
@@ -548,7 +613,7 @@ bool GLShader::setUniform(int location, int value)
 
 bool GLShader::setUniform(int location, const QVector2D &value)
 {
-    if (location >= 0) {
+    if (location >= 0 && updateUniformCache(location, (const GLfloat*)&value, 2)) {
         glUniform2fv(location, 1, (const GLfloat*)&value);
     }
     return (location >= 0);
@@ -556,7 +621,7 @@ bool GLShader::setUniform(int location, const QVector2D &value)
 
 bool GLShader::setUniform(int location, const QVector3D &value)
 {
-    if (location >= 0) {
+    if (location >= 0 && updateUniformCache(location, (const GLfloat*)&value, 3)) {
         glUniform3fv(location, 1, (const GLfloat*)&value);
     }
     return (location >= 0);
@@ -564,7 +629,7 @@ bool GLShader::setUniform(int location, const QVector3D &value)
 
 bool GLShader::setUniform(int location, const QVector4D &value)
 {
-    if (location >= 0) {
+    if (location >= 0 && updateUniformCache(location, (const GLfloat*)&value, 4)) {
         glUniform4fv(location, 1, (const GLfloat*)&value);
     }
     return (location >= 0);
@@ -579,7 +644,9 @@ bool GLShader::setUniform(int location, const QMatrix4x4 &value)
         for (int i = 0; i < 16; ++i) {
             m[i] = data[i];
         }
-        glUniformMatrix4fv(location, 1, GL_FALSE, m);
+        if (updateUniformCache(location, m, 16)) {
+            glUniformMatrix4fv(location, 1, GL_FALSE, m);
+        }
     }
     return (location >= 0);
 }
@@ -587,7 +654,10 @@ bool GLShader::setUniform(int location, const QMatrix4x4 &value)
 bool GLShader::setUniform(int location, const QColor &color)
 {
     if (location >= 0) {
-        glUniform4f(location, color.redF(), color.greenF(), color.blueF(), color.alphaF());
+        const GLfloat values[] = { GLfloat(color.redF()), GLfloat(color.greenF()), GLfloat(color.blueF()), GLfloat(color.alphaF()) };
+        if (updateUniformCache(location, values, 4)) {
+            glUniform4fv(location, 1, values);
+        }
     }
     return (location >= 0);
 }
@@ -641,6 +711,15 @@ void ShaderManager::cleanup()
 {
     delete s_shaderManager;
     s_shaderManager = nullptr;
+    // the next context starts without a program and with fresh counters
+    s_boundProgram = 0;
+    s_stateStatistics = StateStatistics();
+    s_uniformCaches.clear();
+}
+
+const ShaderManager::StateStatistics &ShaderManager::stateStatistics()
+{
+    return s_stateStatistics;
 }
 
 ShaderManager::ShaderManager()
@@ -653,6 +732,8 @@ ShaderManager::ShaderManager()
     } else {
         m_resourcePath = QStringLiteral(":/effect-shaders-1.10/");
     }
+
+    initProgramCache();
 }
 
 ShaderManager::~ShaderManager()
@@ -661,6 +742,15 @@ ShaderManager::~ShaderManager()
         popShader();
     }
 
+    const ProgramCacheStatistics &cache = m_programCacheStatistics;
+    if (cache.hits > 0 || cache.misses > 0) {
+        qCDebug(LIBKWINGLUTILS) << "Program cache:" << cache.hits << "hits," << cache.misses << "misses,"
+                                << cache.discarded << "discarded,"
+                                << "compiled in" << cache.compileTime / 1000000 << "ms,"
+                                << "loaded binaries in" << cache.binaryLoadTime / 1000000 << "ms,"
+                                << "saved about" << cache.savedCompileTime / 1000000 << "ms of compiling";
+    }
+
     qDeleteAll(m_shaderHash);
     m_shaderHash.clear();
 }
@@ -1002,16 +1092,191 @@ GLShader *ShaderManager::generateCustomShader(ShaderTraits traits, const QByteAr
 #endif
 
     GLShader *shader = new GLShader(GLShader::ExplicitLinking);
+    const QByteArray key = programCacheKey(traits, vertex, fragment);
+    if (!key.isEmpty() && loadProgramBinary(shader, key)) {
+        return shader;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
     shader->load(vertex, fragment);
 
     shader->bindAttributeLocation("position", VA_Position);
     shader->bindAttributeLocation("texcoord", VA_TexCoord);
     shader->bindFragDataLocation("fragColor", 0);
 
+    if (!key.isEmpty()) {
+        glProgramParameteri(shader->mProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     shader->link();
+    const qint64 compileTime = timer.nsecsElapsed();
+    m_programCacheStatistics.compileTime += compileTime;
+    if (!key.isEmpty() && shader->isValid()) {
+        storeProgramBinary(shader, key, compileTime);
+    }
     return shader;
 }
 
+// bump whenever the layout of the cache files changes
+static const quint32 s_programCacheMagic = 0x4b57474c;
+static const quint32 s_programCacheVersion = 2;
+
+// cached programs which have not been used for that many days get removed, e.g. those of a previous driver
+static const int s_programCacheMaxAge = 30;
+
+static void pruneProgramCache(const QString &path)
+{
+    const QDateTime oldest = QDateTime::currentDateTime().addDays(-s_programCacheMaxAge);
+    QDirIterator it(path, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        if (it.fileInfo().lastModified() < oldest) {
+            qCDebug(LIBKWINGLUTILS) << "Removing unused cached program" << it.filePath();
+            QFile::remove(it.filePath());
+        }
+    }
+    // rmdir only removes the directories of drivers without any program left
+    QDir dir(path);
+    for (const QString &driver : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        dir.rmdir(driver);
+    }
+}
+
+void ShaderManager::initProgramCache()
+{
+    if (qstrcmp(qgetenv("KWIN_GL_PROGRAM_CACHE"), "0") == 0) {
+        return;
+    }
+    const bool supported = GLPlatform::instance()->isGLES() ? hasGLVersion(3, 0)
+                                                            : (hasGLVersion(4, 1) || hasGLExtension(QByteArrayLiteral("GL_ARB_get_program_binary")));
+    if (!supported) {
+        return;
+    }
+    // a driver might support the extension without offering any format, e.g. Mesa without its shader cache
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        return;
+    }
+    // a binary is only valid for the exact driver it got created with, the programs are stored
+    // per driver and the identity is stored along with the binary, so that a cached program of
+    // a different driver or GL version never gets loaded
+    m_driverIdentity = QByteArray(reinterpret_cast<const char*>(glGetString(GL_VENDOR))) + '\n' +
+                       QByteArray(reinterpret_cast<const char*>(glGetString(GL_RENDERER))) + '\n' +
+                       QByteArray(reinterpret_cast<const char*>(glGetString(GL_VERSION))) + '\n' +
+                       GLPlatform::instance()->glShadingLanguageVersionString();
+    const QString cachePath = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/kwin/glprograms/");
+    pruneProgramCache(cachePath);
+    const QString path = cachePath + QString::fromLatin1(QCryptographicHash::hash(m_driverIdentity, QCryptographicHash::Sha1).toHex()) + QLatin1Char('/');
+    if (!QDir().mkpath(path)) {
+        qCWarning(LIBKWINGLUTILS) << "Cannot create the program cache in" << path;
+        return;
+    }
+    m_programCachePath = path;
+    m_programCacheStatistics.enabled = true;
+}
+
+const ShaderManager::ProgramCacheStatistics &ShaderManager::programCacheStatistics() const
+{
+    return m_programCacheStatistics;
+}
+
+QByteArray ShaderManager::programCacheKey(ShaderTraits traits, const QByteArray &vertexSource, const QByteArray &fragmentSource) const
+{
+    if (m_programCachePath.isEmpty()) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    // the prepared sources depend on the debug and color correction flags
+    const quint32 flags = (m_debug ? 1 : 0) | (GLShader::sColorCorrect ? 2 : 0);
+    const quint32 values[] = { quint32(traits), flags, quint32(vertexSource.size()) };
+    hash.addData(reinterpret_cast<const char*>(values), sizeof(values));
+    hash.addData(vertexSource);
+    hash.addData(fragmentSource);
+    return hash.result().toHex();
+}
+
+bool ShaderManager::loadProgramBinary(GLShader *shader, const QByteArray &key)
+{
+    QFile file(m_programCachePath + QString::fromLatin1(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_programCacheStatistics.misses++;
+        return false;
+    }
+    QElapsedTimer timer;
+    timer.start();
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray driverIdentity;
+    quint32 format = 0;
+    qint64 compileTime = 0;
+    QByteArray binary;
+    stream >> magic >> version;
+    if (magic == s_programCacheMagic && version == s_programCacheVersion) {
+        stream >> driverIdentity >> format >> compileTime >> binary;
+    }
+    bool valid = stream.status() == QDataStream::Ok && magic == s_programCacheMagic &&
+                 version == s_programCacheVersion && driverIdentity == m_driverIdentity && !binary.isEmpty();
+    if (valid) {
+        // loading a binary links the program again
+        s_uniformCaches.remove(shader->mProgram);
+        glProgramBinary(shader->mProgram, format, binary.constData(), binary.size());
+        GLint status = GL_FALSE;
+        glGetProgramiv(shader->mProgram, GL_LINK_STATUS, &status);
+        valid = status == GL_TRUE;
+    }
+    if (!valid) {
+        // corrupt, of another driver or rejected by the driver, start over with a fresh program
+        // and compile it, storing it replaces the cached program
+        qCDebug(LIBKWINGLUTILS) << "Discarding cached program" << file.fileName();
+        file.remove();
+        glDeleteProgram(shader->mProgram);
+        shader->mProgram = glCreateProgram();
+        m_programCacheStatistics.misses++;
+        m_programCacheStatistics.discarded++;
+        return false;
+    }
+    shader->mValid = true;
+    // the modification time tells when the program got used last, keep it from being pruned
+    if (QFileInfo(file).lastModified().daysTo(QDateTime::currentDateTime()) > 0) {
+        utime(QFile::encodeName(file.fileName()).constData(), nullptr);
+    }
+
+    const qint64 loadTime = timer.nsecsElapsed();
+    m_programCacheStatistics.binaryLoadTime += loadTime;
+    m_programCacheStatistics.savedCompileTime += qMax(compileTime - loadTime, qint64(0));
+    m_programCacheStatistics.hits++;
+    return true;
+}
+
+void ShaderManager::storeProgramBinary(GLShader *shader, const QByteArray &key, qint64 compileTime)
+{
+    GLint length = 0;
+    glGetProgramiv(shader->mProgram, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    QByteArray binary(length, Qt::Uninitialized);
+    GLenum format = 0;
+    glGetProgramBinary(shader->mProgram, length, &length, &format, binary.data());
+    if (length <= 0) {
+        return;
+    }
+    binary.resize(length);
+
+    QSaveFile file(m_programCachePath + QString::fromLatin1(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    stream << s_programCacheMagic << s_programCacheVersion << m_driverIdentity << quint32(format) << compileTime << binary;
+    if (!file.commit()) {
+        qCWarning(LIBKWINGLUTILS) << "Failed to write cached program" << file.fileName();
+    }
+}
+
 GLShader *ShaderManager::generateShaderFromResources(ShaderTraits traits, const QString &vertexFile, const QString &fragmentFile)
 {
     auto loadShaderFile = [this] (const QString &fileName) {
@@ -1822,6 +2087,7 @@ public:
     VertexAttrib attrib[VertexAttributeCount];
     Bitfield enabledArrays;
     static IndexBuffer *s_indexBuffer;
+    static quint64 s_drawCalls;
 };
 
 bool GLVertexBufferPrivate::hasMapBufferRange = false;
@@ -1830,6 +2096,7 @@ GLVertexBuffer *GLVertexBufferPrivate::streamingBuffer = nullptr;
 bool GLVertexBufferPrivate::haveBufferStorage = false;
 bool GLVertexBufferPrivate::haveSyncFences = false;
 IndexBuffer *GLVertexBufferPrivate::s_indexBuffer = nullptr;
+quint64 GLVertexBufferPrivate::s_drawCalls = 0;
 
 void GLVertexBufferPrivate::interleaveArrays(float *dst, int dim,
                                              const float *vertices, const float *texcoords,
@@ -2191,11 +2458,13 @@ void GLVertexBuffer::draw(const QRegion &region, GLenum primitiveMode, int first
 
         if (!hardwareClipping) {
             glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_SHORT, nullptr, first);
+            GLVertexBufferPrivate::s_drawCalls++;
         } else {
             // Clip using scissoring
             foreach (const QRect &r, region.rects()) {
                 glScissor(r.x(), s_virtualScreenSize.height() - r.y() - r.height(), r.width(), r.height());
                 glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_SHORT, nullptr, first);
+                GLVertexBufferPrivate::s_drawCalls++;
             }
         }
         return;
@@ -2203,15 +2472,22 @@ void GLVertexBuffer::draw(const QRegion &region, GLenum primitiveMode, int first
 
     if (!hardwareClipping) {
         glDrawArrays(primitiveMode, first, count);
+        GLVertexBufferPrivate::s_drawCalls++;
     } else {
         // Clip using scissoring
         foreach (const QRect &r, region.rects()) {
             glScissor(r.x(), s_virtualScreenSize.height() - r.y() - r.height(), r.width(), r.height());
             glDrawArrays(primitiveMode, first, count);
+            GLVertexBufferPrivate::s_drawCalls++;
         }
     }
 }
 
+quint64 GLVertexBuffer::drawCallCount()
+{
+    return GLVertexBufferPrivate::s_drawCalls;
+}
+
 bool GLVertexBuffer::supportsIndexedQuads()
 {
     return GLVertexBufferPrivate::supportsIndexedQuads;
@@ -185,6 +185,12 @@ protected:
     void resolveLocations();
 
 private:
+    /**
+     * Remembers the @p values of the uniform at @p location.
+     * @returns @c false if the uniform already has these values and the GL call can be skipped
+     **/
+    bool updateUniformCache(int location, const GLfloat *values, int count);
+
     unsigned int mProgram;
     bool mValid:1;
     bool mLocationsResolved:1;
@@ -293,6 +299,10 @@ public:
      * So if both @p vertesSource and @p fragmentSource are provided the @p traits are ignored.
      * If neither are provided a new shader following the @p traits is generated.
      *
+     * If the driver supports program binaries the linked program is cached on disk and
+     * reused instead of compiling the same sources again. The cache can be disabled by
+     * setting the environment variable KWIN_GL_PROGRAM_CACHE to 0.
+     *
      * @param traits The shader traits for generating the shader
      * @param vertesSource optional vertex shader source code to be used instead of shader traits
      * @param fragmentSource optional fragment shader source code to be used instead of shader traits
@@ -330,6 +340,44 @@ public:
      */
     bool selfTest();
 
+    /**
+     * Counters of the state changes requested through GLShader and ShaderManager
+     * and how many of them got skipped because the state was already set.
+     * @since 5.7
+     **/
+    struct StateStatistics {
+        quint64 uniformUpdates = 0;
+        quint64 redundantUniformUpdates = 0;
+        quint64 programBinds = 0;
+        quint64 redundantProgramBinds = 0;
+    };
+    /**
+     * @returns the state change counters of the current OpenGL context
+     * @since 5.7
+     **/
+    static const StateStatistics &stateStatistics();
+
+    /**
+     * Counters and timings of the program binary cache, all times are in nanoseconds.
+     * @since 5.7
+     **/
+    struct ProgramCacheStatistics {
+        // whether the driver supports program binaries and the cache is used
+        bool enabled = false;
+        int hits = 0;
+        int misses = 0;
+        // cached programs which were corrupt, of a different driver or rejected by the driver
+        int discarded = 0;
+        qint64 compileTime = 0;
+        qint64 binaryLoadTime = 0;
+        qint64 savedCompileTime = 0;
+    };
+    /**
+     * @returns the program binary cache counters since this ShaderManager got created
+     * @since 5.7
+     **/
+    const ProgramCacheStatistics &programCacheStatistics() const;
+
     /**
      * @return a pointer to the ShaderManager instance
      **/
@@ -351,10 +399,19 @@ private:
     QByteArray generateFragmentSource(ShaderTraits traits) const;
     GLShader *generateShader(ShaderTraits traits);
 
+    void initProgramCache();
+    QByteArray programCacheKey(ShaderTraits traits, const QByteArray &vertexSource, const QByteArray &fragmentSource) const;
+    bool loadProgramBinary(GLShader *shader, const QByteArray &key);
+    void storeProgramBinary(GLShader *shader, const QByteArray &key, qint64 compileTime);
+
     QStack<GLShader*> m_boundShaders;
     QHash<ShaderTraits, GLShader *> m_shaderHash;
     bool m_debug;
     QString m_resourcePath;
+    // directory of the program binary cache, empty if the cache is not used
+    QString m_programCachePath;
+    QByteArray m_driverIdentity;
+    ProgramCacheStatistics m_programCacheStatistics;
     static ShaderManager *s_shaderManager;
 };
 
@@ -749,6 +806,12 @@ public:
      **/
     static GLVertexBuffer *streamingBuffer();
 
+    /**
+     * @returns the number of draw calls issued by all GLVertexBuffers so far
+     * @since 5.7
+     **/
+    static quint64 drawCallCount();
+
     /**
      * Sets the virtual screen size to @p s.
      * @since 5.2
@@ -31,6 +31,22 @@ namespace KWin
 namespace QPA
 {
 
+/**
+ * Copies @p region from @p source to @p target, both being ARGB32 images of @p size.
+ **/
+static void copyRegion(uchar *target, const uchar *source, const QRegion &region, const QSize &size)
+{
+    const int stride = size.width() * 4;
+    const QRegion r = region & QRect(QPoint(0, 0), size);
+    for (const QRect &rect : r.rects()) {
+        const int offset = rect.x() * 4;
+        const int bytes = rect.width() * 4;
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            memcpy(target + y * stride + offset, source + y * stride + offset, bytes);
+        }
+    }
+}
+
 BackingStore::BackingStore(QWindow *w, KWayland::Client::ShmPool *shm)
     : QPlatformBackingStore(w)
     , m_shm(shm)
@@ -38,11 +54,11 @@ BackingStore::BackingStore(QWindow *w, KWayland::Client::ShmPool *shm)
 {
     QObject::connect(m_shm, &KWayland::Client::ShmPool::poolResized,
         [this] {
-            if (!m_buffer) {
+            if (m_current == -1) {
                 return;
             }
-            auto b = m_buffer.toStrongRef();
-            if (!b->isUsed()){
+            auto b = m_buffers.at(m_current).buffer.toStrongRef();
+            if (!b || !b->isUsed()){
                 return;
             }
             const QSize size = m_backBuffer.size();
@@ -58,58 +74,117 @@ QPaintDevice *BackingStore::paintDevice()
     return &m_backBuffer;
 }
 
+void BackingStore::releaseBuffers()
+{
+    for (const PoolBuffer &buffer : m_buffers) {
+        if (auto b = buffer.buffer.toStrongRef()) {
+            b->setUsed(false);
+        }
+    }
+    m_buffers.clear();
+    m_current = -1;
+}
+
 void BackingStore::resize(const QSize &size, const QRegion &staticContents)
 {
     Q_UNUSED(staticContents)
     m_size = size;
-    if (!m_buffer) {
-        return;
-    }
-    m_buffer.toStrongRef()->setUsed(false);
-    m_buffer.clear();
+    releaseBuffers();
 }
 
 void BackingStore::flush(QWindow *window, const QRegion &region, const QPoint &offset)
 {
-    Q_UNUSED(region)
-    Q_UNUSED(offset)
+    if (m_current == -1) {
+        return;
+    }
     auto s = static_cast<Window *>(window->handle())->surface();
-    s->attachBuffer(m_buffer);
-    // TODO: proper damage region
-    s->damage(QRect(QPoint(0, 0), m_backBuffer.size()));
+    s->attachBuffer(m_buffers.at(m_current).buffer);
+    s->damage(region.translated(offset));
     s->commit(KWayland::Client::Surface::CommitFlag::None);
     waylandServer()->internalClientConection()->flush();
     waylandServer()->dispatch();
 }
 
-void BackingStore::beginPaint(const QRegion&)
+void BackingStore::beginPaint(const QRegion &region)
 {
-    if (m_buffer) {
-        auto b = m_buffer.toStrongRef();
-        if (b->isReleased()) {
+    // drop buffers the pool took away from us
+    for (int i = 0; i < m_buffers.count();) {
+        if (!m_buffers.at(i).buffer) {
+            m_buffers.remove(i);
+            if (m_current == i) {
+                m_current = -1;
+            } else if (m_current > i) {
+                m_current--;
+            }
+            continue;
+        }
+        ++i;
+    }
+    const QRect fullRect(QPoint(0, 0), m_size);
+    const uchar *source = nullptr;
+    if (m_current != -1) {
+        auto current = m_buffers.at(m_current).buffer.toStrongRef();
+        if (current->isReleased()) {
             // we can re-use this buffer
-            b->setReleased(false);
+            current->setReleased(false);
+            for (int i = 0; i < m_buffers.count(); ++i) {
+                if (i != m_current) {
+                    m_buffers[i].dirty += region;
+                }
+            }
             return;
-        } else {
-            // buffer is still in use, get a new one
-            b->setUsed(false);
         }
+        source = current->address();
     }
-    auto oldBuffer = m_buffer.toStrongRef();
-    m_buffer.clear();
-    m_buffer = m_shm->getBuffer(m_size, m_size.width() * 4);
-    if (!m_buffer) {
-        m_backBuffer = QImage();
-        return;
+    // the current buffer is still in use by the compositor, switch to a released one
+    int next = -1;
+    for (int i = 0; i < m_buffers.count(); ++i) {
+        if (i != m_current && m_buffers.at(i).buffer.toStrongRef()->isReleased()) {
+            next = i;
+            break;
+        }
     }
-    auto b = m_buffer.toStrongRef();
-    b->setUsed(true);
-    m_backBuffer = QImage(b->address(), m_size.width(), m_size.height(), QImage::Format_ARGB32_Premultiplied);
-    if (oldBuffer) {
-        b->copy(oldBuffer->address());
-    } else {
-        m_backBuffer.fill(Qt::transparent);
+    if (next == -1) {
+        if (m_buffers.count() >= MaximumBuffers) {
+            // all buffers are busy, replace the oldest one which is not the current
+            const int oldest = (m_current + 1) % m_buffers.count();
+            m_buffers.at(oldest).buffer.toStrongRef()->setUsed(false);
+            m_buffers.remove(oldest);
+            if (m_current > oldest) {
+                m_current--;
+            }
+        }
+        auto b = m_shm->getBuffer(m_size, m_size.width() * 4);
+        if (!b) {
+            m_backBuffer = QImage();
+            return;
+        }
+        b.toStrongRef()->setUsed(true);
+        m_buffers.append({b, QRegion(fullRect)});
+        next = m_buffers.count() - 1;
+    }
+    PoolBuffer &target = m_buffers[next];
+    auto b = target.buffer.toStrongRef();
+    b->setReleased(false);
+    // pointers are looked up again as getBuffer might have resized and remapped the pool
+    if (m_current != -1) {
+        source = m_buffers.at(m_current).buffer.toStrongRef()->address();
     }
+    if (source) {
+        // only bring over what changed since this buffer got painted the last time
+        copyRegion(b->address(), source, target.dirty, m_size);
+    } else if (!target.dirty.isEmpty()) {
+        QImage image(b->address(), m_size.width(), m_size.height(), QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+    }
+    target.dirty = QRegion();
+    for (int i = 0; i < m_buffers.count(); ++i) {
+        if (i != next) {
+            m_buffers[i].dirty += region;
+        }
+    }
+    m_current = next;
+    m_backBuffer = QImage(b->address(), m_size.width(), m_size.height(), QImage::Format_ARGB32_Premultiplied);
 }
 
 }
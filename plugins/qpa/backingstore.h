@@ -22,6 +22,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <qpa/qplatformbackingstore.h>
 
+#include <QVector>
+
 namespace KWayland
 {
 namespace Client
@@ -45,11 +47,23 @@ public:
     QPaintDevice *paintDevice() override;
     void flush(QWindow *window, const QRegion &region, const QPoint &offset) override;
     void resize(const QSize &size, const QRegion &staticContents) override;
-    void beginPaint(const QRegion &) override;
+    void beginPaint(const QRegion &region) override;
+
+    /**
+     * The maximum number of shm buffers the BackingStore cycles through.
+     **/
+    static const int MaximumBuffers = 3;
 
 private:
+    void releaseBuffers();
     KWayland::Client::ShmPool *m_shm;
-    QWeakPointer<KWayland::Client::Buffer> m_buffer;
+    struct PoolBuffer {
+        QWeakPointer<KWayland::Client::Buffer> buffer;
+        // the parts which are outdated compared to the most recent content
+        QRegion dirty;
+    };
+    QVector<PoolBuffer> m_buffers;
+    int m_current = -1;
     QImage m_backBuffer;
     QSize m_size;
 };
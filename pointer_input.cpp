@@ -19,7 +19,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 #include "pointer_input.h"
 #include "abstract_backend.h"
+#include "composite.h"
 #include "effects.h"
+#include "options.h"
+#include "screenedge.h"
 #include "screens.h"
 #include "shell_client.h"
 #include "wayland_cursor_theme.h"
@@ -40,6 +43,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <KScreenLocker/KsldApp>
 
 #include <QHoverEvent>
+#include <QTimer>
 #include <QWindow>
 // Wayland
 #include <wayland-cursor.h>
@@ -112,6 +116,7 @@ PointerInputRedirection::PointerInputRedirection(InputRedirection* parent)
     , m_input(parent)
     , m_cursor(nullptr)
     , m_supportsWarping(Application::usesLibinput())
+    , m_frameAligned(qgetenv("KWIN_POINTER_FRAME_ALIGNED") == QByteArrayLiteral("1"))
 {
 }
 
@@ -129,6 +134,16 @@ void PointerInputRedirection::init()
     connect(ScreenLocker::KSldApp::self(), &ScreenLocker::KSldApp::lockStateChanged, this, &PointerInputRedirection::update);
     connect(workspace(), &QObject::destroyed, this, [this] { m_inited = false; });
     connect(waylandServer(), &QObject::destroyed, this, [this] { m_inited = false; });
+    if (Compositor::self()) {
+        connect(Compositor::self(), &Compositor::aboutToPaintFrame, this, &PointerInputRedirection::frameStarted);
+    }
+    if (m_frameAligned) {
+        // in case no frame gets painted, e.g. with a hardware cursor
+        m_scheduledUpdateTimer = new QTimer(this);
+        m_scheduledUpdateTimer->setSingleShot(true);
+        m_scheduledUpdateTimer->setInterval(qMax<qint64>(1, options->maxFpsInterval() / 1000000));
+        connect(m_scheduledUpdateTimer, &QTimer::timeout, this, &PointerInputRedirection::flushScheduledUpdates);
+    }
     connect(waylandServer()->seat(), &KWayland::Server::SeatInterface::dragEnded, this,
         [this] {
             // need to force a focused pointer change
@@ -149,11 +164,14 @@ void PointerInputRedirection::processMotion(const QPointF &pos, uint32_t time)
         return;
     }
     updatePosition(pos);
+    const auto filters = m_input->activeFilters(InputEventFilter::PointerEvents);
+    if (filters.isEmpty()) {
+        return;
+    }
     QMouseEvent event(QEvent::MouseMove, m_pos.toPoint(), m_pos.toPoint(),
                       Qt::NoButton, m_qtButtons, m_input->keyboardModifiers());
     event.setTimestamp(time);
 
-    const auto &filters = m_input->filters();
     for (auto it = filters.begin(), end = filters.end(); it != end; it++) {
         if ((*it)->pointerEvent(&event, 0)) {
             return;
@@ -166,6 +184,8 @@ void PointerInputRedirection::processButton(uint32_t button, InputRedirection::P
     if (!m_inited) {
         return;
     }
+    // the button has to go to the window under the pointer
+    flushScheduledUpdates();
     updateButton(button, state);
 
     QEvent::Type type;
@@ -181,11 +201,14 @@ void PointerInputRedirection::processButton(uint32_t button, InputRedirection::P
         return;
     }
 
+    const auto filters = m_input->activeFilters(InputEventFilter::PointerEvents);
+    if (filters.isEmpty()) {
+        return;
+    }
     QMouseEvent event(type, m_pos.toPoint(), m_pos.toPoint(),
                       buttonToQtMouseButton(button), m_qtButtons, m_input->keyboardModifiers());
     event.setTimestamp(time);
 
-    const auto &filters = m_input->filters();
     for (auto it = filters.begin(), end = filters.end(); it != end; it++) {
         if ((*it)->pointerEvent(&event, button)) {
             return;
@@ -201,9 +224,14 @@ void PointerInputRedirection::processAxis(InputRedirection::PointerAxis axis, qr
     if (delta == 0) {
         return;
     }
+    flushScheduledUpdates();
 
     emit m_input->pointerAxisChanged(axis, delta);
 
+    const auto filters = m_input->activeFilters(InputEventFilter::WheelEvents);
+    if (filters.isEmpty()) {
+        return;
+    }
     QWheelEvent wheelEvent(m_pos, m_pos, QPoint(),
                            (axis == InputRedirection::PointerAxisHorizontal) ? QPoint(delta, 0) : QPoint(0, delta),
                            delta,
@@ -212,7 +240,6 @@ void PointerInputRedirection::processAxis(InputRedirection::PointerAxis axis, qr
                            m_input->keyboardModifiers());
     wheelEvent.setTimestamp(time);
 
-    const auto &filters = m_input->filters();
     for (auto it = filters.begin(), end = filters.end(); it != end; it++) {
         if ((*it)->wheelEvent(&wheelEvent)) {
             return;
@@ -225,12 +252,15 @@ void PointerInputRedirection::update()
     if (!m_inited) {
         return;
     }
+    m_updatePending = false;
     if (waylandServer()->seat()->isDragPointer()) {
         // ignore during drag and drop
         return;
     }
     // TODO: handle pointer grab aka popups
     Toplevel *t = m_input->findToplevel(m_pos.toPoint());
+    m_pickStatistics.picks++;
+    m_picksInFrame++;
     const auto oldDeco = m_decoration;
     updateInternalWindow();
     if (!m_internalWindow) {
@@ -295,6 +325,54 @@ void PointerInputRedirection::update()
     }
 }
 
+void PointerInputRedirection::scheduleUpdate()
+{
+    if (!m_frameAligned) {
+        update();
+        return;
+    }
+    m_updatePending = true;
+    if (!m_scheduledUpdateTimer->isActive()) {
+        m_scheduledUpdateTimer->start();
+    }
+}
+
+void PointerInputRedirection::scheduleScreenEdgeCheck(quint32 time)
+{
+    Q_ASSERT(m_frameAligned);
+    m_screenEdgeCheckPending = true;
+    m_screenEdgeCheckTime = time;
+    if (!m_scheduledUpdateTimer->isActive()) {
+        m_scheduledUpdateTimer->start();
+    }
+}
+
+void PointerInputRedirection::flushScheduledUpdates()
+{
+    if (!m_frameAligned) {
+        return;
+    }
+    m_scheduledUpdateTimer->stop();
+    if (m_updatePending) {
+        update();
+    }
+    if (m_screenEdgeCheckPending) {
+        m_screenEdgeCheckPending = false;
+        QMouseEvent event(QEvent::MouseMove, m_pos.toPoint(), m_pos.toPoint(),
+                          Qt::NoButton, m_qtButtons, m_input->keyboardModifiers());
+        event.setTimestamp(m_screenEdgeCheckTime);
+        ScreenEdges::self()->isEntered(&event);
+    }
+}
+
+void PointerInputRedirection::frameStarted()
+{
+    flushScheduledUpdates();
+    m_pickStatistics.frames++;
+    m_pickStatistics.maxPicksPerFrame = qMax(m_pickStatistics.maxPicksPerFrame, m_picksInFrame);
+    m_picksInFrame = 0;
+}
+
 void PointerInputRedirection::updateInternalWindow()
 {
     const auto oldInternalWindow = m_internalWindow;
@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QPointer>
 #include <QPointF>
 
+class QTimer;
 class QWindow;
 
 namespace KWin
@@ -52,6 +53,23 @@ public:
     void init();
 
     void update();
+    /**
+     * Schedules the update of the pointer window after pointer motion.
+     *
+     * In frame aligned mode (environment variable KWIN_POINTER_FRAME_ALIGNED=1) the
+     * pick of the window under the pointer and with it focus and decoration hover updates
+     * are deferred till the Compositor starts the next frame, at the latest after one frame
+     * interval. Otherwise this is the same as update.
+     **/
+    void scheduleUpdate();
+    /**
+     * Schedules checking the screen edges for the current pointer position. Only to be used
+     * in frame aligned mode.
+     **/
+    void scheduleScreenEdgeCheck(quint32 time);
+    bool isFrameAligned() const {
+        return m_frameAligned;
+    }
     void updateAfterScreenChange();
     bool supportsWarping() const;
     void warp(const QPointF &pos);
@@ -78,6 +96,18 @@ public:
     void setEffectsOverrideCursor(Qt::CursorShape shape);
     void removeEffectsOverrideCursor();
 
+    /**
+     * Statistics about how often the Toplevel under the pointer got picked.
+     **/
+    struct PickStatistics {
+        quint64 picks = 0;
+        quint64 frames = 0;
+        int maxPicksPerFrame = 0;
+    };
+    const PickStatistics &pickStatistics() const {
+        return m_pickStatistics;
+    }
+
     /**
      * @internal
      */
@@ -99,6 +129,8 @@ private:
     void updateButton(uint32_t button, InputRedirection::PointerButtonState state);
     void updateInternalWindow();
     void updateDecoration(Toplevel *t);
+    void flushScheduledUpdates();
+    void frameStarted();
     InputRedirection *m_input;
     CursorImage *m_cursor;
     bool m_inited = false;
@@ -118,6 +150,13 @@ private:
     QPointer<QWindow> m_internalWindow;
     QMetaObject::Connection m_windowGeometryConnection;
     QMetaObject::Connection m_internalWindowConnection;
+    bool m_frameAligned;
+    bool m_updatePending = false;
+    bool m_screenEdgeCheckPending = false;
+    quint32 m_screenEdgeCheckTime = 0;
+    QTimer *m_scheduledUpdateTimer = nullptr;
+    PickStatistics m_pickStatistics;
+    int m_picksInFrame = 0;
 };
 
 class CursorImage : public QObject
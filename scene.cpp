@@ -68,9 +68,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "scene.h"
 
+#include <QOpenGLFramebufferObject>
 #include <QQuickWindow>
+#include <QTimer>
 #include <QVector2D>
 
+#include <algorithm>
+
 #include "client.h"
 #include "deleted.h"
 #include "effects.h"
@@ -80,8 +84,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "wayland_server.h"
 
 #include "thumbnailitem.h"
+#include "tracing.h"
 
 #include <KWayland/Server/buffer_interface.h>
+#include <KWayland/Server/subcompositor_interface.h>
 #include <KWayland/Server/surface_interface.h>
 
 namespace KWin
@@ -108,6 +114,7 @@ Scene::~Scene()
 void Scene::paintScreen(int* mask, const QRegion &damage, const QRegion &repaint,
                         QRegion *updateRegion, QRegion *validRegion, const QMatrix4x4 &projection)
 {
+    KWIN_TRACE("scene", "paintScreen");
     const QSize &screenSize = screens()->size();
     const QRegion displayRegion(0, 0, screenSize.width(), screenSize.height());
     *mask = (damage == displayRegion) ? 0 : PAINT_SCREEN_REGION;
@@ -276,30 +283,18 @@ void Scene::paintSimpleScreen(int orig_mask, QRegion region)
         // Clip out the decoration for opaque windows; the decoration is drawn in the second pass
         opaqueFullscreen = false; // TODO: do we care about unmanged windows here (maybe input windows?)
         if (w->isOpaque()) {
-            AbstractClient *c = dynamic_cast<AbstractClient*>(topw);
-            if (c) {
+            if (AbstractClient *c = dynamic_cast<AbstractClient*>(topw)) {
                 opaqueFullscreen = c->isFullScreen();
             }
-            Client *cc = dynamic_cast<Client*>(c);
-            // the window is fully opaque
-            if (cc && cc->decorationHasAlpha()) {
-                // decoration uses alpha channel, so we may not exclude it in clipping
-                data.clip = w->clientShape().translated(w->x(), w->y());
-            } else {
-                // decoration is fully opaque
-                if (c && c->isShade()) {
-                    data.clip = QRegion();
-                } else {
-                    data.clip = w->shape().translated(w->x(), w->y());
-                }
-            }
-        } else if (topw->hasAlpha() && topw->opacity() == 1.0) {
-            // the window is partially opaque
-            data.clip = (w->clientShape() & topw->opaqueRegion().translated(topw->clientPos())).translated(w->x(), w->y());
-        } else {
-            data.clip = QRegion();
         }
+        const bool quadsReused = w->hasCachedQuads();
+        data.clip = w->opaqueClip();
         data.quads = w->buildQuads();
+        if (quadsReused) {
+            m_paintCacheStatistics.reusedWindows++;
+        } else {
+            m_paintCacheStatistics.rebuiltWindows++;
+        }
         // preparation step
         effects->prePaintWindow(effectWindow(w), data, time_diff);
 #ifndef NDEBUG
@@ -374,10 +369,19 @@ void Scene::paintSimpleScreen(int orig_mask, QRegion region)
     for (int i = 0; i < phase2data.count(); ++i) {
         Phase2Data *data = &phase2data[i].second;
 
+        // nothing of the window itself needs a repaint which is not covered by opaque windows above
+        const bool occluded = data->region.isEmpty();
+
         // add all regions which have been drawn so far
         paintedArea |= data->region;
         data->region = paintedArea;
 
+        if (occluded && !paintedArea.intersects(data->window->window()->visibleRect())) {
+            // and no window below gets repainted where it would have to be painted on top
+            m_paintCacheStatistics.occludedWindows++;
+            continue;
+        }
+
         paintWindow(data->window, data->mask, data->region, data->quads);
     }
 
@@ -397,6 +401,13 @@ void Scene::paintSimpleScreen(int orig_mask, QRegion region)
     }
 }
 
+void Scene::discardQuads()
+{
+    for (auto it = m_windows.constBegin(); it != m_windows.constEnd(); ++it) {
+        (*it)->discardQuads();
+    }
+}
+
 void Scene::windowAdded(Toplevel *c)
 {
     assert(!m_windows.contains(c));
@@ -717,6 +728,16 @@ void Scene::Window::discardShape()
     cached_quad_list.reset();
 }
 
+void Scene::Window::discardQuads()
+{
+    cached_quad_list.reset();
+}
+
+bool Scene::Window::hasCachedQuads() const
+{
+    return !cached_quad_list.isNull();
+}
+
 // Find out the shape of the window using the XShape extension
 // or if shape is not set then simply it's the window geometry.
 const QRegion &Scene::Window::shape() const
@@ -756,6 +777,28 @@ QRegion Scene::Window::clientShape() const
     return r.isEmpty() ? QRegion() : r;
 }
 
+QRegion Scene::Window::opaqueClip() const
+{
+    if (toplevel->opacity() != 1.0) {
+        return QRegion();
+    }
+    if (!toplevel->hasAlpha()) {
+        // the window is fully opaque
+        AbstractClient *c = dynamic_cast<AbstractClient*>(toplevel);
+        Client *cc = dynamic_cast<Client*>(c);
+        if (cc && cc->decorationHasAlpha()) {
+            // decoration uses alpha channel, so we may not exclude it in clipping
+            return clientShape().translated(x(), y());
+        } else if (c && c->isShade()) {
+            return QRegion();
+        }
+        // decoration is fully opaque
+        return shape().translated(x(), y());
+    }
+    // the window is partially opaque
+    return (clientShape() & toplevel->opaqueRegion().translated(toplevel->clientPos())).translated(x(), y());
+}
+
 bool Scene::Window::isVisible() const
 {
     if (toplevel->isDeleted())
@@ -937,11 +980,35 @@ WindowPixmap::WindowPixmap(Scene::Window *window)
 {
 }
 
+WindowPixmap::WindowPixmap(const QPointer<KWayland::Server::SubSurfaceInterface> &subSurface, WindowPixmap *parent)
+    : m_window(parent->m_window)
+    , m_pixmap(XCB_PIXMAP_NONE)
+    , m_discarded(false)
+    , m_parent(parent)
+    , m_subSurface(subSurface)
+{
+    using namespace KWayland::Server;
+    if (SurfaceInterface *s = surface()) {
+        // the subsurface commits independently of the main surface, track its damage
+        // and let the Toplevel get repainted
+        m_damageConnection = QObject::connect(s, &SurfaceInterface::damaged, toplevel(),
+            [this] (const QRegion &region) {
+                m_damage += region;
+                toplevel()->addRepaint(region.translated(toplevel()->clientPos() + subSurfacePosition()));
+            }
+        );
+    }
+}
+
 WindowPixmap::~WindowPixmap()
 {
     if (isValid() && !kwinApp()->shouldUseWaylandForCompositing()) {
         xcb_free_pixmap(connection(), m_pixmap);
     }
+    discardPendingPixmap();
+    QObject::disconnect(m_damageConnection);
+    QObject::disconnect(m_subSurfaceTreeConnection);
+    qDeleteAll(m_children);
     if (m_buffer) {
         using namespace KWayland::Server;
         QObject::disconnect(m_buffer.data(), &BufferInterface::aboutToBeDestroyed, m_buffer.data(), &BufferInterface::unref);
@@ -957,38 +1024,96 @@ void WindowPixmap::create()
     if (kwinApp()->shouldUseWaylandForCompositing()) {
         // use Buffer
         updateBuffer();
-        if (m_buffer || !m_fbo.isNull()) {
+        if ((m_buffer || !m_fbo.isNull()) && !m_parent) {
             m_window->unreferencePreviousPixmap();
         }
         return;
     }
-    XServerGrabber grabber;
-    xcb_pixmap_t pix = xcb_generate_id(connection());
-    xcb_void_cookie_t namePixmapCookie = xcb_composite_name_window_pixmap_checked(connection(), toplevel()->frameId(), pix);
-    Xcb::WindowAttributes windowAttributes(toplevel()->frameId());
-    Xcb::WindowGeometry windowGeometry(toplevel()->frameId());
-    if (xcb_generic_error_t *error = xcb_request_check(connection(), namePixmapCookie)) {
+    if (m_pending.pixmap == XCB_PIXMAP_NONE) {
+        requestPixmap();
+    }
+    // as long as the previous pixmap can be painted there is no need to wait for the
+    // X server, the replies are checked again in the next frame
+    if (!finishPendingPixmap(!m_window->hasPreviousPixmap())) {
+        Toplevel *t = toplevel();
+        QTimer::singleShot(0, t, [t] { t->addRepaintFull(); });
+    }
+}
+
+void WindowPixmap::requestPixmap()
+{
+    // No server grab: the size is validated once the replies arrive and a pixmap not matching
+    // the window any more is dropped and requested again. The geometry is queried from the named
+    // pixmap and not the window, the window might get resized again before the request is handled,
+    // while the size of the pixmap cannot change.
+    xcb_connection_t *c = connection();
+    const xcb_window_t frame = toplevel()->frameId();
+    m_pending.pixmap = xcb_generate_id(c);
+    m_pending.nameCookie = xcb_composite_name_window_pixmap_checked(c, frame, m_pending.pixmap);
+    m_pending.attributesCookie = xcb_get_window_attributes_unchecked(c, frame);
+    m_pending.geometryCookie = xcb_get_geometry_unchecked(c, m_pending.pixmap);
+    xcb_flush(c);
+}
+
+bool WindowPixmap::finishPendingPixmap(bool block)
+{
+    xcb_connection_t *c = connection();
+    xcb_get_geometry_reply_t *geometryReply = nullptr;
+    if (block) {
+        geometryReply = xcb_get_geometry_reply(c, m_pending.geometryCookie, nullptr);
+    } else {
+        // the geometry is requested last, once it is there all replies are there
+        void *reply = nullptr;
+        xcb_generic_error_t *error = nullptr;
+        if (!xcb_poll_for_reply(c, m_pending.geometryCookie.sequence, &reply, &error)) {
+            return false;
+        }
+        free(error);
+        geometryReply = reinterpret_cast<xcb_get_geometry_reply_t*>(reply);
+    }
+    ScopedCPointer<xcb_get_geometry_reply_t> pixmapGeometry(geometryReply);
+    ScopedCPointer<xcb_get_window_attributes_reply_t> windowAttributes(
+        xcb_get_window_attributes_reply(c, m_pending.attributesCookie, nullptr));
+    xcb_generic_error_t *error = xcb_request_check(c, m_pending.nameCookie);
+    const xcb_pixmap_t pix = m_pending.pixmap;
+    m_pending = PendingPixmap();
+    if (error) {
         qCDebug(KWIN_CORE) << "Creating window pixmap failed: " << error->error_code;
         free(error);
-        return;
+        return true;
     }
     // check that the received pixmap is valid and actually matches what we
     // know about the window (i.e. size)
-    if (!windowAttributes || windowAttributes->map_state != XCB_MAP_STATE_VIEWABLE) {
+    if (windowAttributes.isNull() || windowAttributes->map_state != XCB_MAP_STATE_VIEWABLE) {
         qCDebug(KWIN_CORE) << "Creating window pixmap failed: " << this;
-        xcb_free_pixmap(connection(), pix);
-        return;
+        xcb_free_pixmap(c, pix);
+        return true;
     }
-    if (!windowGeometry ||
-        windowGeometry->width != toplevel()->width() || windowGeometry->height != toplevel()->height()) {
+    if (pixmapGeometry.isNull() ||
+        pixmapGeometry->width != toplevel()->width() || pixmapGeometry->height != toplevel()->height()) {
         qCDebug(KWIN_CORE) << "Creating window pixmap failed: " << this;
-        xcb_free_pixmap(connection(), pix);
-        return;
+        xcb_free_pixmap(c, pix);
+        return true;
     }
     m_pixmap = pix;
-    m_pixmapSize = QSize(toplevel()->width(), toplevel()->height());
+    m_pixmapSize = QSize(pixmapGeometry->width, pixmapGeometry->height);
     m_contentsRect = QRect(toplevel()->clientPos(), toplevel()->clientSize());
     m_window->unreferencePreviousPixmap();
+    return true;
+}
+
+void WindowPixmap::discardPendingPixmap()
+{
+    if (m_pending.pixmap == XCB_PIXMAP_NONE) {
+        return;
+    }
+    xcb_connection_t *c = connection();
+    xcb_discard_reply(c, m_pending.nameCookie.sequence);
+    xcb_discard_reply(c, m_pending.attributesCookie.sequence);
+    xcb_discard_reply(c, m_pending.geometryCookie.sequence);
+    // if naming failed this only results in an ignored error
+    xcb_free_pixmap(c, m_pending.pixmap);
+    m_pending = PendingPixmap();
 }
 
 bool WindowPixmap::isValid() const
@@ -999,10 +1124,94 @@ bool WindowPixmap::isValid() const
     return m_pixmap != XCB_PIXMAP_NONE;
 }
 
+WindowPixmap *WindowPixmap::createChild(const QPointer<KWayland::Server::SubSurfaceInterface> &subSurface)
+{
+    Q_UNUSED(subSurface)
+    return nullptr;
+}
+
+KWayland::Server::SurfaceInterface *WindowPixmap::surface() const
+{
+    if (m_parent) {
+        return m_subSurface ? m_subSurface->surface().data() : nullptr;
+    }
+    return m_window->window()->surface();
+}
+
+QPoint WindowPixmap::subSurfacePosition() const
+{
+    QPoint position;
+    for (const WindowPixmap *p = this; p->m_parent && p->m_subSurface; p = p->m_parent) {
+        position += p->m_subSurface->position();
+    }
+    return position;
+}
+
+QRegion WindowPixmap::damage() const
+{
+    if (m_parent) {
+        return m_damage;
+    }
+    return m_window->window()->damage();
+}
+
+void WindowPixmap::resetDamage()
+{
+    if (m_parent) {
+        m_damage = QRegion();
+        return;
+    }
+    toplevel()->resetDamage();
+}
+
+void WindowPixmap::updateChildren()
+{
+    using namespace KWayland::Server;
+    SurfaceInterface *s = surface();
+    if (!s) {
+        return;
+    }
+    if (!m_subSurfaceTreeConnection) {
+        // subsurfaces get added, removed or restacked with a commit of the parent which need
+        // not damage the parent, so the tree cannot only be updated together with the buffer
+        m_subSurfaceTreeConnection = QObject::connect(s, &SurfaceInterface::subSurfaceTreeChanged, toplevel(),
+            [this] {
+                updateChildren();
+                toplevel()->addRepaintFull();
+            }
+        );
+    }
+    const auto subSurfaces = s->childSubSurfaces();
+    if (subSurfaces.isEmpty() && m_children.isEmpty()) {
+        return;
+    }
+    // keep the WindowPixmaps of subsurfaces still in the tree, so that their textures are reused
+    QVector<WindowPixmap*> oldChildren = m_children;
+    QVector<WindowPixmap*> children;
+    children.reserve(subSurfaces.count());
+    for (const auto &subSurface : subSurfaces) {
+        if (subSurface.isNull()) {
+            continue;
+        }
+        auto it = std::find_if(oldChildren.begin(), oldChildren.end(),
+                               [&subSurface] (WindowPixmap *p) { return p->m_subSurface == subSurface; });
+        if (it != oldChildren.end()) {
+            children << *it;
+            oldChildren.erase(it);
+        } else if (WindowPixmap *p = createChild(subSurface)) {
+            p->create();
+            children << p;
+        }
+    }
+    m_children = children;
+    qDeleteAll(oldChildren);
+}
+
 void WindowPixmap::updateBuffer()
 {
-    if (auto s = toplevel()->surface()) {
+    if (auto s = surface()) {
         using namespace KWayland::Server;
+        updateChildren();
         if (auto b = s->buffer()) {
             if (m_buffer) {
                 QObject::disconnect(m_buffer.data(), &BufferInterface::aboutToBeDestroyed, m_buffer.data(), &BufferInterface::unref);
@@ -1011,11 +1220,18 @@ void WindowPixmap::updateBuffer()
             m_buffer = b;
             m_buffer->ref();
             QObject::connect(m_buffer.data(), &BufferInterface::aboutToBeDestroyed, m_buffer.data(), &BufferInterface::unref);
-        } else {
+            m_pixmapSize = b->size();
+            if (!m_parent) {
+                // the buffer only contains the client's content
+                m_contentsRect = QRect(QPoint(0, 0), m_pixmapSize);
+            }
+        } else if (!m_parent) {
             // might be an internal window
             const auto &fbo = toplevel()->internalFramebufferObject();
             if (!fbo.isNull()) {
                 m_fbo = fbo;
+                m_pixmapSize = fbo->size();
+                m_contentsRect = QRect(QPoint(0, 0), m_pixmapSize);
             }
         }
     }
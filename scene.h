@@ -35,6 +35,8 @@ namespace KWayland
 namespace Server
 {
 class BufferInterface;
+class SubSurfaceInterface;
+class SurfaceInterface;
 }
 }
 
@@ -148,6 +150,77 @@ public:
 
     virtual Decoration::Renderer *createDecorationRenderer(Decoration::DecoratedClientImpl *) = 0;
 
+    /**
+     * Counters of the per window paint cache used in paintSimpleScreen.
+     **/
+    struct PaintCacheStatistics {
+        // windows whose quads could be taken from the cache
+        quint64 reusedWindows = 0;
+        // windows whose quads had to be rebuilt
+        quint64 rebuiltWindows = 0;
+        // windows which were not painted as they are completely occluded by opaque windows
+        // and no window below got repainted underneath them
+        quint64 occludedWindows = 0;
+    };
+    const PaintCacheStatistics &paintCacheStatistics() const {
+        return m_paintCacheStatistics;
+    }
+    /**
+     * The windows which got drawn since the last clearPresentedWindows(), the Compositor
+     * uses them to send frame callbacks only to the surfaces which actually got presented.
+     **/
+    const QVector<Toplevel*> &presentedWindows() const {
+        return m_presentedWindows;
+    }
+    void addPresentedWindow(Toplevel *toplevel) {
+        m_presentedWindows << toplevel;
+    }
+    void clearPresentedWindows() {
+        m_presentedWindows.clear();
+    }
+    /**
+     * Counters of the window pixmaps, mostly interesting during interactive resize.
+     **/
+    struct WindowPixmapStatistics {
+        // textures which got allocated for a window pixmap
+        quint64 textureAllocations = 0;
+        // windows painted from their previous pixmap scaled to the new size
+        quint64 scaledPreviousPixmaps = 0;
+        // bytes copied from shared memory buffers into textures
+        quint64 uploadedBytes = 0;
+    };
+    const WindowPixmapStatistics &windowPixmapStatistics() const {
+        return m_windowPixmapStatistics;
+    }
+    void countTextureAllocation() {
+        m_windowPixmapStatistics.textureAllocations++;
+    }
+    void countScaledPreviousPixmap() {
+        m_windowPixmapStatistics.scaledPreviousPixmaps++;
+    }
+    void countUploadedBytes(quint64 bytes) {
+        m_windowPixmapStatistics.uploadedBytes += bytes;
+    }
+    /**
+     * Counters of the thumbnail cache used for windows painted scaled down, e.g. in the
+     * window switcher, present windows and desktop grid. Only used by the OpenGL scene.
+     **/
+    struct ThumbnailStatistics {
+        // thumbnails which got rendered into their cache texture
+        quint64 renderedThumbnails = 0;
+        // thumbnails painted from an up to date cache texture
+        quint64 cachedThumbnails = 0;
+        // outdated or missing thumbnails whose rendering got deferred to a later frame
+        quint64 deferredThumbnails = 0;
+    };
+    const ThumbnailStatistics &thumbnailStatistics() const {
+        return m_thumbnailStatistics;
+    }
+    /**
+     * Discards the cached quads of all windows, e.g. because the Effects changed.
+     **/
+    void discardQuads();
+
 public Q_SLOTS:
     // a window has been destroyed
     void windowDeleted(KWin::Deleted*);
@@ -211,12 +284,16 @@ protected:
     // time since last repaint
     int time_diff;
     QElapsedTimer last_time;
+    WindowPixmapStatistics m_windowPixmapStatistics;
+    ThumbnailStatistics m_thumbnailStatistics;
 private:
     void paintWindowThumbnails(Scene::Window *w, QRegion region, qreal opacity, qreal brightness, qreal saturation);
     void paintDesktopThumbnails(Scene::Window *w);
     QHash< Toplevel*, Window* > m_windows;
     // windows in their stacking order
     QVector< Window* > stacking_order;
+    PaintCacheStatistics m_paintCacheStatistics;
+    QVector<Toplevel*> m_presentedWindows;
 };
 
 // The base class for windows representations in composite backends
@@ -267,7 +344,15 @@ public:
     // shape of the window
     const QRegion &shape() const;
     QRegion clientShape() const;
+    /**
+     * The region of the window which is known to be opaque in screen coordinates. It is used
+     * to clip away the windows below.
+     **/
+    QRegion opaqueClip() const;
     void discardShape();
+    void discardQuads();
+    // whether buildQuads can return the cached quads
+    bool hasCachedQuads() const;
     void updateToplevel(Toplevel* c);
     // creates initial quad list for the window
     virtual WindowQuadList buildQuads(bool force = false) const;
@@ -277,6 +362,10 @@ public:
     Shadow* shadow();
     void referencePreviousPixmap();
     void unreferencePreviousPixmap();
+    /**
+     * @returns whether a previous WindowPixmap can be painted while the current one is created
+     **/
+    bool hasPreviousPixmap() const;
 protected:
     WindowQuadList makeQuads(WindowQuadType type, const QRegion& reg, const QPoint &textureOffset = QPoint(0, 0)) const;
     WindowQuadList makeDecorationQuads(const QRect *rects, const QRegion &region) const;
@@ -334,7 +423,7 @@ private:
  * This class is intended to be inherited for the needs of the compositor backends which need further mapping from
  * the native pixmap to the respective rendering format.
  */
-class WindowPixmap
+class KWIN_EXPORT WindowPixmap
 {
 public:
     virtual ~WindowPixmap();
@@ -391,9 +480,38 @@ public:
      * Note: the Toplevel can change over the lifetime of the WindowPixmap in case the Toplevel is copied to Deleted.
      */
     Toplevel *toplevel();
+    /**
+     * The WindowPixmaps of the subsurfaces of this WindowPixmap's surface in their stacking order.
+     * Only used for Wayland, the tree gets updated together with the buffer and whenever the
+     * subsurface tree of the surface changes.
+     **/
+    const QVector<WindowPixmap*> &children() const;
+    /**
+     * @returns the subsurface this WindowPixmap is for or @c null for the main surface of the Toplevel
+     **/
+    QPointer<KWayland::Server::SubSurfaceInterface> subSurface() const;
+    /**
+     * @returns the position of the subsurface relative to the main surface of the Toplevel
+     **/
+    QPoint subSurfacePosition() const;
+    /**
+     * The damage which is not yet applied to this WindowPixmap. For the main surface this is the
+     * damage of the Toplevel, a subsurface tracks the damage of its own surface.
+     **/
+    QRegion damage() const;
+    void resetDamage();
 
 protected:
     explicit WindowPixmap(Scene::Window *window);
+    /**
+     * Constructor for the WindowPixmap of a @p subSurface below the @p parent WindowPixmap.
+     **/
+    WindowPixmap(const QPointer<KWayland::Server::SubSurfaceInterface> &subSurface, WindowPixmap *parent);
+    /**
+     * Factory for the WindowPixmaps of subsurfaces. Scenes supporting subsurfaces create
+     * an instance of their own WindowPixmap subclass, the default returns @c nullptr.
+     **/
+    virtual WindowPixmap *createChild(const QPointer<KWayland::Server::SubSurfaceInterface> &subSurface);
     /**
      * @return The Window this WindowPixmap belongs to
      */
@@ -405,13 +523,35 @@ protected:
      **/
     void updateBuffer();
 private:
+    void requestPixmap();
+    bool finishPendingPixmap(bool block);
+    void discardPendingPixmap();
     Scene::Window *m_window;
     xcb_pixmap_t m_pixmap;
+    /**
+     * The named pixmap and the requests validating it against the window. The replies
+     * are only evaluated once they arrived, so that the X server need not be grabbed.
+     **/
+    struct PendingPixmap {
+        xcb_pixmap_t pixmap = XCB_PIXMAP_NONE;
+        xcb_void_cookie_t nameCookie;
+        xcb_get_window_attributes_cookie_t attributesCookie;
+        xcb_get_geometry_cookie_t geometryCookie;
+    };
+    PendingPixmap m_pending;
     QSize m_pixmapSize;
     bool m_discarded;
     QRect m_contentsRect;
     QPointer<KWayland::Server::BufferInterface> m_buffer;
     QSharedPointer<QOpenGLFramebufferObject> m_fbo;
+    KWayland::Server::SurfaceInterface *surface() const;
+    void updateChildren();
+    WindowPixmap *m_parent = nullptr;
+    QVector<WindowPixmap*> m_children;
+    QPointer<KWayland::Server::SubSurfaceInterface> m_subSurface;
+    QRegion m_damage;
+    QMetaObject::Connection m_damageConnection;
+    QMetaObject::Connection m_subSurfaceTreeConnection;
 };
 
 class Scene::EffectFrame
@@ -545,6 +685,12 @@ T* Scene::Window::windowPixmap()
     }
 }
 
+inline
+bool Scene::Window::hasPreviousPixmap() const
+{
+    return !m_previousPixmap.isNull();
+}
+
 template <typename T>
 inline
 T* Scene::Window::previousWindowPixmap()
@@ -589,6 +735,18 @@ const QSize &WindowPixmap::size() const
     return m_pixmapSize;
 }
 
+inline
+const QVector<WindowPixmap*> &WindowPixmap::children() const
+{
+    return m_children;
+}
+
+inline
+QPointer<KWayland::Server::SubSurfaceInterface> WindowPixmap::subSurface() const
+{
+    return m_subSurface;
+}
+
 } // namespace
 
 #endif
@@ -47,6 +47,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "main.h"
 #include "overlaywindow.h"
 #include "screens.h"
+#include "tracing.h"
+#include "windowclipping.h"
 #include "decorations/decoratedclient.h"
 
 #include <array>
@@ -68,6 +70,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <KNotification>
 #include <KProcess>
 
+#include <KWayland/Server/buffer_interface.h>
+#include <KWayland/Server/subcompositor_interface.h>
+
 // HACK: workaround for libepoxy < 1.3
 #ifndef GL_GUILTY_CONTEXT_RESET
 #define GL_GUILTY_CONTEXT_RESET 0x8253
@@ -337,26 +342,13 @@ void OpenGLBackend::idle()
 
 void OpenGLBackend::addToDamageHistory(const QRegion &region)
 {
-    if (m_damageHistory.count() > 10)
-        m_damageHistory.removeLast();
-
-    m_damageHistory.prepend(region);
+    m_damageHistory.add(region);
 }
 
 QRegion OpenGLBackend::accumulatedDamageHistory(int bufferAge) const
 {
-    QRegion region;
-
-    // Note: An age of zero means the buffer contents are undefined
-    if (bufferAge > 0 && bufferAge <= m_damageHistory.count()) {
-        for (int i = 0; i < bufferAge - 1; i++)
-            region |= m_damageHistory[i];
-    } else {
-        const QSize &s = screens()->size();
-        region = QRegion(0, 0, s.width(), s.height());
-    }
-
-    return region;
+    const QSize &s = screens()->size();
+    return m_damageHistory.accumulate(bufferAge, QRect(0, 0, s.width(), s.height()));
 }
 
 OverlayWindow* OpenGLBackend::overlayWindow()
@@ -732,7 +724,10 @@ qint64 SceneOpenGL::paint(QRegion damage, ToplevelList toplevels)
 
             GLVertexBuffer::streamingBuffer()->endOfFrame();
 
-            m_backend->endRenderingFrameForScreen(i, valid, update);
+            {
+                KWIN_TRACE("scene", "swapBuffers");
+                m_backend->endRenderingFrameForScreen(i, valid, update);
+            }
 
             GLVertexBuffer::streamingBuffer()->framePosted();
         }
@@ -767,7 +762,10 @@ qint64 SceneOpenGL::paint(QRegion damage, ToplevelList toplevels)
 
         GLVertexBuffer::streamingBuffer()->endOfFrame();
 
-        m_backend->endRenderingFrame(validRegion, updateRegion);
+        {
+            KWIN_TRACE("scene", "swapBuffers");
+            m_backend->endRenderingFrame(validRegion, updateRegion);
+        }
 
         GLVertexBuffer::streamingBuffer()->framePosted();
     }
@@ -1152,7 +1150,7 @@ void SceneOpenGL2::performPaintWindow(EffectWindowImpl* w, int mask, QRegion reg
 {
     if (mask & PAINT_WINDOW_LANCZOS) {
         if (!m_lanczosFilter) {
-            m_lanczosFilter = new LanczosFilter(this);
+            m_lanczosFilter = new LanczosFilter(&m_thumbnailStatistics, this);
             // recreate the lanczos filter when the screen gets resized
             connect(screens(), SIGNAL(changed()), SLOT(resetLanczosFilter()));
         }
@@ -1269,15 +1267,19 @@ SceneOpenGL::Window::~Window()
 }
 
 static SceneOpenGL::Texture *s_frameTexture = NULL;
+static OpenGLWindowPixmap *s_framePixmap = NULL;
 // Bind the window pixmap to an OpenGL texture.
 bool SceneOpenGL::Window::bindTexture()
 {
+    KWIN_TRACE("scene", "bindTexture");
     s_frameTexture = NULL;
+    s_framePixmap = NULL;
     OpenGLWindowPixmap *pixmap = windowPixmap<OpenGLWindowPixmap>();
     if (!pixmap) {
         return false;
     }
     s_frameTexture = pixmap->texture();
+    s_framePixmap = pixmap;
     if (pixmap->isDiscarded()) {
         return !pixmap->texture()->isNull();
     }
@@ -1312,36 +1314,34 @@ QMatrix4x4 SceneOpenGL::Window::transformation(int mask, const WindowPaintData &
     return matrix;
 }
 
+/**
+ * Whether the window is painted with a transformation which keeps the quads axis aligned,
+ * that is only translated and scaled in the x/y plane with the default projection.
+ **/
+static bool isAxisAlignedTransformation(const WindowPaintData &data)
+{
+    return data.rotationAngle() == 0.0 && data.zTranslation() == 0.0 &&
+           data.xScale() > 0.0 && data.yScale() > 0.0 &&
+           data.projectionMatrix().isIdentity() && data.modelViewMatrix().isIdentity() &&
+           !data.quads.isTransformed();
+}
+
 bool SceneOpenGL::Window::beginRenderWindow(int mask, const QRegion &region, WindowPaintData &data)
 {
     if (region.isEmpty())
         return false;
 
-    m_hardwareClipping = region != infiniteRegion() && (mask & PAINT_WINDOW_TRANSFORMED) && !(mask & PAINT_SCREEN_TRANSFORMED);
-    if (region != infiniteRegion() && !m_hardwareClipping) {
-        WindowQuadList quads;
-        quads.reserve(data.quads.count());
-
-        const QRegion filterRegion = region.translated(-x(), -y());
-        // split all quads in bounding rect with the actual rects in the region
-        foreach (const WindowQuad &quad, data.quads) {
-            foreach (const QRect &r, filterRegion.rects()) {
-                const QRectF rf(r);
-                const QRectF quadRect(QPointF(quad.left(), quad.top()), QPointF(quad.right(), quad.bottom()));
-                const QRectF &intersected = rf.intersected(quadRect);
-                if (intersected.isValid()) {
-                    if (quadRect == intersected) {
-                        // case 1: completely contains, include and do not check other rects
-                        quads << quad;
-                        break;
-                    }
-                    // case 2: intersection
-                    quads << quad.makeSubQuad(intersected.left(), intersected.top(), intersected.right(), intersected.bottom());
-                }
-            }
-        }
-        data.quads = quads;
+    WindowClipping clipping;
+    clipping.transformed = (mask & PAINT_WINDOW_TRANSFORMED) && !(mask & PAINT_SCREEN_TRANSFORMED);
+    if (clipping.transformed) {
+        clipping.axisAligned = isAxisAlignedTransformation(data);
+        clipping.position = QPointF(x() + data.xTranslation(), y() + data.yTranslation());
+        clipping.xScale = data.xScale();
+        clipping.yScale = data.yScale();
+    } else {
+        clipping.position = QPointF(x(), y());
     }
+    m_hardwareClipping = clipping.clip(data.quads, region);
 
     if (data.quads.isEmpty())
         return false;
@@ -1481,6 +1481,33 @@ void SceneOpenGL2Window::setupLeafNodes(LeafNode *nodes, const WindowQuadList *q
     }
 }
 
+/**
+ * Creates content quads with normalized texture coordinates mapping the Client's current content
+ * space onto the content space of @p pixmap. Normal quads divide the x/y position by width/height,
+ * which would not work as the texture is larger than the visible content in case of a decorated
+ * Client resulting in garbage being shown.
+ **/
+static WindowQuadList mapToPixmapContents(const WindowQuadList &quads, Toplevel *toplevel, const WindowPixmap *pixmap)
+{
+    const QRect &oldGeometry = pixmap->contentsRect();
+    // X11 content quads are textured from the frame, Wayland content quads from the client buffer
+    const QPoint contentsOrigin = toplevel->clientPos() + toplevel->clientContentPos();
+    WindowQuadList mapped;
+    for (const WindowQuad &quad : quads) {
+        WindowQuad newQuad(WindowQuadContents);
+        for (int i = 0; i < 4; ++i) {
+            const qreal xFactor = qreal(quad[i].textureX() - contentsOrigin.x())/qreal(toplevel->clientSize().width());
+            const qreal yFactor = qreal(quad[i].textureY() - contentsOrigin.y())/qreal(toplevel->clientSize().height());
+            WindowVertex vertex(quad[i].x(), quad[i].y(),
+                                (xFactor * oldGeometry.width() + oldGeometry.x())/qreal(pixmap->size().width()),
+                                (yFactor * oldGeometry.height() + oldGeometry.y())/qreal(pixmap->size().height()));
+            newQuad[i] = vertex;
+        }
+        mapped.append(newQuad);
+    }
+    return mapped;
+}
+
 QMatrix4x4 SceneOpenGL2Window::modelViewProjectionMatrix(int mask, const WindowPaintData &data) const
 {
     SceneOpenGL2 *scene = static_cast<SceneOpenGL2 *>(m_scene);
@@ -1560,27 +1587,19 @@ void SceneOpenGL2Window::performPaint(int mask, QRegion region, WindowPaintData
         }
     }
 
+    // while the pixmap for the new size is not yet available, e.g. during interactive resize,
+    // the previous pixmap gets scaled to the new size instead of being clamped
+    const bool scalePreviousPixmap = s_framePixmap && s_framePixmap->isDiscarded() &&
+                                     s_framePixmap->contentsRect().size() != toplevel->clientSize();
+    if (scalePreviousPixmap) {
+        quads[ContentLeaf] = mapToPixmapContents(quads[ContentLeaf], toplevel, s_framePixmap);
+        m_scene->countScaledPreviousPixmap();
+    }
+
     if (data.crossFadeProgress() != 1.0) {
         OpenGLWindowPixmap *previous = previousWindowPixmap<OpenGLWindowPixmap>();
-        if (previous) {
-            const QRect &oldGeometry = previous->contentsRect();
-            for (const WindowQuad &quad : quads[ContentLeaf]) {
-                // we need to create new window quads with normalize texture coordinates
-                // normal quads divide the x/y position by width/height. This would not work as the texture
-                // is larger than the visible content in case of a decorated Client resulting in garbage being shown.
-                // So we calculate the normalized texture coordinate in the Client's new content space and map it to
-                // the previous Client's content space.
-                WindowQuad newQuad(WindowQuadContents);
-                for (int i = 0; i < 4; ++i) {
-                    const qreal xFactor = qreal(quad[i].textureX() - toplevel->clientPos().x())/qreal(toplevel->clientSize().width());
-                    const qreal yFactor = qreal(quad[i].textureY() - toplevel->clientPos().y())/qreal(toplevel->clientSize().height());
-                    WindowVertex vertex(quad[i].x(), quad[i].y(),
-                                        (xFactor * oldGeometry.width() + oldGeometry.x())/qreal(previous->size().width()),
-                                        (yFactor * oldGeometry.height() + oldGeometry.y())/qreal(previous->size().height()));
-                    newQuad[i] = vertex;
-                }
-                quads[PreviousContentLeaf].append(newQuad);
-            }
+        if (previous && !scalePreviousPixmap) {
+            quads[PreviousContentLeaf] = mapToPixmapContents(quads[ContentLeaf], toplevel, previous);
         }
     }
 
@@ -1596,6 +1615,9 @@ void SceneOpenGL2Window::performPaint(int mask, QRegion region, WindowPaintData
 
     LeafNode nodes[LeafCount];
     setupLeafNodes(nodes, quads, data);
+    if (scalePreviousPixmap) {
+        nodes[ContentLeaf].coordinateType = NormalizedCoordinates;
+    }
 
     for (int i = 0, v = 0; i < LeafCount; i++) {
         if (quads[i].isEmpty() || !nodes[i].texture)
@@ -1637,6 +1659,10 @@ void SceneOpenGL2Window::performPaint(int mask, QRegion region, WindowPaintData
         vbo->draw(region, primitiveType, nodes[i].firstVertex, nodes[i].vertexCount, m_hardwareClipping);
     }
 
+    if (s_framePixmap && !s_framePixmap->children().isEmpty() && !scalePreviousPixmap && !quads[ContentLeaf].isEmpty()) {
+        paintSubSurfaces(s_framePixmap, shader, region, data, filter);
+    }
+
     vbo->unbindArrays();
 
     setBlendEnabled(false);
@@ -1648,6 +1674,72 @@ void SceneOpenGL2Window::performPaint(int mask, QRegion region, WindowPaintData
 }
 
 
+// collects the subsurfaces below @p pixmap in painting order with their geometry relative to @p offset
+// childSubSurfaces() only provides the order of the siblings, it does not tell whether a subsurface
+// got placed below its parent, so all subsurfaces are painted on top of their parent surface
+static void collectSubSurfaces(WindowPixmap *pixmap, const QPoint &offset, QVector<QPair<OpenGLWindowPixmap*, QPoint>> &subSurfaces)
+{
+    for (WindowPixmap *child : pixmap->children()) {
+        if (child->subSurface().isNull()) {
+            continue;
+        }
+        const QPoint position = offset + child->subSurface()->position();
+        subSurfaces << qMakePair(static_cast<OpenGLWindowPixmap*>(child), position);
+        collectSubSurfaces(child, position, subSurfaces);
+    }
+}
+
+void SceneOpenGL2Window::paintSubSurfaces(OpenGLWindowPixmap *pixmap, GLShader *shader, const QRegion &region,
+                                          const WindowPaintData &data, GLenum filter)
+{
+    QVector<QPair<OpenGLWindowPixmap*, QPoint>> subSurfaces;
+    collectSubSurfaces(pixmap, toplevel->clientPos(), subSurfaces);
+    // binding uploads the damaged parts of each subsurface's buffer into its own texture
+    for (auto it = subSurfaces.begin(); it != subSurfaces.end();) {
+        if ((*it).first->bind()) {
+            ++it;
+        } else {
+            it = subSurfaces.erase(it);
+        }
+    }
+    if (subSurfaces.isEmpty()) {
+        return;
+    }
+
+    const bool indexedQuads = GLVertexBuffer::supportsIndexedQuads();
+    const GLenum primitiveType = indexedQuads ? GL_QUADS : GL_TRIANGLES;
+    const int verticesPerQuad = indexedQuads ? 4 : 6;
+
+    GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
+    vbo->unbindArrays();
+    GLVertex2D *map = (GLVertex2D *) vbo->map(verticesPerQuad * subSurfaces.count() * sizeof(GLVertex2D));
+    for (int i = 0; i < subSurfaces.count(); ++i) {
+        const QRect rect(subSurfaces.at(i).second, subSurfaces.at(i).first->size());
+        WindowQuad quad(WindowQuadContents);
+        quad[0] = WindowVertex(rect.x(), rect.y(), 0, 0);
+        quad[1] = WindowVertex(rect.x() + rect.width(), rect.y(), rect.width(), 0);
+        quad[2] = WindowVertex(rect.x() + rect.width(), rect.y() + rect.height(), rect.width(), rect.height());
+        quad[3] = WindowVertex(rect.x(), rect.y() + rect.height(), 0, rect.height());
+        WindowQuadList quads;
+        quads << quad;
+        const QMatrix4x4 matrix = subSurfaces.at(i).first->texture()->matrix(UnnormalizedCoordinates);
+        quads.makeInterleavedArrays(primitiveType, &map[i * verticesPerQuad], matrix);
+    }
+    vbo->unmap();
+    vbo->bindArrays();
+
+    shader->setUniform(GLShader::ModulationConstant, modulate(data.opacity(), data.brightness()));
+    for (int i = 0; i < subSurfaces.count(); ++i) {
+        OpenGLWindowPixmap *child = subSurfaces.at(i).first;
+        setBlendEnabled(data.opacity() < 1.0 || child->buffer().isNull() || child->buffer()->hasAlphaChannel());
+        SceneOpenGL::Texture *texture = child->texture();
+        texture->setFilter(filter);
+        texture->setWrapMode(GL_CLAMP_TO_EDGE);
+        texture->bind();
+        vbo->draw(region, primitiveType, i * verticesPerQuad, verticesPerQuad, m_hardwareClipping);
+    }
+}
+
 //****************************************
 // OpenGLWindowPixmap
 //****************************************
@@ -1655,6 +1747,14 @@ void SceneOpenGL2Window::performPaint(int mask, QRegion region, WindowPaintData
 OpenGLWindowPixmap::OpenGLWindowPixmap(Scene::Window *window, SceneOpenGL* scene)
     : WindowPixmap(window)
     , m_texture(scene->createTexture())
+    , m_scene(scene)
+{
+}
+
+OpenGLWindowPixmap::OpenGLWindowPixmap(const QPointer<KWayland::Server::SubSurfaceInterface> &subSurface, WindowPixmap *parent, SceneOpenGL *scene)
+    : WindowPixmap(subSurface, parent)
+    , m_texture(scene->createTexture())
+    , m_scene(scene)
 {
 }
 
@@ -1662,17 +1762,46 @@ OpenGLWindowPixmap::~OpenGLWindowPixmap()
 {
 }
 
+WindowPixmap *OpenGLWindowPixmap::createChild(const QPointer<KWayland::Server::SubSurfaceInterface> &subSurface)
+{
+    return new OpenGLWindowPixmap(subSurface, this, m_scene);
+}
+
+// bytes copied into a texture when updating @p region of @p buffer, only shared memory buffers get copied
+static quint64 uploadSize(const QPointer<KWayland::Server::BufferInterface> &buffer, const QRegion &region)
+{
+    if (buffer.isNull() || !buffer->shmBuffer()) {
+        return 0;
+    }
+    quint64 pixels = 0;
+    for (const QRect &rect : (region & QRect(QPoint(0, 0), buffer->size())).rects()) {
+        pixels += quint64(rect.width()) * quint64(rect.height());
+    }
+    return pixels * 4;
+}
+
 bool OpenGLWindowPixmap::bind()
 {
     if (!m_texture->isNull()) {
-        if (!toplevel()->damage().isEmpty()) {
-            updateBuffer();
+        if (damage().isEmpty()) {
+            return true;
+        }
+        updateBuffer();
+        // the main surface gets a new WindowPixmap when its size changes, a subsurface
+        // has to reload its texture
+        const bool resized = !subSurface().isNull() && !buffer().isNull() && buffer()->size() != m_texture->size();
+        if (!resized) {
+            m_scene->countUploadedBytes(uploadSize(buffer(), damage()));
             m_texture->updateFromPixmap(this);
             // mipmaps need to be updated
             m_texture->setDirty();
-            toplevel()->resetDamage();
+            resetDamage();
+            return true;
         }
-        return true;
+    }
+    if (!isValid() && !subSurface().isNull()) {
+        // a subsurface might not have had a buffer attached when it entered the tree
+        updateBuffer();
     }
     if (!isValid()) {
         return false;
@@ -1680,10 +1809,15 @@ bool OpenGLWindowPixmap::bind()
 
     bool success = m_texture->load(this);
 
-    if (success)
-        toplevel()->resetDamage();
-    else
+    if (success) {
+        resetDamage();
+        m_scene->countTextureAllocation();
+        if (!buffer().isNull()) {
+            m_scene->countUploadedBytes(uploadSize(buffer(), QRect(QPoint(0, 0), buffer()->size())));
+        }
+    } else {
         qCDebug(KWIN_CORE) << "Failed to bind window";
+    }
     return success;
 }
 
@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef KWIN_SCENE_OPENGL_H
 #define KWIN_SCENE_OPENGL_H
 
+#include "damageregion.h"
 #include "scene.h"
 #include "shadow.h"
 
@@ -261,6 +262,11 @@ protected:
     virtual void performPaint(int mask, QRegion region, WindowPaintData data);
 
 private:
+    /**
+     * Paints the subsurfaces of @p pixmap on top of the window content.
+     **/
+    void paintSubSurfaces(OpenGLWindowPixmap *pixmap, GLShader *shader, const QRegion &region,
+                          const WindowPaintData &data, GLenum filter);
     /**
      * Whether prepareStates enabled blending and restore states should disable again.
      **/
@@ -274,8 +280,12 @@ public:
     virtual ~OpenGLWindowPixmap();
     SceneOpenGL::Texture *texture() const;
     bool bind();
+protected:
+    WindowPixmap *createChild(const QPointer<KWayland::Server::SubSurfaceInterface> &subSurface) override;
 private:
+    explicit OpenGLWindowPixmap(const QPointer<KWayland::Server::SubSurfaceInterface> &subSurface, WindowPixmap *parent, SceneOpenGL *scene);
     QScopedPointer<SceneOpenGL::Texture> m_texture;
+    SceneOpenGL *m_scene;
 };
 
 class SceneOpenGL::EffectFrame
@@ -607,7 +617,7 @@ private:
     /**
      * @brief The damage history for the past 10 frames.
      */
-    QList<QRegion> m_damageHistory;
+    DamageHistory m_damageHistory;
     /**
      * @brief Timer to measure how long a frame renders.
      **/
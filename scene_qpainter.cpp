@@ -30,6 +30,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "abstract_backend.h"
 #include "wayland_server.h"
 #include <KWayland/Server/buffer_interface.h>
+#include <KWayland/Server/subcompositor_interface.h>
 #include <KWayland/Server/surface_interface.h>
 #include "xcbutils.h"
 #include "decorations/decoratedclient.h"
@@ -236,6 +237,27 @@ SceneQPainter::Window::~Window()
     discardShape();
 }
 
+// paints the subsurfaces below @p pixmap in their stacking order relative to @p offset
+static void paintSubSurfaces(QPainter *painter, WindowPixmap *pixmap, const QPoint &offset)
+{
+    for (WindowPixmap *child : pixmap->children()) {
+        if (child->subSurface().isNull()) {
+            continue;
+        }
+        QPainterWindowPixmap *p = static_cast<QPainterWindowPixmap*>(child);
+        if (!p->damage().isEmpty()) {
+            p->update(p->damage());
+            p->resetDamage();
+        }
+        if (!p->isValid()) {
+            continue;
+        }
+        const QPoint position = offset + child->subSurface()->position();
+        painter->drawImage(position, p->image());
+        paintSubSurfaces(painter, child, position);
+    }
+}
+
 void SceneQPainter::Window::performPaint(int mask, QRegion region, WindowPaintData data)
 {
     if (!(mask & (PAINT_WINDOW_TRANSFORMED | PAINT_SCREEN_TRANSFORMED)))
@@ -282,6 +304,7 @@ void SceneQPainter::Window::performPaint(int mask, QRegion region, WindowPaintDa
     // render content
     const QRect src = QRect(toplevel->clientPos() + toplevel->clientContentPos(), toplevel->clientSize());
     painter->drawImage(toplevel->clientPos(), pixmap->image(), src);
+    paintSubSurfaces(painter, pixmap, toplevel->clientPos());
 
     if (!opaque) {
         tempPainter.restore();
@@ -408,10 +431,20 @@ QPainterWindowPixmap::QPainterWindowPixmap(Scene::Window *window)
 {
 }
 
+QPainterWindowPixmap::QPainterWindowPixmap(const QPointer<KWayland::Server::SubSurfaceInterface> &subSurface, WindowPixmap *parent)
+    : WindowPixmap(subSurface, parent)
+{
+}
+
 QPainterWindowPixmap::~QPainterWindowPixmap()
 {
 }
 
+WindowPixmap *QPainterWindowPixmap::createChild(const QPointer<KWayland::Server::SubSurfaceInterface> &subSurface)
+{
+    return new QPainterWindowPixmap(subSurface, this);
+}
+
 void QPainterWindowPixmap::create()
 {
     if (isValid()) {
@@ -441,6 +474,11 @@ bool QPainterWindowPixmap::update(const QRegion &damage)
         if (b == oldBuffer || b.isNull()) {
             return false;
         }
+        if (b->size() != m_image.size()) {
+            // only subsurfaces keep their WindowPixmap when the size changes
+            m_image = b->data().copy();
+            return true;
+        }
         QPainter p(&m_image);
         const QImage &data = b->data();
         p.setCompositionMode(QPainter::CompositionMode_Source);
@@ -162,7 +162,10 @@ public:
 
     bool update(const QRegion &damage);
     const QImage &image();
+protected:
+    WindowPixmap *createChild(const QPointer<KWayland::Server::SubSurfaceInterface> &subSurface) override;
 private:
+    explicit QPainterWindowPixmap(const QPointer<KWayland::Server::SubSurfaceInterface> &subSurface, WindowPixmap *parent);
     QScopedPointer<Xcb::Shm> m_shm;
     QImage m_image;
 };
@@ -60,6 +60,13 @@ public:
         return m_scriptFile;
     }
     virtual void reconfigure(ReconfigureFlags flags);
+    // scripts cannot paint, so only animated windows need to go through the effect
+    PaintHooks paintHooks() const override {
+        return animationPaintHooks();
+    }
+    bool isActiveForWindow(EffectWindow *w) const override {
+        return isAnimatedWindow(w);
+    }
     int requestedEffectChainPosition() const override {
         return m_chainPosition;
     }
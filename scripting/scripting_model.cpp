@@ -28,6 +28,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "shell_client.h"
 #include "wayland_server.h"
 
+#include <QSet>
+
+#include <algorithm>
+
 namespace KWin {
 namespace ScriptingClientModel {
 
@@ -39,44 +43,21 @@ static quint32 nextId() {
 ClientLevel::ClientLevel(ClientModel *model, AbstractLevel *parent)
     : AbstractLevel(model, parent)
 {
-    connect(Workspace::self(), &Workspace::clientAdded, this, &ClientLevel::clientAdded);
-    connect(Workspace::self(), &Workspace::clientRemoved, this, &ClientLevel::clientRemoved);
-    connect(model, SIGNAL(exclusionsChanged()), SLOT(reInit()));
-    if (waylandServer()) {
-        connect(waylandServer(), &WaylandServer::shellClientAdded, this, &ClientLevel::clientAdded);
-    }
+    model->m_leafs.append(this);
 }
 
 ClientLevel::~ClientLevel()
 {
+    ClientModel *m = model();
+    m->m_leafs.removeOne(this);
+    for (quint32 id : m_ids) {
+        m->m_clientLevels.remove(id);
+    }
 }
 
-void ClientLevel::clientAdded(AbstractClient *client)
-{
-    setupClientConnections(client);
-    checkClient(client);
-}
-
-void ClientLevel::clientRemoved(AbstractClient *client)
-{
-    removeClient(client);
-}
-
-void ClientLevel::setupClientConnections(AbstractClient *client)
-{
-    auto check = [this, client] {
-        checkClient(client);
-    };
-    connect(client, &AbstractClient::desktopChanged, this, check);
-    connect(client, &AbstractClient::screenChanged, this, check);
-    connect(client, &AbstractClient::activitiesChanged, this, check);
-    connect(client, &AbstractClient::windowHidden, this, check);
-    connect(client, &AbstractClient::windowShown, this, check);
-}
-
-void ClientLevel::checkClient(AbstractClient *client)
+void ClientLevel::checkClient(AbstractClient *client, bool excluded)
 {
-    const bool shouldInclude = !exclude(client) && shouldAdd(client);
+    const bool shouldInclude = !excluded && shouldAdd(client);
     const bool contains = containsClient(client);
 
     if (shouldInclude && !contains) {
@@ -86,75 +67,6 @@ void ClientLevel::checkClient(AbstractClient *client)
     }
 }
 
-bool ClientLevel::exclude(AbstractClient *client) const
-{
-    ClientModel::Exclusions exclusions = model()->exclusions();
-    if (exclusions == ClientModel::NoExclusion) {
-        return false;
-    }
-    if (exclusions & ClientModel::DesktopWindowsExclusion) {
-        if (client->isDesktop()) {
-            return true;
-        }
-    }
-    if (exclusions & ClientModel::DockWindowsExclusion) {
-        if (client->isDock()) {
-            return true;
-        }
-    }
-    if (exclusions & ClientModel::UtilityWindowsExclusion) {
-        if (client->isUtility()) {
-            return true;
-        }
-    }
-    if (exclusions & ClientModel::SpecialWindowsExclusion) {
-        if (client->isSpecialWindow()) {
-            return true;
-        }
-    }
-    if (exclusions & ClientModel::SkipTaskbarExclusion) {
-        if (client->skipTaskbar()) {
-            return true;
-        }
-    }
-    if (exclusions & ClientModel::SkipPagerExclusion) {
-        if (client->skipPager()) {
-            return true;
-        }
-    }
-    if (exclusions & ClientModel::SwitchSwitcherExclusion) {
-        if (client->skipSwitcher()) {
-            return true;
-        }
-    }
-    if (exclusions & ClientModel::OtherDesktopsExclusion) {
-        if (!client->isOnCurrentDesktop()) {
-            return true;
-        }
-    }
-    if (exclusions & ClientModel::OtherActivitiesExclusion) {
-        if (!client->isOnCurrentActivity()) {
-            return true;
-        }
-    }
-    if (exclusions & ClientModel::MinimizedExclusion) {
-        if (client->isMinimized()) {
-            return true;
-        }
-    }
-    if (exclusions & ClientModel::NonSelectedWindowTabExclusion) {
-        if (!client->isCurrentTab()) {
-            return true;
-        }
-    }
-    if (exclusions & ClientModel::NotAcceptingFocusExclusion) {
-        if (!client->wantsInput()) {
-            return true;
-        }
-    }
-    return false;
-}
-
 bool ClientLevel::shouldAdd(AbstractClient *client) const
 {
     if (restrictions() == ClientModel::NoRestriction) {
@@ -178,69 +90,101 @@ bool ClientLevel::shouldAdd(AbstractClient *client) const
     return true;
 }
 
+void ClientLevel::insertClient(AbstractClient *client)
+{
+    const quint32 id = nextId();
+    m_ids.append(id);
+    m_clients.insert(id, client);
+    m_clientIds.insert(client, id);
+    model()->m_clientLevels.insert(id, this);
+}
+
 void ClientLevel::addClient(AbstractClient *client)
 {
     if (containsClient(client)) {
         return;
     }
-    emit beginInsert(m_clients.count(), m_clients.count(), id());
-    m_clients.insert(nextId(), client);
+    emit beginInsert(m_ids.count(), m_ids.count(), id());
+    insertClient(client);
     emit endInsert();
 }
 
 void ClientLevel::removeClient(AbstractClient *client)
 {
-    int index = 0;
-    auto it = m_clients.begin();
-    for (; it != m_clients.end(); ++it, ++index) {
-        if (it.value() == client) {
-            break;
-        }
-    }
-    if (it == m_clients.end()) {
+    auto it = m_clientIds.find(client);
+    if (it == m_clientIds.end()) {
         return;
     }
+    const quint32 clientId = it.value();
+    const int index = rowForId(clientId);
     emit beginRemove(index, index, id());
-    m_clients.erase(it);
+    m_ids.remove(index);
+    m_clients.remove(clientId);
+    m_clientIds.erase(it);
+    model()->m_clientLevels.remove(clientId);
     emit endRemove();
 }
 
 void ClientLevel::init()
 {
-    const ClientList &clients = Workspace::self()->clientList();
-    for (ClientList::const_iterator it = clients.begin(); it != clients.end(); ++it) {
-        Client *client = *it;
-        setupClientConnections(client);
-        if (!exclude(client) && shouldAdd(client)) {
-            m_clients.insert(nextId(), client);
+    const auto candidates = model()->candidates();
+    for (AbstractClient *client : candidates) {
+        if (shouldAdd(client)) {
+            insertClient(client);
         }
     }
 }
 
-void ClientLevel::reInit()
+void ClientLevel::reInit(const QVector<AbstractClient*> &candidates)
 {
-    const ClientList &clients = Workspace::self()->clientList();
-    for (ClientList::const_iterator it = clients.begin(); it != clients.end(); ++it) {
-        checkClient((*it));
+    QSet<AbstractClient*> included;
+    QVector<AbstractClient*> added;
+    for (AbstractClient *client : candidates) {
+        if (!shouldAdd(client)) {
+            continue;
+        }
+        included.insert(client);
+        if (!containsClient(client)) {
+            added << client;
+        }
     }
-    if (waylandServer()) {
-        const auto &clients = waylandServer()->clients();
-        for (auto *c : clients) {
-            checkClient(c);
+    // remove from the end, so that the rows of the pending ranges stay valid
+    int row = m_ids.count() - 1;
+    while (row >= 0) {
+        if (included.contains(m_clients.value(m_ids.at(row)))) {
+            row--;
+            continue;
+        }
+        const int last = row;
+        while (row > 0 && !included.contains(m_clients.value(m_ids.at(row - 1)))) {
+            row--;
+        }
+        emit beginRemove(row, last, id());
+        for (int i = row; i <= last; ++i) {
+            const quint32 clientId = m_ids.at(i);
+            m_clientIds.remove(m_clients.take(clientId));
+            model()->m_clientLevels.remove(clientId);
         }
+        m_ids.remove(row, last - row + 1);
+        emit endRemove();
+        row--;
+    }
+    if (added.isEmpty()) {
+        return;
+    }
+    emit beginInsert(m_ids.count(), m_ids.count() + added.count() - 1, id());
+    for (AbstractClient *client : added) {
+        insertClient(client);
     }
+    emit endInsert();
 }
 
 quint32 ClientLevel::idForRow(int row) const
 {
-    if (row >= m_clients.size()) {
+    if (row < 0 || row >= m_ids.size()) {
         return 0;
     }
-    auto it = m_clients.constBegin();
-    for (int i=0; i<row; ++i) {
-        ++it;
-    }
-    return it.key();
+    return m_ids.at(row);
 }
 
 bool ClientLevel::containsId(quint32 id) const
@@ -250,36 +194,21 @@ bool ClientLevel::containsId(quint32 id) const
 
 int ClientLevel::rowForId(quint32 id) const
 {
-    int row = 0;
-    for (auto it = m_clients.constBegin();
-            it != m_clients.constEnd();
-            ++it, ++row) {
-        if (it.key() == id) {
-            return row;
-        }
+    auto it = std::lower_bound(m_ids.constBegin(), m_ids.constEnd(), id);
+    if (it == m_ids.constEnd() || *it != id) {
+        return -1;
     }
-    return -1;
+    return it - m_ids.constBegin();
 }
 
 AbstractClient *ClientLevel::clientForId(quint32 child) const
 {
-    auto it = m_clients.constFind(child);
-    if (it == m_clients.constEnd()) {
-        return nullptr;
-    }
-    return it.value();
+    return m_clients.value(child);
 }
 
 bool ClientLevel::containsClient(AbstractClient *client) const
 {
-    for (auto it = m_clients.constBegin();
-            it != m_clients.constEnd();
-            ++it) {
-        if (it.value() == client) {
-            return true;
-        }
-    }
-    return false;
+    return m_clientIds.contains(client);
 }
 
 const AbstractLevel *ClientLevel::levelForId(quint32 id) const
@@ -379,10 +308,12 @@ AbstractLevel::AbstractLevel(ClientModel *model, AbstractLevel *parent)
     , m_restrictions(ClientModel::NoRestriction)
     , m_id(nextId())
 {
+    m_model->m_levels.insert(m_id, this);
 }
 
 AbstractLevel::~AbstractLevel()
 {
+    m_model->m_levels.remove(m_id);
 }
 
 void AbstractLevel::setRestriction(ClientModel::LevelRestriction restriction)
@@ -662,10 +593,154 @@ ClientModel::ClientModel(QObject *parent)
     roleNames.insert(DesktopRole, "desktop");
     roleNames.insert(ActivityRole, "activity");
     setRoleNames(roleNames);
+
+    connect(Workspace::self(), &Workspace::clientAdded, this, &ClientModel::clientAdded);
+    connect(Workspace::self(), &Workspace::clientRemoved, this, &ClientModel::clientRemoved);
+    connect(this, &ClientModel::exclusionsChanged, this, &ClientModel::reInit);
+    if (waylandServer()) {
+        connect(waylandServer(), &WaylandServer::shellClientAdded, this, &ClientModel::clientAdded);
+    }
 }
 
 ClientModel::~ClientModel()
 {
+    // the levels unregister themselves from the indexes
+    delete m_root;
+}
+
+void ClientModel::setupClientConnections(AbstractClient *client)
+{
+    connect(client, &AbstractClient::desktopChanged, this, &ClientModel::clientChanged, Qt::UniqueConnection);
+    connect(client, &AbstractClient::screenChanged, this, &ClientModel::clientChanged, Qt::UniqueConnection);
+    connect(client, &AbstractClient::activitiesChanged, this, &ClientModel::clientChanged, Qt::UniqueConnection);
+    connect(client, &AbstractClient::windowHidden, this, &ClientModel::clientChanged, Qt::UniqueConnection);
+    connect(client, &AbstractClient::windowShown, this, &ClientModel::clientChanged, Qt::UniqueConnection);
+}
+
+void ClientModel::clientAdded(AbstractClient *client)
+{
+    setupClientConnections(client);
+    checkClient(client);
+}
+
+void ClientModel::clientRemoved(AbstractClient *client)
+{
+    for (ClientLevel *level : m_leafs) {
+        level->removeClient(client);
+    }
+}
+
+void ClientModel::clientChanged()
+{
+    if (AbstractClient *client = qobject_cast<AbstractClient*>(sender())) {
+        checkClient(client);
+    }
+}
+
+void ClientModel::checkClient(AbstractClient *client)
+{
+    // the exclusions are the same for all levels, only the restrictions differ
+    const bool excluded = exclude(client);
+    for (ClientLevel *level : m_leafs) {
+        level->checkClient(client, excluded);
+    }
+}
+
+void ClientModel::reInit()
+{
+    const auto clients = candidates();
+    for (ClientLevel *level : m_leafs) {
+        level->reInit(clients);
+    }
+}
+
+QVector<AbstractClient*> ClientModel::candidates() const
+{
+    QVector<AbstractClient*> clients;
+    const ClientList &x11Clients = Workspace::self()->clientList();
+    for (Client *client : x11Clients) {
+        if (!exclude(client)) {
+            clients << client;
+        }
+    }
+    if (waylandServer()) {
+        const auto &shellClients = waylandServer()->clients();
+        for (ShellClient *client : shellClients) {
+            if (!exclude(client)) {
+                clients << client;
+            }
+        }
+    }
+    return clients;
+}
+
+bool ClientModel::exclude(AbstractClient *client) const
+{
+    const Exclusions exclusions = m_exclusions;
+    if (exclusions == ClientModel::NoExclusion) {
+        return false;
+    }
+    if (exclusions & ClientModel::DesktopWindowsExclusion) {
+        if (client->isDesktop()) {
+            return true;
+        }
+    }
+    if (exclusions & ClientModel::DockWindowsExclusion) {
+        if (client->isDock()) {
+            return true;
+        }
+    }
+    if (exclusions & ClientModel::UtilityWindowsExclusion) {
+        if (client->isUtility()) {
+            return true;
+        }
+    }
+    if (exclusions & ClientModel::SpecialWindowsExclusion) {
+        if (client->isSpecialWindow()) {
+            return true;
+        }
+    }
+    if (exclusions & ClientModel::SkipTaskbarExclusion) {
+        if (client->skipTaskbar()) {
+            return true;
+        }
+    }
+    if (exclusions & ClientModel::SkipPagerExclusion) {
+        if (client->skipPager()) {
+            return true;
+        }
+    }
+    if (exclusions & ClientModel::SwitchSwitcherExclusion) {
+        if (client->skipSwitcher()) {
+            return true;
+        }
+    }
+    if (exclusions & ClientModel::OtherDesktopsExclusion) {
+        if (!client->isOnCurrentDesktop()) {
+            return true;
+        }
+    }
+    if (exclusions & ClientModel::OtherActivitiesExclusion) {
+        if (!client->isOnCurrentActivity()) {
+            return true;
+        }
+    }
+    if (exclusions & ClientModel::MinimizedExclusion) {
+        if (client->isMinimized()) {
+            return true;
+        }
+    }
+    if (exclusions & ClientModel::NonSelectedWindowTabExclusion) {
+        if (!client->isCurrentTab()) {
+            return true;
+        }
+    }
+    if (exclusions & ClientModel::NotAcceptingFocusExclusion) {
+        if (!client->wantsInput()) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void ClientModel::setLevels(QList< ClientModel::LevelRestriction > restrictions)
@@ -675,6 +750,16 @@ void ClientModel::setLevels(QList< ClientModel::LevelRestriction > restrictions)
         delete m_root;
     }
     m_root = AbstractLevel::create(restrictions, NoRestriction, this);
+    const ClientList &clients = Workspace::self()->clientList();
+    for (Client *client : clients) {
+        setupClientConnections(client);
+    }
+    if (waylandServer()) {
+        const auto &shellClients = waylandServer()->clients();
+        for (ShellClient *client : shellClients) {
+            setupClientConnections(client);
+        }
+    }
     connect(m_root, SIGNAL(beginInsert(int,int,quint32)), SLOT(levelBeginInsert(int,int,quint32)));
     connect(m_root, SIGNAL(beginRemove(int,int,quint32)), SLOT(levelBeginRemove(int,int,quint32)));
     connect(m_root, SIGNAL(endInsert()), SLOT(levelEndInsert()));
@@ -710,8 +795,10 @@ QVariant ClientModel::data(const QModelIndex &index, int role) const
         }
     }
     if (role == Qt::DisplayRole || role == ClientRole) {
-        if (AbstractClient *client = m_root->clientForId(index.internalId())) {
-            return qVariantFromValue(client);
+        if (const ClientLevel *level = m_clientLevels.value(index.internalId())) {
+            if (AbstractClient *client = level->clientForId(index.internalId())) {
+                return qVariantFromValue(client);
+            }
         }
     }
     return QVariant();
@@ -755,18 +842,30 @@ QModelIndex ClientModel::parentForId(quint32 childId) const
         // asking for parent of our toplevel
         return QModelIndex();
     }
-    if (AbstractLevel *parentLevel = m_root->parentForId(childId)) {
-        if (parentLevel == m_root) {
-            return QModelIndex();
-        }
-        const int row = m_root->rowForId(parentLevel->id());
-        if (row == -1) {
-            // error
-            return QModelIndex();
+    AbstractLevel *parentLevel = m_clientLevels.value(childId);
+    if (!parentLevel) {
+        if (AbstractLevel *level = m_levels.value(childId)) {
+            parentLevel = level->parentLevel();
         }
-        return createIndex(row, 0, parentLevel->id());
     }
-    return QModelIndex();
+    if (!parentLevel || parentLevel == m_root) {
+        return QModelIndex();
+    }
+    return indexForLevel(parentLevel->id());
+}
+
+QModelIndex ClientModel::indexForLevel(quint32 id) const
+{
+    const AbstractLevel *level = m_levels.value(id);
+    if (!level || !level->parentLevel()) {
+        return QModelIndex();
+    }
+    const int row = level->parentLevel()->rowForId(id);
+    if (row == -1) {
+        // error
+        return QModelIndex();
+    }
+    return createIndex(row, 0, id);
 }
 
 QModelIndex ClientModel::index(int row, int column, const QModelIndex &parent) const
@@ -799,27 +898,17 @@ const AbstractLevel *ClientModel::getLevel(const QModelIndex &index) const
     if (!index.isValid()) {
         return m_root;
     }
-    return m_root->levelForId(index.internalId());
+    return m_levels.value(index.internalId());
 }
 
 void ClientModel::levelBeginInsert(int rowStart, int rowEnd, quint32 id)
 {
-    const int row = m_root->rowForId(id);
-    QModelIndex parent;
-    if (row != -1) {
-        parent = createIndex(row, 0, id);
-    }
-    beginInsertRows(parent, rowStart, rowEnd);
+    beginInsertRows(indexForLevel(id), rowStart, rowEnd);
 }
 
 void ClientModel::levelBeginRemove(int rowStart, int rowEnd, quint32 id)
 {
-    const int row = m_root->rowForId(id);
-    QModelIndex parent;
-    if (row != -1) {
-        parent = createIndex(row, 0, id);
-    }
-    beginRemoveRows(parent, rowStart, rowEnd);
+    beginRemoveRows(indexForLevel(id), rowStart, rowEnd);
 }
 
 void ClientModel::levelEndInsert()
@@ -22,7 +22,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QAbstractItemModel>
 #include <QSortFilterProxyModel>
+#include <QHash>
 #include <QList>
+#include <QVector>
 
 namespace KWin {
 class AbstractClient;
@@ -31,6 +33,7 @@ class Client;
 namespace ScriptingClientModel {
 
 class AbstractLevel;
+class ClientLevel;
 
 class ClientModel : public QAbstractItemModel
 {
@@ -86,6 +89,11 @@ private Q_SLOTS:
     void levelEndInsert();
     void levelBeginRemove(int rowStart, int rowEnd, quint32 parentId);
     void levelEndRemove();
+    void clientAdded(KWin::AbstractClient *client);
+    void clientRemoved(KWin::AbstractClient *client);
+    // uses sender()
+    void clientChanged();
+    void reInit();
 
 protected:
     enum ClientModelRoles {
@@ -97,10 +105,32 @@ protected:
     void setLevels(QList<LevelRestriction> restrictions);
 
 private:
+    friend class AbstractLevel;
+    friend class ClientLevel;
     QModelIndex parentForId(quint32 childId) const;
+    /**
+     * @returns the index of the level with @p id in its parent level, an invalid index for the root
+     **/
+    QModelIndex indexForLevel(quint32 id) const;
     const AbstractLevel *getLevel(const QModelIndex &index) const;
+    void setupClientConnections(AbstractClient *client);
+    void checkClient(AbstractClient *client);
+    bool exclude(AbstractClient *client) const;
+    /**
+     * @returns all Clients which are not excluded, in the order they should be added to the ClientLevels
+     **/
+    QVector<AbstractClient*> candidates() const;
     AbstractLevel *m_root;
     Exclusions m_exclusions;
+    /**
+     * All levels of the tree by their id, maintained by the AbstractLevels.
+     **/
+    QHash<quint32, AbstractLevel*> m_levels;
+    /**
+     * The ClientLevel holding the Client for each Client id, maintained by the ClientLevels.
+     **/
+    QHash<quint32, ClientLevel*> m_clientLevels;
+    QVector<ClientLevel*> m_leafs;
 };
 
 /**
@@ -122,8 +152,8 @@ private:
  * will add the Clients to the ClientLevel.
  *
  * Each element of the tree has a unique id which can be used by the QAbstractItemModel as the
- * internal id for its QModelIndex. Note: the ids have no ordering, if trying to get a specific element
- * the tree performs a depth-first search.
+ * internal id for its QModelIndex. The ClientModel keeps an index of all levels and of the ClientLevel
+ * each Client id belongs to, so that mapping an id to its element does not need to search the tree.
  *
  */
 class AbstractLevel : public QObject
@@ -206,7 +236,8 @@ private:
  *
  * This class groups all the Clients of one branch of the tree and takes care of updating the tree
  * when a Client changes its state in a way that it should be excluded/included or gets added or
- * removed.
+ * removed. The ClientModel tracks the Clients, evaluates the exclusions once per change and passes
+ * the result to all ClientLevels.
  *
  * The Clients in this group are not sorted in any particular way. It's a simple list which only
  * gets added to. If some sorting should be applied, use a QSortFilterProxyModel.
@@ -227,21 +258,29 @@ public:
     AbstractClient *clientForId(quint32 child) const;
     virtual const AbstractLevel *levelForId(quint32 id) const;
     virtual AbstractLevel *parentForId(quint32 child) const override;
-public Q_SLOTS:
-    void clientAdded(KWin::AbstractClient *client);
-    void clientRemoved(KWin::AbstractClient *client);
-private Q_SLOTS:
-    // uses sender()
-    void reInit();
+
+    /**
+     * Adds or removes @p client depending on whether it is @p excluded and the restrictions of this level.
+     **/
+    void checkClient(AbstractClient *client, bool excluded);
+    void removeClient(AbstractClient *client);
+    /**
+     * Syncs the level with the @p candidates, which are all Clients not being excluded.
+     * Removed rows are announced in contiguous ranges, all added rows in one insertion.
+     **/
+    void reInit(const QVector<AbstractClient*> &candidates);
 private:
-    void checkClient(KWin::AbstractClient *client);
-    void setupClientConnections(AbstractClient *client);
     void addClient(AbstractClient *client);
-    void removeClient(AbstractClient *client);
+    void insertClient(AbstractClient *client);
     bool shouldAdd(AbstractClient *client) const;
-    bool exclude(AbstractClient *client) const;
     bool containsClient(AbstractClient *client) const;
-    QMap<quint32, AbstractClient*> m_clients;
+    /**
+     * The ids of the Clients in row order. Ids are handed out in increasing order and Clients are
+     * only appended, so the ids are sorted and the row of an id can be found with a binary search.
+     **/
+    QVector<quint32> m_ids;
+    QHash<quint32, AbstractClient*> m_clients;
+    QHash<AbstractClient*, quint32> m_clientIds;
 };
 
 class SimpleClientModel : public ClientModel
@@ -50,32 +50,23 @@ void MockTabBoxHandler::setActiveClient(const QWeakPointer< TabBox::TabBoxClient
 QWeakPointer< TabBox::TabBoxClient > MockTabBoxHandler::clientToAddToList(TabBox::TabBoxClient *client, int desktop) const
 {
     Q_UNUSED(desktop)
-    QList< QSharedPointer< TabBox::TabBoxClient > >::const_iterator it = m_windows.constBegin();
-    for (; it != m_windows.constEnd(); ++it) {
-        if ((*it).data() == client) {
-            return QWeakPointer< TabBox::TabBoxClient >(*it);
-        }
+    auto it = m_indexes.constFind(client);
+    if (it == m_indexes.constEnd()) {
+        return QWeakPointer< TabBox::TabBoxClient >();
     }
-    return QWeakPointer< TabBox::TabBoxClient >();
+    return QWeakPointer< TabBox::TabBoxClient >(m_windows.at(it.value()));
 }
 
 QWeakPointer< TabBox::TabBoxClient > MockTabBoxHandler::nextClientFocusChain(TabBox::TabBoxClient *client) const
 {
-    QList< QSharedPointer< TabBox::TabBoxClient > >::const_iterator it = m_windows.constBegin();
-    for (; it != m_windows.constEnd(); ++it) {
-        if ((*it).data() == client) {
-            ++it;
-            if (it == m_windows.constEnd()) {
-                return QWeakPointer< TabBox::TabBoxClient >(m_windows.first());
-            } else {
-                return QWeakPointer< TabBox::TabBoxClient >(*it);
-            }
-        }
+    if (m_windows.isEmpty()) {
+        return QWeakPointer< TabBox::TabBoxClient >();
     }
-    if (!m_windows.isEmpty()) {
+    auto it = m_indexes.constFind(client);
+    if (it == m_indexes.constEnd()) {
         return QWeakPointer< TabBox::TabBoxClient >(m_windows.last());
     }
-    return QWeakPointer< TabBox::TabBoxClient >();
+    return QWeakPointer< TabBox::TabBoxClient >(m_windows.at((it.value() + 1) % m_windows.count()));
 }
 
 QWeakPointer< TabBox::TabBoxClient > MockTabBoxHandler::firstClientFocusChain() const
@@ -91,18 +82,13 @@ bool MockTabBoxHandler::isInFocusChain(TabBox::TabBoxClient *client) const
     if (!client) {
         return false;
     }
-    QList< QSharedPointer< TabBox::TabBoxClient > >::const_iterator it = m_windows.constBegin();
-    for (; it != m_windows.constEnd(); ++it) {
-        if ((*it).data() == client) {
-            return true;
-        }
-    }
-    return false;
+    return m_indexes.contains(client);
 }
 
 QWeakPointer< TabBox::TabBoxClient > MockTabBoxHandler::createMockWindow(const QString &caption, WId id)
 {
     QSharedPointer< TabBox::TabBoxClient > client(new MockTabBoxClient(caption, id));
+    m_indexes.insert(client.data(), m_windows.count());
     m_windows.append(client);
     m_activeClient = client;
     return QWeakPointer< TabBox::TabBoxClient >(client);
@@ -114,9 +100,18 @@ void MockTabBoxHandler::closeWindow(TabBox::TabBoxClient *client)
     for (; it != m_windows.end(); ++it) {
         if ((*it).data() == client) {
             m_windows.erase(it);
+            updateIndexes();
             return;
         }
     }
 }
 
+void MockTabBoxHandler::updateIndexes()
+{
+    m_indexes.clear();
+    for (int i = 0; i < m_windows.count(); ++i) {
+        m_indexes.insert(m_windows.at(i).data(), i);
+    }
+}
+
 } // namespace KWin
@@ -21,6 +21,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define KWIN_MOCK_TABBOX_HANDLER_H
 
 #include "../tabboxhandler.h"
+
+#include <QHash>
 namespace KWin
 {
 class MockTabBoxHandler : public TabBox::TabBoxHandler
@@ -97,7 +99,10 @@ public:
     QWeakPointer<TabBox::TabBoxClient> createMockWindow(const QString &caption, WId id);
     void closeWindow(TabBox::TabBoxClient *client);
 private:
+    void updateIndexes();
     QList< QSharedPointer<TabBox::TabBoxClient> > m_windows;
+    // position of each window in m_windows, keeps the focus chain lookups cheap for many windows
+    QHash<TabBox::TabBoxClient*, int> m_indexes;
     QWeakPointer<TabBox::TabBoxClient> m_activeClient;
 };
 } // namespace KWin
@@ -89,4 +89,92 @@ void TestTabBoxClientModel::testCreateClientListActiveClientNotInFocusChain()
     QCOMPARE(clientModel->rowCount(), 1);
 }
 
+void TestTabBoxClientModel::testIncrementalUpdate()
+{
+    MockTabBoxHandler tabboxhandler;
+    tabboxhandler.setConfig(TabBox::TabBoxConfig());
+    TabBox::ClientModel *clientModel = new TabBox::ClientModel(&tabboxhandler);
+    QSignalSpy resetSpy(clientModel, &QAbstractItemModel::modelReset);
+    QVERIFY(resetSpy.isValid());
+    QSignalSpy insertedSpy(clientModel, &QAbstractItemModel::rowsInserted);
+    QVERIFY(insertedSpy.isValid());
+    QSignalSpy removedSpy(clientModel, &QAbstractItemModel::rowsRemoved);
+    QVERIFY(removedSpy.isValid());
+
+    QWeakPointer<TabBox::TabBoxClient> first = tabboxhandler.createMockWindow(QString("test"), 1);
+    QWeakPointer<TabBox::TabBoxClient> second = tabboxhandler.createMockWindow(QString("test2"), 2);
+    QWeakPointer<TabBox::TabBoxClient> third = tabboxhandler.createMockWindow(QString("test3"), 3);
+    clientModel->createClientList();
+    QCOMPARE(clientModel->rowCount(), 3);
+    // all rows get inserted at once
+    QCOMPARE(insertedSpy.count(), 1);
+
+    // recreating the unchanged list does not change the rows
+    clientModel->createClientList();
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(removedSpy.count(), 0);
+
+    // closing a window removes its row
+    QSharedPointer<TabBox::TabBoxClient> secondOwner = second.toStrongRef();
+    tabboxhandler.closeWindow(second.data());
+    clientModel->createClientList();
+    QCOMPARE(clientModel->rowCount(), 2);
+    QCOMPARE(removedSpy.count(), 1);
+
+    // a new window gets its row inserted
+    tabboxhandler.createMockWindow(QString("test4"), 4);
+    clientModel->createClientList();
+    QCOMPARE(clientModel->rowCount(), 3);
+    QCOMPARE(insertedSpy.count(), 2);
+
+    // a different active client changes the order
+    tabboxhandler.setActiveClient(first);
+    clientModel->createClientList();
+
+    // the result is the same as for a freshly created model
+    TabBox::ClientModel *freshModel = new TabBox::ClientModel(&tabboxhandler);
+    freshModel->createClientList();
+    QCOMPARE(clientModel->clientList(), freshModel->clientList());
+    QCOMPARE(clientModel->clientList().first(), first);
+    QCOMPARE(resetSpy.count(), 0);
+}
+
+void TestTabBoxClientModel::testCreateClientList_data()
+{
+    QTest::addColumn<int>("clients");
+    QTest::addColumn<bool>("open");
+
+    for (int clients : {10, 150, 500}) {
+        QTest::newRow(qPrintable(QStringLiteral("%1 clients/open").arg(clients))) << clients << true;
+        QTest::newRow(qPrintable(QStringLiteral("%1 clients/client added").arg(clients))) << clients << false;
+    }
+}
+
+void TestTabBoxClientModel::testCreateClientList()
+{
+    QFETCH(int, clients);
+    QFETCH(bool, open);
+    MockTabBoxHandler tabboxhandler;
+    tabboxhandler.setConfig(TabBox::TabBoxConfig());
+    for (int i = 0; i < clients; ++i) {
+        tabboxhandler.createMockWindow(QStringLiteral("client %1").arg(i), i + 1);
+    }
+    if (open) {
+        QBENCHMARK {
+            // opening starts from an empty model
+            TabBox::ClientModel clientModel(&tabboxhandler);
+            clientModel.createClientList();
+        }
+    } else {
+        TabBox::ClientModel clientModel(&tabboxhandler);
+        clientModel.createClientList();
+        int id = clients;
+        QBENCHMARK {
+            ++id;
+            tabboxhandler.createMockWindow(QStringLiteral("client %1").arg(id), id);
+            clientModel.createClientList(true);
+        }
+    }
+}
+
 QTEST_MAIN(TestTabBoxClientModel)
@@ -48,6 +48,17 @@ private slots:
      * See BUG: 306260
      **/
     void testCreateClientListActiveClientNotInFocusChain();
+    /**
+     * Tests that recreating the Client list updates the rows
+     * instead of resetting the model.
+     **/
+    void testIncrementalUpdate();
+    void testCreateClientList_data();
+    /**
+     * Benchmarks creating the Client list when opening the TabBox
+     * and recreating it after a Client got added.
+     **/
+    void testCreateClientList();
 };
 
 #endif
@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "tabboxhandler.h"
 // Qt
 #include <QIcon>
+#include <QSet>
 // TODO: remove with Qt 5, only for HTML escaping the caption
 #include <QTextDocument>
 #include <QTextStream>
@@ -145,9 +146,9 @@ QModelIndex ClientModel::index(int row, int column, const QModelIndex& parent) c
 
 QModelIndex ClientModel::index(QWeakPointer<TabBoxClient> client) const
 {
-    if (!m_clientList.contains(client))
+    const int index = m_clientList.indexOf(client);
+    if (index == -1)
         return QModelIndex();
-    int index = m_clientList.indexOf(client);
     int row = index / columnCount();
     int column = index % columnCount();
     return createIndex(row, column);
@@ -169,7 +170,7 @@ void ClientModel::createClientList(int desktop, bool partialReset)
         }
     }
 
-    m_clientList.clear();
+    TabBoxClientList clientList;
     QList< QWeakPointer< TabBoxClient > > stickyClients;
 
     switch(tabBox->config().clientSwitchingMode()) {
@@ -185,7 +186,7 @@ void ClientModel::createClientList(int desktop, bool partialReset)
         do {
             QWeakPointer<TabBoxClient> add = tabBox->clientToAddToList(c, desktop);
             if (!add.isNull()) {
-                m_clientList += add;
+                clientList += add;
                 if (add.data()->isFirstInTabBox()) {
                     stickyClients << add;
                 }
@@ -195,45 +196,125 @@ void ClientModel::createClientList(int desktop, bool partialReset)
         break;
     }
     case TabBoxConfig::StackingOrderSwitching: {
-        // TODO: needs improvement
-        TabBoxClientList stacking = tabBox->stackingOrder();
-        TabBoxClient* c = stacking.first().data();
-        TabBoxClient* stop = c;
-        int index = 0;
-        while (c) {
+        const TabBoxClientList stacking = tabBox->stackingOrder();
+        clientList.reserve(stacking.count());
+        QWeakPointer<TabBoxClient> startClient;
+        for (const QWeakPointer<TabBoxClient> &clientPointer : stacking) {
+            TabBoxClient *c = clientPointer.data();
+            if (!c) {
+                continue;
+            }
             QWeakPointer<TabBoxClient> add = tabBox->clientToAddToList(c, desktop);
-            if (!add.isNull()) {
-                if (start == add.data()) {
-                    m_clientList.removeAll(add);
-                    m_clientList.prepend(add);
-                } else
-                    m_clientList += add;
-                if (add.data()->isFirstInTabBox()) {
-                    stickyClients << add;
-                }
+            if (add.isNull()) {
+                continue;
             }
-            if (index >= stacking.size() - 1) {
-                c = nullptr;
+            // the start client goes to the front
+            if (start == add.data()) {
+                startClient = add;
             } else {
-                c = stacking[++index].data();
+                clientList += add;
+            }
+            if (add.data()->isFirstInTabBox()) {
+                stickyClients << add;
             }
-
-            if (c == stop)
-                break;
+        }
+        if (!startClient.isNull()) {
+            clientList.prepend(startClient);
         }
         break;
     }
     }
-    foreach (const QWeakPointer< TabBoxClient > &c, stickyClients) {
-        m_clientList.removeAll(c);
-        m_clientList.prepend(c);
+    if (!stickyClients.isEmpty()) {
+        // sticky clients go to the front, the last one found becomes the first
+        QSet<TabBoxClient*> sticky;
+        TabBoxClientList sorted;
+        sorted.reserve(clientList.count());
+        for (auto it = stickyClients.crbegin(); it != stickyClients.crend(); ++it) {
+            sticky.insert((*it).data());
+            sorted << *it;
+        }
+        for (const QWeakPointer<TabBoxClient> &c : clientList) {
+            if (!sticky.contains(c.data())) {
+                sorted << c;
+            }
+        }
+        clientList = sorted;
     }
-    if (tabBox->config().showDesktopMode() == TabBoxConfig::ShowDesktopClient || m_clientList.isEmpty()) {
+    if (tabBox->config().showDesktopMode() == TabBoxConfig::ShowDesktopClient || clientList.isEmpty()) {
         QWeakPointer<TabBoxClient> desktopClient = tabBox->desktopClient();
         if (!desktopClient.isNull())
-            m_clientList.append(desktopClient);
+            clientList.append(desktopClient);
+    }
+    updateClientList(clientList);
+}
+
+void ClientModel::updateClientList(const TabBoxClientList &clientList)
+{
+    QSet<TabBoxClient*> clients;
+    clients.reserve(clientList.count());
+    for (const QWeakPointer<TabBoxClient> &c : clientList) {
+        clients.insert(c.data());
+    }
+
+    // remove the rows of clients which are gone, a deleted client has a null pointer
+    QSet<TabBoxClient*> current;
+    current.reserve(m_clientList.count());
+    for (int row = m_clientList.count() - 1; row >= 0; --row) {
+        TabBoxClient *c = m_clientList.at(row).data();
+        if (c && clients.contains(c) && !current.contains(c)) {
+            current.insert(c);
+            continue;
+        }
+        const int last = row;
+        while (row > 0) {
+            TabBoxClient *previous = m_clientList.at(row - 1).data();
+            if (previous && clients.contains(previous) && !current.contains(previous)) {
+                break;
+            }
+            --row;
+        }
+        beginRemoveRows(QModelIndex(), row, last);
+        m_clientList.erase(m_clientList.begin() + row, m_clientList.begin() + last + 1);
+        endRemoveRows();
+    }
+
+    // all remaining rows are part of the new list, move them into place and insert the new clients
+    for (int row = 0; row < clientList.count(); ++row) {
+        TabBoxClient *c = clientList.at(row).data();
+        if (row < m_clientList.count() && m_clientList.at(row).data() == c) {
+            continue;
+        }
+        int from = m_clientList.count();
+        if (current.contains(c)) {
+            from = row + 1;
+            while (from < m_clientList.count() && m_clientList.at(from).data() != c) {
+                ++from;
+            }
+        }
+        if (from >= m_clientList.count()) {
+            // insert all consecutive new clients at once
+            int last = row;
+            while (last + 1 < clientList.count() && !current.contains(clientList.at(last + 1).data())) {
+                ++last;
+            }
+            beginInsertRows(QModelIndex(), row, last);
+            for (int i = row; i <= last; ++i) {
+                m_clientList.insert(i, clientList.at(i));
+            }
+            endInsertRows();
+            row = last;
+            continue;
+        }
+        beginMoveRows(QModelIndex(), from, from, QModelIndex(), row);
+        m_clientList.move(from, row);
+        endMoveRows();
+    }
+    Q_ASSERT(m_clientList.count() == clientList.count());
+
+    // captions, icons and desktops might have changed since the list was last shown
+    if (!m_clientList.isEmpty()) {
+        emit dataChanged(index(0, 0), index(m_clientList.count() - 1, 0));
     }
-    reset();
 }
 
 void ClientModel::close(int i)
@@ -75,7 +75,9 @@ public:
 
     /**
     * Generates a new list of TabBoxClients based on the current config.
-    * Calling this method will reset the model. If partialReset is true
+    * The model is updated incrementally: rows of clients which are no longer
+    * in the list get removed, new clients get inserted and the remaining
+    * clients get moved to their new position. If partialReset is true
     * the top of the list is kept as a starting point. If not the the
     * current active client is used as the starting point to generate the
     * list.
@@ -104,6 +106,11 @@ public Q_SLOTS:
     void activate(int index);
 
 private:
+    /**
+     * Turns m_clientList into @p clientList with the minimal row removals,
+     * insertions and moves instead of resetting the model.
+     **/
+    void updateClientList(const TabBoxClientList &clientList);
     TabBoxClientList m_clientList;
 };
 
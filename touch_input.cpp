@@ -120,7 +120,7 @@ void TouchInputRedirection::processDown(qint32 id, const QPointF &pos, quint32 t
     if (!m_inited) {
         return;
     }
-    const auto &filters = m_input->filters();
+    const auto filters = m_input->activeFilters(InputEventFilter::TouchEvents);
     for (auto it = filters.begin(), end = filters.end(); it != end; it++) {
         if ((*it)->touchDown(id, pos, time)) {
             return;
@@ -133,7 +133,7 @@ void TouchInputRedirection::processUp(qint32 id, quint32 time)
     if (!m_inited) {
         return;
     }
-    const auto &filters = m_input->filters();
+    const auto filters = m_input->activeFilters(InputEventFilter::TouchEvents);
     for (auto it = filters.begin(), end = filters.end(); it != end; it++) {
         if ((*it)->touchUp(id, time)) {
             return;
@@ -146,7 +146,7 @@ void TouchInputRedirection::processMotion(qint32 id, const QPointF &pos, quint32
     if (!m_inited) {
         return;
     }
-    const auto &filters = m_input->filters();
+    const auto filters = m_input->activeFilters(InputEventFilter::TouchEvents);
     for (auto it = filters.begin(), end = filters.end(); it != end; it++) {
         if ((*it)->touchMotion(id, pos, time)) {
             return;
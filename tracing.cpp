@@ -0,0 +1,274 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "tracing.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QScopedPointer>
+#include <QThread>
+#include <QVector>
+
+#include <time.h>
+
+namespace KWin
+{
+
+QAtomicInt Tracing::s_enabled;
+
+namespace
+{
+
+/**
+ * One recorded event. The fields are atomics as an export might read an event while the
+ * owning thread overwrites it, the export detects that and drops the event.
+ **/
+struct TraceEvent
+{
+    QAtomicPointer<const char> category;
+    QAtomicPointer<const char> name;
+    QAtomicInteger<qint64> start;
+    QAtomicInteger<qint64> duration;
+};
+
+struct TraceEventCopy
+{
+    const char *category;
+    const char *name;
+    qint64 start;
+    qint64 duration;
+};
+
+/**
+ * Ring of the events of one thread. Only the owning thread records and it does so without
+ * locking: it fills the slot and then publishes it by incrementing written. An export reads
+ * written, copies the events and reads written again, every event which might have been
+ * overwritten in between gets dropped.
+ **/
+struct TraceBuffer
+{
+    int threadId = 0;
+    QString threadName;
+    QScopedArrayPointer<TraceEvent> events;
+    // number of events ever recorded into this buffer
+    QAtomicInteger<quint64> written;
+    // events before this one got discarded by starting a new session
+    QAtomicInteger<quint64> discarded;
+    // set once the thread has exited, the buffer only stays for its events to be exported
+    bool finished = false;
+
+    quint64 firstEvent(quint64 end) const {
+        return qMax(discarded.load(), end > quint64(Tracing::BufferCapacity) ? end - Tracing::BufferCapacity : 0);
+    }
+    int count() const {
+        const quint64 end = written.loadAcquire();
+        return int(end - qMin(firstEvent(end), end));
+    }
+};
+
+struct TraceRegistry
+{
+    ~TraceRegistry() {
+        qDeleteAll(buffers);
+    }
+    void remove(TraceBuffer *buffer) {
+        buffers.removeOne(buffer);
+        delete buffer;
+    }
+    QMutex mutex;
+    QList<TraceBuffer*> buffers;
+    int nextThreadId = 1;
+};
+
+}
+
+Q_GLOBAL_STATIC(TraceRegistry, s_registry)
+
+namespace
+{
+
+/**
+ * Hands the buffer of a thread back to the registry when the thread exits. A buffer without
+ * events gets freed right away, otherwise it is kept till its events got exported.
+ **/
+struct ThreadBuffer
+{
+    ~ThreadBuffer() {
+        if (!buffer || s_registry.isDestroyed()) {
+            return;
+        }
+        QMutexLocker locker(&s_registry->mutex);
+        if (buffer->count() == 0) {
+            s_registry->remove(buffer);
+        } else {
+            buffer->finished = true;
+        }
+    }
+    TraceBuffer *buffer = nullptr;
+};
+
+}
+
+static thread_local ThreadBuffer t_buffer;
+
+static TraceBuffer *threadBuffer()
+{
+    if (t_buffer.buffer) {
+        return t_buffer.buffer;
+    }
+    if (s_registry.isDestroyed()) {
+        // still tracing while the application goes down
+        return nullptr;
+    }
+    TraceBuffer *buffer = new TraceBuffer;
+    buffer->events.reset(new TraceEvent[Tracing::BufferCapacity]);
+    QThread *thread = QThread::currentThread();
+    if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+        buffer->threadName = QStringLiteral("main");
+    } else {
+        buffer->threadName = thread->objectName();
+    }
+    QMutexLocker locker(&s_registry->mutex);
+    s_registry->buffers << buffer;
+    buffer->threadId = s_registry->nextThreadId++;
+    if (buffer->threadName.isEmpty()) {
+        buffer->threadName = QStringLiteral("thread %1").arg(buffer->threadId);
+    }
+    t_buffer.buffer = buffer;
+    return buffer;
+}
+
+void Tracing::setEnabled(bool enabled)
+{
+    if (enabled == isEnabled()) {
+        return;
+    }
+    if (enabled) {
+        QMutexLocker locker(&s_registry->mutex);
+        const auto buffers = s_registry->buffers;
+        for (TraceBuffer *buffer : buffers) {
+            if (buffer->finished) {
+                s_registry->remove(buffer);
+            } else {
+                buffer->discarded.store(buffer->written.loadAcquire());
+            }
+        }
+    }
+    s_enabled.store(enabled ? 1 : 0);
+}
+
+qint64 Tracing::now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void Tracing::record(const char *category, const char *name, qint64 start, qint64 end)
+{
+    TraceBuffer *buffer = threadBuffer();
+    if (!buffer) {
+        return;
+    }
+    const quint64 index = buffer->written.load();
+    TraceEvent &event = buffer->events[int(index % BufferCapacity)];
+    event.category.store(category);
+    event.name.store(name);
+    event.start.store(start);
+    event.duration.store(end - start);
+    buffer->written.storeRelease(index + 1);
+}
+
+int Tracing::eventCount()
+{
+    int count = 0;
+    QMutexLocker locker(&s_registry->mutex);
+    for (TraceBuffer *buffer : s_registry->buffers) {
+        count += buffer->count();
+    }
+    return count;
+}
+
+QByteArray Tracing::toChromeTrace()
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray events;
+    QMutexLocker locker(&s_registry->mutex);
+    const auto buffers = s_registry->buffers;
+    for (TraceBuffer *buffer : buffers) {
+        events.append(QJsonObject{
+            {QStringLiteral("name"), QStringLiteral("thread_name")},
+            {QStringLiteral("ph"), QStringLiteral("M")},
+            {QStringLiteral("pid"), pid},
+            {QStringLiteral("tid"), buffer->threadId},
+            {QStringLiteral("args"), QJsonObject{{QStringLiteral("name"), buffer->threadName}}}
+        });
+        const quint64 end = buffer->written.loadAcquire();
+        const quint64 first = qMin(buffer->firstEvent(end), end);
+        QVector<TraceEventCopy> copies;
+        copies.reserve(int(end - first));
+        for (quint64 i = first; i < end; ++i) {
+            const TraceEvent &event = buffer->events[int(i % BufferCapacity)];
+            copies << TraceEventCopy{event.category.load(), event.name.load(), event.start.load(), event.duration.load()};
+        }
+        // another thread might have kept recording, the events it overwrote while copying are
+        // dropped, including the one it might be writing right now
+        const bool recording = buffer != t_buffer.buffer && !buffer->finished;
+        const quint64 overwritten = buffer->firstEvent(buffer->written.loadAcquire() + (recording ? 1 : 0));
+        for (quint64 i = qMax(first, overwritten); i < end; ++i) {
+            const TraceEventCopy &event = copies.at(int(i - first));
+            // complete events, the time stamps are in microseconds
+            events.append(QJsonObject{
+                {QStringLiteral("name"), QString::fromLatin1(event.name)},
+                {QStringLiteral("cat"), QString::fromLatin1(event.category)},
+                {QStringLiteral("ph"), QStringLiteral("X")},
+                {QStringLiteral("ts"), event.start / 1000.0},
+                {QStringLiteral("dur"), event.duration / 1000.0},
+                {QStringLiteral("pid"), pid},
+                {QStringLiteral("tid"), buffer->threadId}
+            });
+        }
+        // the events of an exited thread are exported now, its buffer is not needed any more
+        if (buffer->finished) {
+            s_registry->remove(buffer);
+        }
+    }
+    const QJsonObject trace{
+        {QStringLiteral("traceEvents"), events},
+        {QStringLiteral("displayTimeUnit"), QStringLiteral("ms")}
+    };
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+bool Tracing::dump(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    const QByteArray trace = toChromeTrace();
+    return file.write(trace) == trace.size();
+}
+
+}
@@ -0,0 +1,121 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_TRACING_H
+#define KWIN_TRACING_H
+
+#include <kwin_export.h>
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QString>
+
+namespace KWin
+{
+
+/**
+ * @brief Records scoped trace points of the compositor into per thread ring buffers.
+ *
+ * Trace points are added with the KWIN_TRACE macro. While tracing is disabled a trace
+ * point costs a relaxed atomic load, once enabled each one records its start time and
+ * duration. The recorded events can be exported in the Chrome trace event format, which
+ * can be loaded in chrome://tracing or Perfetto.
+ *
+ * Each thread records into its own ring buffer of BufferCapacity events without locking,
+ * once the buffer is full the oldest events get overwritten. The buffer of a thread which
+ * has exited is freed once its events got exported.
+ **/
+class KWIN_EXPORT Tracing
+{
+public:
+    static const int BufferCapacity = 65536;
+
+    static bool isEnabled() {
+        return s_enabled.load();
+    }
+    /**
+     * Enabling the tracing discards all previously recorded events.
+     **/
+    static void setEnabled(bool enabled);
+    /**
+     * @returns the current monotonic time in nanoseconds
+     **/
+    static qint64 now();
+    /**
+     * Records an event of the calling thread. @p category and @p name need to outlive
+     * the recording, they are meant to be string literals.
+     **/
+    static void record(const char *category, const char *name, qint64 start, qint64 end);
+    /**
+     * @returns the number of recorded events of all threads
+     **/
+    static int eventCount();
+    /**
+     * @returns all recorded events as Chrome trace event JSON
+     **/
+    static QByteArray toChromeTrace();
+    /**
+     * Writes the Chrome trace event JSON to @p fileName.
+     **/
+    static bool dump(const QString &fileName);
+
+private:
+    static QAtomicInt s_enabled;
+};
+
+/**
+ * Records the time from its construction till its destruction, see KWIN_TRACE.
+ **/
+class TraceScope
+{
+public:
+    TraceScope(const char *category, const char *name, bool condition = true)
+        : m_category(category)
+        , m_name((Tracing::isEnabled() && condition) ? name : nullptr) {
+        if (m_name) {
+            m_start = Tracing::now();
+        }
+    }
+    ~TraceScope() {
+        if (m_name) {
+            Tracing::record(m_category, m_name, m_start, Tracing::now());
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(TraceScope)
+    const char *m_category;
+    const char *m_name;
+    qint64 m_start = 0;
+};
+
+}
+
+#define KWIN_TRACE_CONCAT_HELPER(a, b) a##b
+#define KWIN_TRACE_CONCAT(a, b) KWIN_TRACE_CONCAT_HELPER(a, b)
+/**
+ * Traces the rest of the current scope as event @p name in @p category, both string literals.
+ **/
+#define KWIN_TRACE(category, name) KWin::TraceScope KWIN_TRACE_CONCAT(kwinTraceScope, __LINE__)(category, name)
+/**
+ * Like KWIN_TRACE, but only traces if @p condition is @c true.
+ **/
+#define KWIN_TRACE_IF(condition, category, name) KWin::TraceScope KWIN_TRACE_CONCAT(kwinTraceScope, __LINE__)(category, name, condition)
+
+#endif
@@ -34,6 +34,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <assert.h>
 #include <QApplication>
 #include <QDebug>
+#include <QElapsedTimer>
 
 #include <X11/Xlib.h>
 
@@ -88,11 +89,32 @@ void updateXTime()
 }
 
 static int server_grab_count = 0;
+static quint64 server_grab_total = 0;
+// number of server grabs in each of the last seconds, used for the grab rate
+static const int s_grabSeconds = 10;
+struct GrabBucket {
+    qint64 second = -1;
+    int count = 0;
+};
+static GrabBucket s_grabBuckets[s_grabSeconds];
+static QElapsedTimer s_grabTimer;
 
 void grabXServer()
 {
-    if (++server_grab_count == 1)
+    if (++server_grab_count == 1) {
         xcb_grab_server(connection());
+        if (!s_grabTimer.isValid()) {
+            s_grabTimer.start();
+        }
+        const qint64 second = s_grabTimer.elapsed() / 1000;
+        GrabBucket &bucket = s_grabBuckets[second % s_grabSeconds];
+        if (bucket.second != second) {
+            bucket.second = second;
+            bucket.count = 0;
+        }
+        bucket.count++;
+        server_grab_total++;
+    }
 }
 
 void ungrabXServer()
@@ -109,6 +131,26 @@ bool grabbedXServer()
     return server_grab_count > 0;
 }
 
+quint64 xServerGrabCount()
+{
+    return server_grab_total;
+}
+
+qreal xServerGrabsPerSecond()
+{
+    if (!s_grabTimer.isValid()) {
+        return 0.0;
+    }
+    const qint64 now = s_grabTimer.elapsed() / 1000;
+    int grabs = 0;
+    for (int i = 0; i < s_grabSeconds; ++i) {
+        if (s_grabBuckets[i].second >= 0 && now - s_grabBuckets[i].second < s_grabSeconds) {
+            grabs += s_grabBuckets[i].count;
+        }
+    }
+    return qreal(grabs) / qreal(qMin(now + 1, qint64(s_grabSeconds)));
+}
+
 static bool keyboard_grabbed = false;
 
 bool grabXKeyboard(xcb_window_t w)
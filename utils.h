@@ -147,6 +147,14 @@ void updateXTime();
 void grabXServer();
 void ungrabXServer();
 bool grabbedXServer();
+/**
+ * @returns the number of X server grabs since startup, nested grabs are counted once
+ **/
+quint64 xServerGrabCount();
+/**
+ * @returns the number of X server grabs per second over the last seconds
+ **/
+qreal xServerGrabsPerSecond();
 bool grabXKeyboard(xcb_window_t w = rootWindow());
 void ungrabXKeyboard();
 
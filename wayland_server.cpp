@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "abstract_backend.h"
 #include "composite.h"
 #include "screens.h"
+#include "tracing.h"
 #include "shell_client.h"
 #include "workspace.h"
 
@@ -46,6 +47,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <KWayland/Server/shadow_interface.h>
 #include <KWayland/Server/blur_interface.h>
 #include <KWayland/Server/shell_interface.h>
+#include <KWayland/Server/subcompositor_interface.h>
 
 // Qt
 #include <QThread>
@@ -152,11 +154,7 @@ void WaylandServer::init(const QByteArray &socketName, InitalizationFlags flags)
             if (auto c = Compositor::self()) {
                 connect(client, &Toplevel::needsRepaint, c, &Compositor::scheduleRepaint);
             }
-            if (client->isInternal()) {
-                m_internalClients << client;
-            } else {
-                m_clients << client;
-            }
+            addClient(client);
             if (client->readyForPainting()) {
                 emit shellClientAdded(client);
             } else {
@@ -172,6 +170,7 @@ void WaylandServer::init(const QByteArray &socketName, InitalizationFlags flags)
     m_seat = m_display->createSeat(m_display);
     m_seat->create();
     m_display->createDataDeviceManager(m_display)->create();
+    m_display->createSubCompositor(m_display)->create();
     m_display->createIdle(m_display)->create();
     m_plasmaShell = m_display->createPlasmaShell(m_display);
     m_plasmaShell->create();
@@ -378,15 +377,41 @@ void WaylandServer::uninstallBackend(AbstractBackend *backend)
     m_backend = nullptr;
 }
 
+void WaylandServer::addClient(ShellClient *c)
+{
+    if (c->isInternal()) {
+        m_internalClients << c;
+    } else {
+        m_clients << c;
+    }
+    if (c->windowId() != 0) {
+        m_clientsById.insert(c->windowId(), c);
+    }
+    m_clientsBySurface.insert(c->surface(), c);
+}
+
 void WaylandServer::removeClient(ShellClient *c)
 {
     m_clients.removeAll(c);
     m_internalClients.removeAll(c);
+    auto idIt = m_clientsById.find(c->windowId());
+    if (idIt != m_clientsById.end() && idIt.value() == c) {
+        m_clientsById.erase(idIt);
+    }
+    // the surface is already gone when the client gets destroyed, so it cannot be used as key
+    for (auto it = m_clientsBySurface.begin(); it != m_clientsBySurface.end();) {
+        if (it.value() == c) {
+            it = m_clientsBySurface.erase(it);
+        } else {
+            ++it;
+        }
+    }
     emit shellClientRemoved(c);
 }
 
 void WaylandServer::dispatch()
 {
+    KWIN_TRACE("wayland", "dispatch");
     if (!m_display) {
         return;
     }
@@ -396,44 +421,12 @@ void WaylandServer::dispatch()
     m_display->dispatchEvents(0);
 }
 
-static ShellClient *findClientInList(const QList<ShellClient*> &clients, quint32 id)
-{
-    auto it = std::find_if(clients.begin(), clients.end(),
-        [id] (ShellClient *c) {
-            return c->windowId() == id;
-        }
-    );
-    if (it == clients.end()) {
-        return nullptr;
-    }
-    return *it;
-}
-
-static ShellClient *findClientInList(const QList<ShellClient*> &clients, KWayland::Server::SurfaceInterface *surface)
-{
-    auto it = std::find_if(clients.begin(), clients.end(),
-        [surface] (ShellClient *c) {
-            return c->surface() == surface;
-        }
-    );
-    if (it == clients.end()) {
-        return nullptr;
-    }
-    return *it;
-}
-
 ShellClient *WaylandServer::findClient(quint32 id) const
 {
     if (id == 0) {
         return nullptr;
     }
-    if (ShellClient *c = findClientInList(m_clients, id)) {
-        return c;
-    }
-    if (ShellClient *c = findClientInList(m_internalClients, id)) {
-        return c;
-    }
-    return nullptr;
+    return m_clientsById.value(id, nullptr);
 }
 
 ShellClient *WaylandServer::findClient(SurfaceInterface *surface) const
@@ -441,13 +434,7 @@ ShellClient *WaylandServer::findClient(SurfaceInterface *surface) const
     if (!surface) {
         return nullptr;
     }
-    if (ShellClient *c = findClientInList(m_clients, surface)) {
-        return c;
-    }
-    if (ShellClient *c = findClientInList(m_internalClients, surface)) {
-        return c;
-    }
-    return nullptr;
+    return m_clientsBySurface.value(surface, nullptr);
 }
 
 ShellClient *WaylandServer::findClient(QWindow *w) const
@@ -476,14 +463,18 @@ quint32 WaylandServer::createWindowId(SurfaceInterface *surface)
         clientId = createClientId(surface->client());
     }
     Q_ASSERT(clientId != 0);
-    quint32 id = clientId;
-    // TODO: this does not prevent that two surfaces of same client get same id
-    id = (id << 16) | (surface->id() & 0xFFFF);
-    if (findClient(id)) {
-        qCWarning(KWIN_CORE) << "Invalid client windowId generated:" << id;
-        return 0;
+    const quint32 prefix = quint32(clientId) << 16;
+    // start with the surface's resource id and probe the following ids of the
+    // client connection till an unused one is found
+    quint16 surfaceId = surface->id() & 0xFFFF;
+    for (int i = 0; i <= 0xFFFF; ++i, ++surfaceId) {
+        const quint32 id = prefix | surfaceId;
+        if (!m_clientsById.contains(id)) {
+            return id;
+        }
     }
-    return id;
+    qCWarning(KWIN_CORE) << "No free windowId for client connection" << clientId;
+    return 0;
 }
 
 quint16 WaylandServer::createClientId(ClientConnection *c)
@@ -152,6 +152,13 @@ public:
         return m_internalConnection.registry;
     }
     void dispatch();
+    /**
+     * Allocates a window id for @p surface which is not used by any other ShellClient.
+     * The upper 16 bits identify the client connection, the lower 16 bits are derived
+     * from the surface's resource id.
+     *
+     * @returns the new window id or @c 0 if all ids of the client connection are in use
+     **/
     quint32 createWindowId(KWayland::Server::SurfaceInterface *surface);
 
 Q_SIGNALS:
@@ -161,6 +168,7 @@ Q_SIGNALS:
 
 private:
     quint16 createClientId(KWayland::Server::ClientConnection *c);
+    void addClient(ShellClient *c);
     void destroyInternalConnection();
     KWayland::Server::Display *m_display = nullptr;
     KWayland::Server::CompositorInterface *m_compositor = nullptr;
@@ -187,6 +195,9 @@ private:
     AbstractBackend *m_backend = nullptr;
     QList<ShellClient*> m_clients;
     QList<ShellClient*> m_internalClients;
+    // indexes over m_clients and m_internalClients
+    QHash<quint32, ShellClient*> m_clientsById;
+    QHash<KWayland::Server::SurfaceInterface*, ShellClient*> m_clientsBySurface;
     QHash<KWayland::Server::ClientConnection*, quint16> m_clientIds;
     InitalizationFlags m_initFlags;
     KWIN_SINGLETON(WaylandServer)
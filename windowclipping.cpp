@@ -0,0 +1,44 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "windowclipping.h"
+
+namespace KWin
+{
+
+bool WindowClipping::clip(WindowQuadList &quads, const QRegion &region) const
+{
+    if (region == infiniteRegion()) {
+        return false;
+    }
+    if (transformed && (region.rectCount() == 1 || !axisAligned)) {
+        // a single rect costs one scissored draw per leaf node just like the clipped geometry
+        return true;
+    }
+    QVector<QRectF> rects;
+    rects.reserve(region.rectCount());
+    foreach (const QRect &r, region.rects()) {
+        rects << QRectF((r.x() - position.x()) / xScale, (r.y() - position.y()) / yScale,
+                        r.width() / xScale, r.height() / yScale);
+    }
+    quads = quads.clipped(rects);
+    return false;
+}
+
+}
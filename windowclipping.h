@@ -0,0 +1,58 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2026 agent <agent@local>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_WINDOWCLIPPING_H
+#define KWIN_WINDOWCLIPPING_H
+
+#include <kwin_export.h>
+#include <kwineffects.h>
+
+namespace KWin
+{
+
+/**
+ * @brief Restricts the painting of a window to the damaged region of the screen.
+ *
+ * Windows painted without a transformation get their quads clipped to the region.
+ * Transformed windows are scissored once per rect of the region, which draws every
+ * leaf node once per rect. If the transformation only translates and scales, the
+ * region is mapped into window coordinates and the quads get clipped instead, so the
+ * window is drawn once independent of the number of rects.
+ **/
+struct KWIN_EXPORT WindowClipping
+{
+    // the window is painted with a transformation, but the screen is not transformed
+    bool transformed = false;
+    // the transformation only translates and scales in the x/y plane
+    bool axisAligned = true;
+    // the position of the window on the screen including the translation
+    QPointF position;
+    qreal xScale = 1.0;
+    qreal yScale = 1.0;
+
+    /**
+     * Clips the @p quads to the screen @p region.
+     * @returns @c true if the region has to be applied by scissoring instead
+     **/
+    bool clip(WindowQuadList &quads, const QRegion &region) const;
+};
+
+}
+
+#endif
@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "workspace.h"
 // kwin libs
 #include <kwinglplatform.h>
+#include <kwinglutils.h>
 #include <kwinxrenderutils.h>
 // kwin
 #ifdef KWIN_BUILD_ACTIVITIES
@@ -37,6 +38,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "focuschain.h"
 #include "group.h"
 #include "input.h"
+#include "pointer_input.h"
 #include "logind.h"
 #include "killwindow.h"
 #include "netinfo.h"
@@ -49,6 +51,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef KWIN_BUILD_TABBOX
 #include "tabbox.h"
 #endif
+#include "tracing.h"
 #include "unmanaged.h"
 #include "useractions.h"
 #include "virtualdesktops.h"
@@ -196,6 +199,10 @@ Workspace::Workspace(const QString &sessionKey)
     connect(this, &Workspace::configChanged, decorationBridge, &Decoration::DecorationBridge::reconfigure);
 
     new DBusInterface(this);
+    new TracingDBusInterface(this);
+    if (qEnvironmentVariableIsSet("KWIN_TRACING")) {
+        Tracing::setEnabled(true);
+    }
 
     // Compatibility
     int32_t data = 1;
@@ -1558,6 +1565,20 @@ QString Workspace::supportInformation() const
             }
 
             support.append(QStringLiteral("OpenGL 2 Shaders are used\n"));
+            const ShaderManager::StateStatistics &state = ShaderManager::stateStatistics();
+            support.append(QStringLiteral("Uniform updates: %1 (%2 redundant)\n").arg(state.uniformUpdates).arg(state.redundantUniformUpdates));
+            support.append(QStringLiteral("Program binds: %1 (%2 redundant)\n").arg(state.programBinds).arg(state.redundantProgramBinds));
+            support.append(QStringLiteral("Draw calls: %1\n").arg(GLVertexBuffer::drawCallCount()));
+            const ShaderManager::ProgramCacheStatistics &programCache = ShaderManager::instance()->programCacheStatistics();
+            support.append(QStringLiteral("Program binary cache: "));
+            support.append(programCache.enabled ? yes : no);
+            if (programCache.enabled) {
+                support.append(QStringLiteral("Cached programs: %1 loaded, %2 compiled (%3 discarded)\n")
+                    .arg(programCache.hits).arg(programCache.misses).arg(programCache.discarded));
+                support.append(QStringLiteral("Program binary load time: %1 ms\n").arg(programCache.binaryLoadTime / 1000000));
+                support.append(QStringLiteral("Saved shader compile time: %1 ms\n").arg(programCache.savedCompileTime / 1000000));
+            }
+            support.append(QStringLiteral("Shader compile time: %1 ms\n").arg(programCache.compileTime / 1000000));
             support.append(QStringLiteral("Painting blocks for vertical retrace: "));
             if (m_compositor->scene()->blocksForRetrace())
                 support.append(QStringLiteral(" yes\n"));
@@ -1575,6 +1596,31 @@ QString Workspace::supportInformation() const
         default:
             support.append(QStringLiteral("Something is really broken, neither OpenGL nor XRender is used"));
         }
+        const Scene::PaintCacheStatistics &paintCache = m_compositor->scene()->paintCacheStatistics();
+        support.append(QStringLiteral("Reused window paint data: %1\n").arg(paintCache.reusedWindows));
+        support.append(QStringLiteral("Rebuilt window paint data: %1\n").arg(paintCache.rebuiltWindows));
+        support.append(QStringLiteral("Skipped occluded windows: %1\n").arg(paintCache.occludedWindows));
+        const Scene::WindowPixmapStatistics &pixmaps = m_compositor->scene()->windowPixmapStatistics();
+        support.append(QStringLiteral("Window pixmap texture allocations: %1\n").arg(pixmaps.textureAllocations));
+        support.append(QStringLiteral("Scaled previous window pixmaps: %1\n").arg(pixmaps.scaledPreviousPixmaps));
+        support.append(QStringLiteral("Uploaded window pixmap bytes: %1\n").arg(pixmaps.uploadedBytes));
+        const Scene::ThumbnailStatistics &thumbnails = m_compositor->scene()->thumbnailStatistics();
+        support.append(QStringLiteral("Rendered thumbnails: %1\n").arg(thumbnails.renderedThumbnails));
+        support.append(QStringLiteral("Cached thumbnails: %1\n").arg(thumbnails.cachedThumbnails));
+        support.append(QStringLiteral("Deferred thumbnails: %1\n").arg(thumbnails.deferredThumbnails));
+        if (kwinApp()->x11Connection()) {
+            support.append(QStringLiteral("X server grabs: %1\n").arg(xServerGrabCount()));
+            support.append(QStringLiteral("X server grabs per second: %1\n").arg(xServerGrabsPerSecond()));
+        }
+        if (waylandServer()) {
+            const PointerInputRedirection *pointer = input()->pointer();
+            const PointerInputRedirection::PickStatistics &picks = pointer->pickStatistics();
+            support.append(QStringLiteral("Frame aligned pointer motion: "));
+            support.append(pointer->isFrameAligned() ? yes : no);
+            support.append(QStringLiteral("Average pointer picks per frame: %1\n").arg(
+                picks.frames ? qreal(picks.picks) / qreal(picks.frames) : 0.0));
+            support.append(QStringLiteral("Maximum pointer picks per frame: %1\n").arg(picks.maxPicksPerFrame));
+        }
         support.append(QStringLiteral("\nLoaded Effects:\n"));
         support.append(QStringLiteral(  "---------------\n"));
         foreach (const QString &effect, static_cast<EffectsHandlerImpl*>(effects)->loadedEffects()) {